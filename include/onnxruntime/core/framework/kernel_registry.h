@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <string_view>
 
 #include "core/framework/op_kernel.h"
@@ -129,5 +130,13 @@ class KernelRegistry {
   // Kernel create function map from op name to kernel creation info.
   // key is opname+domain_name+provider_name
   KernelCreateMap kernel_creator_fn_map_;
+
+  // Kernels found for nodes using a kernel_type_str_resolver, keyed by the map key, the since version and the types of
+  // the node's inputs and outputs, which is all the match depends on. Large models repeat the same few combinations
+  // (e.g. in every layer of a transformer) and execution providers are queried for every node during partitioning,
+  // so most lookups are served from here instead of verifying the type constraints of each candidate kernel again.
+  // The CPU registry is shared between sessions, hence the mutex.
+  mutable std::mutex lookup_cache_mutex_;
+  mutable InlinedHashMap<std::string, const KernelCreateInfo*> lookup_cache_;
 };
 }  // namespace onnxruntime
@@ -12,6 +12,7 @@
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "core/common/flatbuffers.h"
 
@@ -397,7 +398,12 @@ class Node {
   bool ClearAttribute(const std::string& attr_name);
 
   /** Gets the Node's mutable attributes. */
-  NodeAttributes& GetMutableAttributes() noexcept { return attributes_; }
+  NodeAttributes& GetMutableAttributes() noexcept {
+#if !defined(ORT_MINIMAL_BUILD)
+    attributes_changed_since_inference_ = true;
+#endif
+    return attributes_;
+  }
 
 #endif  // !defined(ORT_MINIMAL_BUILD) || defined(ORT_EXTENDED_MINIMAL_BUILD)
 
@@ -642,6 +648,11 @@ class Node {
   // Node::ToProto when running onnx::check_node in the first Graph::Resolve. At that point we know all the nodes are
   // unchanged from the original model.
   const ONNX_NAMESPACE::NodeProto* original_node_proto_ = nullptr;
+
+  // Version stamps of the input and output NodeArgs when Graph::Resolve last ran type and shape inferencing for
+  // this node. Inferencing is skipped while they are unchanged and the attributes were not changed either.
+  std::vector<uint64_t> inference_stamps_;
+  bool attributes_changed_since_inference_ = false;
 #endif
 
   // Execution priority, lower value for higher priority
@@ -1604,6 +1615,10 @@ class Graph {  // NOLINT(clang-analyzer-optin.performance.Padding): preserve exi
   // Initialize overridable initializers container
   void ComputeOverridableInitializers();
 
+  // Gives the NodeArg of an initializer that was added, removed or replaced a new version stamp
+  // so the nodes consuming it run type and shape inferencing again in the next Resolve.
+  void MarkInitializerChanged(const std::string& name);
+
 #if !defined(ORT_MINIMAL_BUILD)
   // Build and verify node connection (edges).
   // Verify NodeArg name/type/shape matching correctly.
@@ -1621,6 +1636,13 @@ class Graph {  // NOLINT(clang-analyzer-optin.performance.Padding): preserve exi
 
   common::Status InferAndVerifyTypeMatch(Node& node, const ONNX_NAMESPACE::OpSchema& op, const ResolveOptions& options);
 
+  // Runs InferAndVerifyTypeMatch unless nothing the inferencing of the node depends on changed since it last ran.
+  common::Status InferAndVerifyTypeMatchIfChanged(Node& node, const ONNX_NAMESPACE::OpSchema& op,
+                                                  const ResolveOptions& options);
+
+  // Gets the version stamps the type and shape inferencing of node depends on.
+  void GetInferenceStamps(const Node& node, InlinedVector<uint64_t>& stamps) const;
+
   // perform type and shape inferencing on the subgraph and Resolve to validate
   static common::Status InferAndVerifySubgraphTypes(const Node& node, Graph& subgraph,
                                                     const std::vector<const ONNX_NAMESPACE::TypeProto*>& input_types,
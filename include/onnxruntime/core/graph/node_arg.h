@@ -111,6 +111,11 @@ class NodeArg {
   Optional inputs are allowed in ONNX and an empty #Name represents a non-existent input argument. */
   bool Exists() const noexcept;
 
+  /** Gets a stamp that changes whenever the type or shape of this NodeArg may have changed.
+  Stamps are unique across all NodeArg instances, so a different NodeArg never has the same stamp.
+  Graph::Resolve uses them to skip type and shape inferencing for nodes whose inputs and outputs are unchanged. */
+  uint64_t Version() const noexcept { return version_; }
+
   friend class Graph;
 
   NodeArg(NodeArgInfo&& node_arg_info);
@@ -122,6 +127,9 @@ class NodeArg {
   void SetType(const ONNX_NAMESPACE::TypeProto& type_proto);
 #endif  // !defined(ORT_MINIMAL_BUILD) || defined(ORT_EXTENDED_MINIMAL_BUILD)
 
+  // Gives this NodeArg a new version stamp.
+  void MarkChanged() noexcept;
+
   // Node arg PType.
   const std::string* type_;
 
@@ -130,5 +138,8 @@ class NodeArg {
 
   // Flag indicates whether <*this> node arg exists or not.
   bool exists_;
+
+  // Version stamp from a process wide counter. See Version().
+  uint64_t version_;
 };
 }  // namespace onnxruntime
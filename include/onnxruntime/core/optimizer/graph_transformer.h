@@ -41,8 +41,18 @@ class GraphTransformer {
   */
   Status Apply(Graph& graph, bool& modified, const logging::Logger& logger) const;
 
+  /** Apply the transformation like #Apply, without calling Graph::Resolve if the Graph was modified.
+  The caller must resolve the Graph before it is used by anything other than a transformer that
+  #CanApplyToUnresolvedGraph.
+  */
+  Status ApplyWithoutResolve(Graph& graph, bool& modified, const logging::Logger& logger) const;
+
   virtual bool ShouldOnlyApplyOnce() const { return false; }
 
+  /** Whether this transformer can be applied to a Graph that was modified by another transformer and not resolved
+  since. GraphTransformerManager resolves the Graph once after a sequence of such transformers. */
+  virtual bool CanApplyToUnresolvedGraph() const { return false; }
+
  protected:
   /** Helper method to call ApplyImpl on any subgraphs in the Node. */
   Status Recurse(Node& node, bool& modified, int graph_level, const logging::Logger& logger) const {
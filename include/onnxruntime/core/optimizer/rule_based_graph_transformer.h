@@ -53,6 +53,10 @@ class RuleBasedGraphTransformer : public GraphTransformer {
   /** Returns the total number of rules that are registered in this transformer. */
   size_t RulesCount() const;
 
+  /** Rewrite rules keep the graph connections up to date as they go, so a rule-based transformer can run on the
+      graph left by another one without a Graph::Resolve in between. */
+  bool CanApplyToUnresolvedGraph() const override { return true; }
+
  protected:
   /** Applies the given set of rewrite rules on the Node of this Graph.
       @param[in] graph The Graph.
@@ -107,6 +107,18 @@ static const char* const kOrtSessionOptionsMemoryOptimizerProbeConfig = "optimiz
 // Default is an empty string which means no optimizers are disabled.
 static const char* const kOrtSessionOptionsDisableSpecifiedOptimizers = "optimization.disable_specified_optimizers";
 
+// Limits on the tensors constant folding may add to the graph. A node whose outputs take more than
+// "optimization.constant_folding_max_output_bytes" bytes, or more than
+// "optimization.constant_folding_max_expansion_ratio" times the bytes of its inputs, is left in the graph and
+// computed at run time instead. The expansion ratio only applies to outputs of 4KB or more, so that folding small
+// ConstantOfShape or Range nodes is not prevented. A value of "0" means no limit, which is the default for both.
+// Folding a node that expands a small input into a large tensor (Expand, Tile, ConstantOfShape) trades memory in the
+// session, and size of a saved optimized model, for compute that is often cheap.
+static const char* const kOrtSessionOptionsConstantFoldingMaxOutputBytes =
+    "optimization.constant_folding_max_output_bytes";
+static const char* const kOrtSessionOptionsConstantFoldingMaxExpansionRatio =
+    "optimization.constant_folding_max_expansion_ratio";
+
 // Enable or disable using device allocator for allocating initialized tensor memory. "1": enable; "0": disable. The default is "0".
 // Using device allocators means the memory allocation is made using malloc/new.
 static const char* const kOrtSessionOptionsUseDeviceAllocatorForInitializers = "session.use_device_allocator_for_initializers";
@@ -135,6 +147,17 @@ static const char* const kOrtSessionOptionsConfigUseORTModelBytesDirectly = "ses
 static const char* const kOrtSessionOptionsConfigUseORTModelBytesForInitializers =
     "session.use_ort_model_bytes_for_initializers";
 
+// Key for memory-mapping an ORT format model file loaded from a path instead of reading it into a buffer.
+// The file is mapped privately (copy-on-write) for the lifetime of the InferenceSession and the initializers use their
+// data in the mapped file directly, as with `session.use_ort_model_bytes_for_initializers`. Pages are read from disk
+// when first used and are shared with the page cache and the other processes mapping the file until they are written
+// to, so loading a large model costs little private memory. The mapping is not write-protected on every platform, so
+// the initializer data must not be modified. The file must not be modified while the session exists.
+// Option values:
+// - "0": the model file is read into memory. [DEFAULT]
+// - "1": the model file is memory-mapped.
+static const char* const kOrtSessionOptionsConfigMapORTModelFile = "session.map_ort_model_file";
+
 // This should only be specified when exporting an ORT format model for use on a different platform.
 // If the ORT format model will be used on ARM platforms set to "1". For other platforms set to "0"
 // Available since version 1.11.
@@ -337,6 +360,101 @@ static const char* const kOrtSessionOptionsMlasGemmFastMathArm64Bfloat16 = "mlas
 // If not provided, default is 4.
 static const char* const kOrtSessionOptionsQDQMatMulNBitsAccuracyLevel = "session.qdq_matmulnbits_accuracy_level";
 
+// Run Q*K' and Softmax(Q*K')*V of the CPU QAttention kernel with 8-bit integer GEMMs instead of float GEMMs.
+// Q, K and V are quantized per head with dynamic scales, and the attention probabilities are requantized to uint8.
+// This trades some accuracy for speed, so it is only used when explicitly enabled.
+// Option values:
+// - "0": Q*K' and Softmax*V are computed in float. [DEFAULT]
+// - "1": Q*K' and Softmax*V are computed with 8-bit integer GEMMs.
+static const char* const kOrtSessionOptionsQAttentionInt8Attention = "session.qattention_int8_attention";
+
+// Store the branch nodes of the CPU TreeEnsemble* kernels in a compact format: 16-bit feature ids, 16-bit indices into
+// per-feature tables of sorted thresholds and 32-bit relative child offsets. Every row is binned once against the
+// threshold tables and the trees compare small integers. Predictions are identical to the default format.
+// Ensembles with missing value tracks, comparison modes other than BRANCH_LEQ or BRANCH_LT, or too many distinct
+// features or thresholds keep the default format.
+// Option values:
+// - "0": nodes are stored in the default format. [DEFAULT]
+// - "1": nodes are stored in the compact format when the ensemble allows it.
+static const char* const kOrtSessionOptionsTreeEnsembleCompactNodes = "session.tree_ensemble_compact_nodes";
+
+// Replace the ZipMap nodes producing a model output with columnar outputs. ZipMap builds one std::map per row, which
+// often costs more than the classifier itself for large batches. When enabled, such an output Z is replaced by the
+// [N, C] float tensor ZipMap takes as input (its name is the name of that tensor), followed by a new output named
+// Z + "_labels" holding the C class labels as a constant int64 or string tensor.
+// This changes the names and the types of the model outputs.
+// Option values:
+// - "0": the model outputs are kept. [DEFAULT]
+// - "1": ZipMap outputs are replaced by probability and label tensors.
+static const char* const kOrtSessionOptionsZipMapColumnarOutput = "session.zipmap_columnar_output";
+
+// Create the kernels assigned to the CPU execution provider and pre-pack their constant inputs as parallel tasks on
+// the intra-op thread pool during session initialization. Kernels of other execution providers are still created
+// and pre-packed one at a time. Pre-packed weights are shared and released in the same deterministic order in a
+// given mode, and the time spent is reported by the "kernel_creation" and "prepacking" session profiling events.
+// Custom op kernels assigned to the CPU execution provider are created in parallel too, so the CreateKernel and
+// CreateKernelV2 callbacks of an OrtCustomOp may be called concurrently and must be thread-safe when this is enabled.
+// Option values:
+// - "0": kernels are created and pre-packed one at a time. [DEFAULT]
+// - "1": kernels of the CPU execution provider are created and pre-packed in parallel.
+static const char* const kOrtSessionOptionsParallelKernelInitialization = "session.parallel_kernel_initialization";
+
+// Directory of pre-packed weights shared by the processes running the same models on a host.
+// When set, the weights pre-packed by CPU kernels are published into this directory, one file per packed weight
+// named after its content hash, and every process maps the files into memory instead of keeping its own copy. As with
+// any shared pre-packed weights, kernels must not write to the mapped buffers, which are read-only on Windows.
+// Kernels still call PrePack() to compute the content hash; an existing file is only used when it is identical to the
+// buffers packed by the process. Errors reading or writing the directory are logged and the process keeps its own
+// copy of the weights. The directory is created if needed and is never cleaned up by ONNX Runtime.
+// Option values:
+// - "": pre-packed weights are only shared within a process. [DEFAULT]
+// - "<directory>": pre-packed weights are shared through files in <directory>.
+static const char* const kOrtSessionOptionsPrepackedWeightsStoreDirectory = "session.prepacked_weights_store_dir";
+
+// How the data of initializers stored in external files is read during session initialization.
+// Initializers used on CPU are memory-mapped from the external files, and their pages are read from disk one fault at
+// a time when a kernel first touches them (pre-packing or the first Run). Initializers used on other devices are read
+// the same way while they are copied, one initializer after another.
+// In "parallel" mode the external data of all the initializers is first read into the page cache, in chunks spread
+// across the intra-op thread pool, so reading scales with the disk bandwidth rather than with a single thread. The
+// mapped initializers then stay backed by the page cache.
+// Option values:
+// - "lazy": pages of external initializers are read on first use. [DEFAULT]
+// - "parallel": external initializer data is read in parallel before the initializers are created.
+static const char* const kOrtSessionOptionsExternalInitializersLoadMode = "session.external_initializers_load_mode";
+
+// Load the initializers embedded in an ONNX model file in place.
+// By default the whole model file is parsed into memory and the initializers are copied again when the session is
+// initialized, so peak memory during loading is a multiple of the model size. When enabled, the raw data of the large
+// initializers of the main graph is left in the model file and referenced as external data, which CPU initializers
+// then memory-map. This only applies to models loaded from a file path, and lets models whose embedded initializers
+// make them larger than 2GB be loaded.
+// Only raw data that starts at an offset of the file aligned to 256 bytes can be mapped in place, other initializers
+// are read from the file straight into their own buffer. Initializers left in place reference the model file by its
+// file name, so an optimized model saved to another directory must write them to a new external data file with
+// "session.optimized_model_external_initializers_file_name".
+// Option values:
+// - "0": parse the whole model into memory. [DEFAULT]
+// - "1": leave the raw data of large initializers in the model file.
+static const char* const kOrtSessionOptionsLoadModelInitializersInPlace = "session.load_model_initializers_in_place";
+
+// Initialize the branches of 'If' nodes the first time they run instead of during session initialization.
+// The kernels, execution plan, initializers and pre-packed weights of a deferred branch (and of the subgraphs nested
+// in it) are created by the first Run that takes the branch, which pays for it; concurrent Run calls taking the same
+// branch wait for it. Branches that never run cost no time or memory beyond their graph. Initializers of the outer
+// graphs used by a deferred branch are not released after being pre-packed. The option is ignored when pre-packed
+// initializers are saved with the model.
+// Option values:
+// - "0": all subgraphs are initialized during session initialization. [DEFAULT]
+// - "1": 'If' branches are initialized on first use.
+static const char* const kOrtSessionOptionsLazySubgraphInitialization = "session.lazy_subgraph_initialization";
+
+// Comma-separated list of the 'If' branches to initialize during session initialization when
+// kOrtSessionOptionsLazySubgraphInitialization is enabled, e.g. "if_0,decoder_if:then_branch".
+// An entry is either the name of an 'If' node, for both its branches, or "<node name>:<attribute name>" for one branch.
+static const char* const kOrtSessionOptionsLazySubgraphInitializationPrewarm =
+    "session.lazy_subgraph_initialization_prewarm";
+
 // THIS OPTION IS NOT A REGULAR SESSION OPTION SINCE IT CAN BE MODIFIED AT ANY TIME
 // Meant to be used with SetEpDynamicOptions
 // Specify the type of workload for this session.
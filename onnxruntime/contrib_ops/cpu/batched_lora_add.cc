@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/common/inlined_containers.h"
+#include "core/common/safeint.h"
+#include "core/framework/op_kernel.h"
+#include "core/mlas/inc/mlas.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// Adds a per-row LoRA delta to the output of a base MatMul. Each row of the batch selects its adapter from
+// stacked lora_a/lora_b tensors, so requests of different adapters can share one batch. The two low-rank
+// products of all rows are issued as two batched SGEMM calls, with each batch entry pointing directly into
+// the weights of its adapter (a segmented gather-GEMM) instead of swapping initializers per adapter.
+class BatchedLoraAdd final : public OpKernel {
+ public:
+  explicit BatchedLoraAdd(const OpKernelInfo& info) : OpKernel(info) {}
+
+  Status Compute(OpKernelContext* context) const override;
+};
+
+ONNX_OPERATOR_KERNEL_EX(
+    BatchedLoraAdd,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>())
+        .TypeConstraint("I", DataTypeImpl::GetTensorType<int32_t>())
+        .MayInplace(1, 0),
+    BatchedLoraAdd);
+
+Status BatchedLoraAdd::Compute(OpKernelContext* context) const {
+  const Tensor* input = context->Input<Tensor>(0);
+  const Tensor* base_output = context->Input<Tensor>(1);
+  const Tensor* lora_a = context->Input<Tensor>(2);
+  const Tensor* lora_b = context->Input<Tensor>(3);
+  const Tensor* adapter_index = context->Input<Tensor>(4);
+  const Tensor* scale = context->Input<Tensor>(5);
+
+  const auto& input_dims = input->Shape().GetDims();
+  const auto& output_dims = base_output->Shape().GetDims();
+  ORT_RETURN_IF_NOT(input_dims.size() == 2 || input_dims.size() == 3,
+                    "Input 'input' is expected to have 2 or 3 dimensions, got ", input_dims.size());
+  ORT_RETURN_IF_NOT(output_dims.size() == input_dims.size(),
+                    "Input 'base_output' is expected to have the same rank as 'input'");
+
+  const auto& lora_a_dims = lora_a->Shape().GetDims();
+  const auto& lora_b_dims = lora_b->Shape().GetDims();
+  ORT_RETURN_IF_NOT(lora_a_dims.size() == 3 && lora_b_dims.size() == 3,
+                    "Inputs 'lora_a' and 'lora_b' are expected to have 3 dimensions");
+
+  const int64_t batch_size = input_dims[0];
+  const int64_t sequence_length = input_dims.size() == 3 ? input_dims[1] : 1;
+  const int64_t hidden_size = input_dims.back();
+  const int64_t output_size = output_dims.back();
+  const int64_t num_adapters = lora_a_dims[0];
+  const int64_t rank = lora_a_dims[2];
+
+  ORT_RETURN_IF_NOT(output_dims[0] == batch_size && (input_dims.size() == 2 || output_dims[1] == sequence_length),
+                    "Input 'base_output' shall have the same batch and sequence dimensions as 'input'");
+  ORT_RETURN_IF_NOT(lora_a_dims[1] == hidden_size,
+                    "Input 'lora_a' shape[1] shall be hidden_size, got ", lora_a_dims[1]);
+  ORT_RETURN_IF_NOT(lora_b_dims[0] == num_adapters && lora_b_dims[1] == rank && lora_b_dims[2] == output_size,
+                    "Input 'lora_b' is expected to have shape (num_adapters, rank, output_size)");
+  ORT_RETURN_IF_NOT(adapter_index->Shape().NumDimensions() == 1 && adapter_index->Shape()[0] == batch_size,
+                    "Input 'adapter_index' is expected to have shape (batch_size)");
+  ORT_RETURN_IF_NOT(scale == nullptr || scale->Shape().Size() == num_adapters,
+                    "Input 'scale' is expected to have shape (num_adapters)");
+
+  Tensor* output = context->Output(0, base_output->Shape());
+  if (output->MutableDataRaw() != base_output->DataRaw()) {
+    memcpy(output->MutableDataRaw(), base_output->DataRaw(), base_output->SizeInBytes());
+  }
+
+  if (output->Shape().Size() == 0 || rank == 0) {
+    return Status::OK();
+  }
+
+  const float* input_data = input->Data<float>();
+  const float* lora_a_data = lora_a->Data<float>();
+  const float* lora_b_data = lora_b->Data<float>();
+  const int32_t* adapter_index_data = adapter_index->Data<int32_t>();
+  const float* scale_data = scale != nullptr ? scale->Data<float>() : nullptr;
+  float* output_data = output->MutableData<float>();
+
+  const size_t M = narrow<size_t>(sequence_length);
+  const size_t K = narrow<size_t>(hidden_size);
+  const size_t N = narrow<size_t>(output_size);
+  const size_t R = narrow<size_t>(rank);
+
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+  auto intermediate = IAllocator::MakeUniquePtr<float>(allocator, SafeInt<size_t>(batch_size) * M * R);
+
+  InlinedVector<MLAS_SGEMM_DATA_PARAMS> down_projections;
+  InlinedVector<MLAS_SGEMM_DATA_PARAMS> up_projections;
+  down_projections.reserve(narrow<size_t>(batch_size));
+  up_projections.reserve(narrow<size_t>(batch_size));
+
+  for (int64_t b = 0; b < batch_size; b++) {
+    const int32_t index = adapter_index_data[b];
+    if (index < 0) {
+      continue;
+    }
+    ORT_RETURN_IF_NOT(index < num_adapters, "adapter_index ", index, " is out of range [0, ", num_adapters, ")");
+
+    float* intermediate_row = intermediate.get() + SafeInt<size_t>(b) * M * R;
+
+    MLAS_SGEMM_DATA_PARAMS down;
+    down.A = input_data + SafeInt<size_t>(b) * M * K;
+    down.lda = K;
+    down.B = lora_a_data + SafeInt<size_t>(index) * K * R;
+    down.ldb = R;
+    down.C = intermediate_row;
+    down.ldc = R;
+    down_projections.push_back(down);
+
+    MLAS_SGEMM_DATA_PARAMS up;
+    up.A = intermediate_row;
+    up.lda = R;
+    up.B = lora_b_data + SafeInt<size_t>(index) * R * N;
+    up.ldb = N;
+    up.C = output_data + SafeInt<size_t>(b) * M * N;
+    up.ldc = N;
+    up.alpha = scale_data != nullptr ? scale_data[index] : 1.0f;
+    up.beta = 1.0f;
+    up_projections.push_back(up);
+  }
+
+  if (down_projections.empty()) {
+    return Status::OK();
+  }
+
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+  MlasGemmBatch(CblasNoTrans, CblasNoTrans, M, R, K, down_projections.data(), down_projections.size(), thread_pool);
+  MlasGemmBatch(CblasNoTrans, CblasNoTrans, M, N, R, up_projections.data(), up_projections.size(), thread_pool);
+
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
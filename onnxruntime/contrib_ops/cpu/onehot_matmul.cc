@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+
+#include "core/common/common.h"
+#include "core/common/narrow.h"
+#include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+namespace contrib {
+
+// MatMul(OneHot(indices, depth, [0, 1], axis=-1), B) computed as a gather of the rows of B.
+// Created by OneHotMatMulFusion.
+class OneHotMatMul final : public OpKernel {
+ public:
+  explicit OneHotMatMul(const OpKernelInfo& info) : OpKernel(info) {}
+  Status Compute(OpKernelContext* context) const override;
+
+ private:
+  template <typename TIndex>
+  static void GatherRows(concurrency::ThreadPool* thread_pool, gsl::span<const TIndex> indices,
+                         const float* b_data, int64_t depth, size_t cols, float* y_data);
+};
+
+ONNX_OPERATOR_KERNEL_EX(
+    OneHotMatMul,
+    kMSDomain,
+    1,
+    kCpuExecutionProvider,
+    KernelDefBuilder()
+        .TypeConstraint("T1", BuildKernelDefConstraints<int32_t, int64_t>())
+        .TypeConstraint("T", DataTypeImpl::GetTensorType<float>()),
+    OneHotMatMul);
+
+template <typename TIndex>
+void OneHotMatMul::GatherRows(concurrency::ThreadPool* thread_pool, gsl::span<const TIndex> indices,
+                              const float* b_data, int64_t depth, size_t cols, float* y_data) {
+  const double row_bytes = static_cast<double>(cols * sizeof(float));
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, narrow<std::ptrdiff_t>(indices.size()),
+      TensorOpCost{row_bytes, row_bytes, static_cast<double>(cols)},
+      [indices, b_data, depth, cols, y_data](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (auto i = static_cast<size_t>(first), end = static_cast<size_t>(last); i < end; ++i) {
+          int64_t index = static_cast<int64_t>(indices[i]);
+          if (index < 0) {
+            index += depth;
+          }
+          float* row = y_data + i * cols;
+          if (index >= 0 && index < depth) {
+            std::copy_n(b_data + static_cast<size_t>(index) * cols, cols, row);
+          } else {
+            std::fill_n(row, cols, 0.f);
+          }
+        }
+      });
+}
+
+Status OneHotMatMul::Compute(OpKernelContext* context) const {
+  const Tensor* indices = context->Input<Tensor>(0);
+  const Tensor* B = context->Input<Tensor>(1);
+  const auto& b_shape = B->Shape();
+  ORT_RETURN_IF_NOT(b_shape.NumDimensions() == 2, "B must be 2-dimensional, got shape ", b_shape);
+
+  const int64_t depth = b_shape[0];
+  const size_t cols = narrow<size_t>(b_shape[1]);
+  TensorShapeVector output_dims = indices->Shape().AsShapeVector();
+  output_dims.push_back(b_shape[1]);
+  Tensor* Y = context->Output(0, TensorShape(output_dims));
+  if (Y->Shape().Size() == 0) {
+    return Status::OK();
+  }
+
+  auto* thread_pool = context->GetOperatorThreadPool();
+  if (indices->IsDataType<int32_t>()) {
+    GatherRows(thread_pool, indices->DataAsSpan<int32_t>(), B->Data<float>(), depth, cols, Y->MutableData<float>());
+  } else {
+    GatherRows(thread_pool, indices->DataAsSpan<int64_t>(), B->Data<float>(), depth, cols, Y->MutableData<float>());
+  }
+  return Status::OK();
+}
+
+}  // namespace contrib
+}  // namespace onnxruntime
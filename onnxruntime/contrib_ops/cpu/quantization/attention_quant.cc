@@ -3,6 +3,7 @@
 
 #include "core/framework/op_kernel.h"
 #include "contrib_ops/cpu/bert/attention_cpu_base.h"
+#include "contrib_ops/cpu/bert/attention_helper.h"
 #include "core/providers/common.h"
 #include "core/util/math.h"
 #include "core/util/qmath.h"
@@ -10,6 +11,7 @@
 #include "core/common/safeint.h"
 #include "core/platform/threadpool.h"
 #include "core/mlas/inc/mlas.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 
 using onnxruntime::concurrency::ThreadPool;
 
@@ -32,10 +34,23 @@ class QAttention : public OpKernel, public AttentionCPUBase {
                                    /*out*/ bool& used_shared_buffers) override;
 
  private:
+  // Computes Softmax(Q x K' * scale + mask) x V with 8-bit integer GEMMs. Q, K and V are quantized per head with
+  // dynamic parameters. Dequantize, scale, mask, softmax and requantize of the attention probabilities are fused
+  // into one pass over each head, so the float probabilities are never materialized for the whole batch.
+  Status ComputeInt8Attention(const T* Q, const T* K, const T* V,
+                              const Tensor* mask_index,
+                              Tensor* output,
+                              int batch_size,
+                              int sequence_length,
+                              int head_size,
+                              int hidden_size,
+                              OpKernelContext* context) const;
+
   IAllocatorUniquePtr<void> packed_weights_;
   size_t packed_weights_size_;
   TensorShape weight_shape_;
   bool weights_is_signed_;
+  bool use_int8_attention_;
 };
 
 // These ops are internal-only, so register outside of onnx
@@ -54,6 +69,8 @@ ONNX_OPERATOR_TYPED_KERNEL_EX(
 
 template <typename T>
 QAttention<T>::QAttention(const OpKernelInfo& info) : OpKernel(info), AttentionCPUBase(info, true) {
+  use_int8_attention_ =
+      info.GetConfigOptions().GetConfigOrDefault(kOrtSessionOptionsQAttentionInt8Attention, "0") == "1";
 }
 
 template <typename T>
@@ -287,6 +304,14 @@ Status QAttention<T>::Compute(OpKernelContext* context) const {
     MlasGemmBatch(gemm_shape, gemm_data_vec.data(), loop_len, tp);
   }
 
+  // The int8 path has no past state, so it is only used when present is not requested either.
+  const auto& output_defs = OpKernel::Node().OutputDefs();
+  const bool has_present = output_defs.size() > 1 && output_defs[1]->Exists();
+  if (use_int8_attention_ && past_tensor == nullptr && !has_present) {
+    return ComputeInt8Attention(Q, K, V, mask_index, output, batch_size, sequence_length, head_size, hidden_size,
+                                context);
+  }
+
   // Compute the attention score and apply the score to V
   return ApplyAttention(Q, K, V, mask_index, past_tensor, nullptr /* past_key */, nullptr /* past_value*/,
                         output, nullptr /* present_key */, nullptr /* present_value */, nullptr /* output_qk */,
@@ -294,5 +319,147 @@ Status QAttention<T>::Compute(OpKernelContext* context) const {
                         head_size, head_size, hidden_size, nullptr /* rel_pos_bias */, context);
 }
 
+template <typename T>
+Status QAttention<T>::ComputeInt8Attention(const T* Q, const T* K, const T* V,
+                                           const Tensor* mask_index,
+                                           Tensor* output,
+                                           int batch_size,
+                                           int sequence_length,
+                                           int head_size,
+                                           int hidden_size,
+                                           OpKernelContext* context) const {
+  AllocatorPtr allocator;
+  ORT_RETURN_IF_ERROR(context->GetTempSpaceAllocator(&allocator));
+
+  const int total_sequence_length = sequence_length;
+  const size_t head_chunk_length = SafeInt<size_t>(sequence_length) * head_size;             // S x H
+  const size_t probs_matrix_size = SafeInt<size_t>(sequence_length) * total_sequence_length;  // S x T
+  const size_t loop_len = SafeInt<size_t>(batch_size) * num_heads_;
+
+  // Merge causal mask with padding mask, and convert values from 0/1 to -inf/0, then broadcast to 3D (BxSxT).
+  const bool causal = (is_unidirectional_ && sequence_length > 1);
+  IAllocatorUniquePtr<float> mask_data;
+  if (mask_index != nullptr || causal) {
+    const size_t mask_data_size = SafeInt<size_t>(batch_size) * probs_matrix_size;
+    mask_data = IAllocator::MakeUniquePtr<float>(allocator, mask_data_size);
+    memset(mask_data.get(), 0, mask_data_size * sizeof(float));
+    PrepareMask(mask_index != nullptr ? mask_index->Data<int32_t>() : nullptr,
+                mask_index != nullptr ? mask_index->Shape().GetDims() : gsl::span<const int64_t>{},
+                mask_data.get(), causal, batch_size, sequence_length, sequence_length, 0, mask_filter_value_);
+  }
+
+  // Quantized Q (S x H), transposed K (H x T) and V (T x H) of every head, followed by the int32 scores of Q x K'
+  // (reused in place for the float probabilities) and the requantized probabilities of every head.
+  auto quantized_qkv = IAllocator::MakeUniquePtr<uint8_t>(allocator, SafeInt<size_t>(loop_len) * head_chunk_length * 4);
+  auto scores = IAllocator::MakeUniquePtr<int32_t>(allocator, SafeInt<size_t>(loop_len) * probs_matrix_size);
+  auto quantized_probs = IAllocator::MakeUniquePtr<uint8_t>(allocator, SafeInt<size_t>(loop_len) * probs_matrix_size);
+
+  const float scale = scale_ == 0.0f ? 1.0f / sqrt(static_cast<float>(head_size)) : scale_;
+
+  // Attention probabilities are in [0, 1], so they are requantized with a fixed scale and a zero point of 0.
+  constexpr float probs_scale = 1.0f / 255.0f;
+  constexpr uint8_t probs_zero_point = 0;
+
+  T* output_data = output->MutableData<T>();
+
+  TensorOpCost unit_cost;
+  unit_cost.compute_cycles = static_cast<double>(SafeInt<ptrdiff_t>(4) * probs_matrix_size * head_size);
+  unit_cost.bytes_loaded = static_cast<double>(SafeInt<ptrdiff_t>(3) * head_chunk_length * sizeof(T));
+  unit_cost.bytes_stored = static_cast<double>(SafeInt<ptrdiff_t>(head_chunk_length) * sizeof(T));
+
+  ThreadPool::TryParallelFor(
+      context->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(loop_len), unit_cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i != end; ++i) {
+          const int batch_index = static_cast<int>(i / num_heads_);
+          const int head_index = static_cast<int>(i % num_heads_);
+
+          const T* q = Q + head_chunk_length * i;
+          const T* k = K + head_chunk_length * i;
+          const T* v = V + head_chunk_length * i;
+
+          uint8_t* q_quant = quantized_qkv.get() + head_chunk_length * 4 * i;
+          uint8_t* k_quant = q_quant + head_chunk_length;
+          uint8_t* k_quant_trans = k_quant + head_chunk_length;
+          uint8_t* v_quant = k_quant_trans + head_chunk_length;
+
+          float q_scale, k_scale, v_scale;
+          uint8_t q_zero_point, k_zero_point, v_zero_point;
+          GetQuantizationParameter(q, static_cast<int64_t>(head_chunk_length), q_scale, q_zero_point, nullptr);
+          GetQuantizationParameter(k, static_cast<int64_t>(head_chunk_length), k_scale, k_zero_point, nullptr);
+          GetQuantizationParameter(v, static_cast<int64_t>(head_chunk_length), v_scale, v_zero_point, nullptr);
+          MlasQuantizeLinear(q, q_quant, head_chunk_length, q_scale, q_zero_point);
+          MlasQuantizeLinear(k, k_quant, head_chunk_length, k_scale, k_zero_point);
+          MlasQuantizeLinear(v, v_quant, head_chunk_length, v_scale, v_zero_point);
+          MlasTranspose(k_quant, k_quant_trans, static_cast<size_t>(total_sequence_length),
+                        static_cast<size_t>(head_size));
+
+          // scores(S x T) = Q(S x H) x K'(H x T)
+          int32_t* head_scores = scores.get() + probs_matrix_size * i;
+          MLAS_GEMM_QUANT_SHAPE_PARAMS qk_shape;
+          qk_shape.M = static_cast<size_t>(sequence_length);
+          qk_shape.N = static_cast<size_t>(total_sequence_length);
+          qk_shape.K = static_cast<size_t>(head_size);
+
+          MLAS_GEMM_QUANT_DATA_PARAMS qk_params;
+          qk_params.A = q_quant;
+          qk_params.lda = static_cast<size_t>(head_size);
+          qk_params.ZeroPointA = q_zero_point;
+          qk_params.B = k_quant_trans;
+          qk_params.ldb = static_cast<size_t>(total_sequence_length);
+          qk_params.ZeroPointB = &k_zero_point;
+          qk_params.C = head_scores;
+          qk_params.ldc = static_cast<size_t>(total_sequence_length);
+          MlasGemm(qk_shape, qk_params, nullptr);
+
+          // Dequantize, scale and mask the scores in place, then softmax and requantize them.
+          float* head_probs = reinterpret_cast<float*>(head_scores);
+          const float dequant_scale = q_scale * k_scale * scale;
+          const float* head_mask = mask_data != nullptr ? mask_data.get() + probs_matrix_size * batch_index : nullptr;
+          if (head_mask != nullptr) {
+            for (size_t j = 0; j < probs_matrix_size; j++) {
+              head_probs[j] = static_cast<float>(head_scores[j]) * dequant_scale + head_mask[j];
+            }
+          } else {
+            for (size_t j = 0; j < probs_matrix_size; j++) {
+              head_probs[j] = static_cast<float>(head_scores[j]) * dequant_scale;
+            }
+          }
+          MlasComputeSoftmax(head_probs, head_probs, static_cast<size_t>(sequence_length),
+                             static_cast<size_t>(total_sequence_length), false, false, nullptr);
+
+          uint8_t* head_quantized_probs = quantized_probs.get() + probs_matrix_size * i;
+          MlasQuantizeLinear(head_probs, head_quantized_probs, probs_matrix_size, probs_scale, probs_zero_point);
+
+          // output(B, S, N, H) = probs(S x T) x V(T x H). The output processor writes the head directly into its
+          // slice of the output, so no transpose is needed afterwards.
+          T* head_output = output_data +
+                           (SafeInt<ptrdiff_t>(batch_index) * sequence_length * num_heads_ + head_index) * head_size;
+          const float pv_scale = probs_scale * v_scale;
+          MLAS_QGEMM_SCALE_BIAS_OUTPUT_PROCESSOR pv_output_processor(head_output, static_cast<size_t>(hidden_size),
+                                                                     &pv_scale, nullptr);
+
+          MLAS_GEMM_QUANT_SHAPE_PARAMS pv_shape;
+          pv_shape.M = static_cast<size_t>(sequence_length);
+          pv_shape.N = static_cast<size_t>(head_size);
+          pv_shape.K = static_cast<size_t>(total_sequence_length);
+
+          MLAS_GEMM_QUANT_DATA_PARAMS pv_params;
+          pv_params.A = head_quantized_probs;
+          pv_params.lda = static_cast<size_t>(total_sequence_length);
+          pv_params.ZeroPointA = probs_zero_point;
+          pv_params.B = v_quant;
+          pv_params.ldb = static_cast<size_t>(head_size);
+          pv_params.ZeroPointB = &v_zero_point;
+          pv_params.C = reinterpret_cast<int32_t*>(head_output);
+          pv_params.ldc = static_cast<size_t>(hidden_size);
+          pv_params.OutputProcessor = &pv_output_processor;
+          MlasGemm(pv_shape, pv_params, nullptr);
+        }
+      });
+
+  return Status::OK();
+}
+
 }  // namespace contrib
 }  // namespace onnxruntime
@@ -7,6 +7,7 @@
 #include "core/providers/cpu/math/top_k.h"
 #include "core/providers/cpu/math/softmax_shared.h"
 #include "core/providers/cpu/generator/random.h"
+#include "core/common/inlined_containers.h"
 #include "core/common/safeint.h"
 #include <gsl/gsl>
 #include "contrib_ops/cpu/transformers/sequences.h"
@@ -351,7 +352,7 @@ Status ProcessLogits(const OrtValue& logits,                                 //
 #endif
 
   // Apply all score processors that updates scores
-  logits_processors->Process(sequences, next_token_scores, step);
+  logits_processors->Process(sequences, next_token_scores, step, thread_pool);
 
 #ifdef DEBUG_GENERATION
   dumper->Print("next_token_scores after logits process", next_token_scores.data(), batch_size, num_beams, vocab_size);
@@ -482,7 +483,7 @@ Status GreedySearchProcessLogits(
 #endif
 
   // Apply all score processors that updates scores
-  logits_processors->Process(sequences, next_token_scores, step);
+  logits_processors->Process(sequences, next_token_scores, step, thread_pool);
 
 #ifdef DEBUG_GENERATION
   dumper->Print("next_token_scores after logits processor", next_token_scores.data(), batch_size, 1, vocab_size);
@@ -555,7 +556,67 @@ Status DeviceCopy(gsl::span<T> target, gsl::span<const T> source, Stream* /*stre
   return Status::OK();
 }
 
-// Copy present state to past state for GPT model
+template <typename T>
+void ReorderBeamBlocksInPlace(gsl::span<T> buffer,
+                              size_t block_size,
+                              gsl::span<const int32_t> beam_indices,
+                              AllocatorPtr allocator) {
+  const size_t batch_beam_size = beam_indices.size();
+  ORT_ENFORCE(buffer.size() >= batch_beam_size * SafeInt<size_t>(block_size));
+
+  // A block only needs to be staged when it is read by another beam and is itself overwritten.
+  // Beams that keep their own history are left untouched, so the copy cost is proportional to
+  // the number of beams that diverged in this step rather than to the whole batch.
+  InlinedVector<bool> is_source(batch_beam_size, false);
+  bool is_identity = true;
+  for (size_t j = 0; j < batch_beam_size; j++) {
+    const size_t source = static_cast<size_t>(beam_indices[j]);
+    ORT_ENFORCE(source < batch_beam_size, "beam index out of range: ", source);
+    if (source != j) {
+      is_source[source] = true;
+      is_identity = false;
+    }
+  }
+
+  if (is_identity) {
+    return;
+  }
+
+  InlinedVector<int> staged_slot(batch_beam_size, -1);
+  size_t num_staged = 0;
+  for (size_t j = 0; j < batch_beam_size; j++) {
+    if (static_cast<size_t>(beam_indices[j]) != j && is_source[j]) {
+      staged_slot[j] = static_cast<int>(num_staged++);
+    }
+  }
+
+  IAllocatorUniquePtr<T> staging;
+  gsl::span<T> staging_span;
+  if (num_staged > 0) {
+    staging = IAllocator::MakeUniquePtr<T>(allocator, num_staged * SafeInt<size_t>(block_size));
+    staging_span = gsl::make_span<T>(staging.get(), num_staged * block_size);
+    for (size_t j = 0; j < batch_beam_size; j++) {
+      if (staged_slot[j] >= 0) {
+        gsl::copy(buffer.subspan(j * block_size, block_size),
+                  staging_span.subspan(staged_slot[j] * SafeInt<size_t>(block_size), block_size));
+      }
+    }
+  }
+
+  for (size_t j = 0; j < batch_beam_size; j++) {
+    const size_t source = static_cast<size_t>(beam_indices[j]);
+    if (source == j) {
+      continue;
+    }
+
+    gsl::span<const T> source_block = staged_slot[source] >= 0
+                                          ? staging_span.subspan(staged_slot[source] * SafeInt<size_t>(block_size), block_size)
+                                          : buffer.subspan(source * block_size, block_size);
+    gsl::copy(source_block, buffer.subspan(j * block_size, block_size));
+  }
+}
+
+// Reorder present state in place so that it can be fed as past state for GPT model
 template <typename T>
 void PickGptPastState(const std::vector<OrtValue>& last_outputs,
                       std::vector<OrtValue>& next_inputs,
@@ -565,34 +626,21 @@ void PickGptPastState(const std::vector<OrtValue>& last_outputs,
                       AllocatorPtr allocator) {
   int num_present_tensors = static_cast<int>(last_outputs.size()) - gpt_subgraph_first_present_output_idx;
   for (ptrdiff_t i = 0; i < num_present_tensors; ++i) {
-    const OrtValue& present = last_outputs[gpt_subgraph_first_present_output_idx + i];
+    // The present tensor is owned by the fetches of last iteration and is not read again after this point,
+    // so its per-beam blocks can be remapped in place instead of being copied into a new past tensor.
+    OrtValue present = last_outputs[gpt_subgraph_first_present_output_idx + i];
 
     // shape is like (2, batch_beam_size, 12, past_seq_len, 64)
     const TensorShape& past_shape = present.Get<Tensor>().Shape();
-    auto block_size_per_beam = past_shape[2] * past_shape[3] * past_shape[4];
-    auto past_key_size = past_shape[1] * past_shape[2] * past_shape[3] * past_shape[4];
-
-    // Create a tensor with same shape.
-    // TODO(tianleiwu): allocate one buffer for all layers
-    OrtValue past;
-    auto past_type = DataTypeImpl::GetType<T>();
-    Tensor::InitOrtValue(past_type, past_shape, allocator, past);
-
-    gsl::span<T> past_span = gsl::make_span<T>(past.GetMutable<Tensor>()->MutableData<T>(), onnxruntime::narrow<size_t>(past_shape.Size()));
-    gsl::span<const T> present_span = gsl::make_span<const T>(present.Get<Tensor>().Data<T>(), onnxruntime::narrow<size_t>(past_shape.Size()));
-    for (size_t j = 0; j < beam_indices.size(); j++) {
-      int32_t beam_index = beam_indices[j];
-      gsl::span<const T> present_key = present_span.subspan(beam_index * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::span<const T> present_value = present_span.subspan(past_key_size + beam_index * SafeInt<size_t>(block_size_per_beam),
-                                                              onnxruntime::narrow<size_t>(block_size_per_beam));
-
-      gsl::span<T> past_key = past_span.subspan(j * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::span<T> past_value = past_span.subspan(past_key_size + j * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::copy(present_key, past_key);
-      gsl::copy(present_value, past_value);
-    }
+    auto block_size_per_beam = onnxruntime::narrow<size_t>(past_shape[2] * past_shape[3] * past_shape[4]);
+    auto past_key_size = onnxruntime::narrow<size_t>(past_shape[1] * past_shape[2] * past_shape[3] * past_shape[4]);
+
+    gsl::span<T> present_span = present.GetMutable<Tensor>()->MutableDataAsSpan<T>();
+    ReorderBeamBlocksInPlace<T>(present_span.subspan(0, past_key_size), block_size_per_beam, beam_indices, allocator);
+    ReorderBeamBlocksInPlace<T>(present_span.subspan(past_key_size, past_key_size), block_size_per_beam, beam_indices,
+                                allocator);
 
-    next_inputs[gpt_subgraph_first_past_input_idx + i] = past;
+    next_inputs[gpt_subgraph_first_past_input_idx + i] = present;
   }
 }
 
@@ -756,7 +804,7 @@ Status CreateEncoderInputs(
   return Status::OK();
 }
 
-// Copy present state to past state for T5 model
+// Reorder present state in place so that it can be fed as past state for T5 model
 template <typename T>
 void PickT5PastState(const std::vector<OrtValue>& last_outputs,
                      std::vector<OrtValue>& next_inputs,
@@ -766,27 +814,16 @@ void PickT5PastState(const std::vector<OrtValue>& last_outputs,
                      int t5_decoder_first_present_output_idx,
                      AllocatorPtr allocator) {
   for (ptrdiff_t i = 0; i < num_present_tensors; ++i) {
-    const OrtValue& present = last_outputs[t5_decoder_first_present_output_idx + i];
+    OrtValue present = last_outputs[t5_decoder_first_present_output_idx + i];
 
     // shape is like (batch_beam_size, 12, past_seq_len, 64)
     const TensorShape& past_shape = present.Get<Tensor>().Shape();
-    auto block_size_per_beam = past_shape[1] * past_shape[2] * past_shape[3];
-
-    // Create a tensor with same shape.
-    // TODO(tianleiwu): allocate one buffer for all layers
-    OrtValue past;
-    Tensor::InitOrtValue(DataTypeImpl::GetType<T>(), past_shape, allocator, past);
-
-    gsl::span<T> past_span = gsl::make_span<T>(past.GetMutable<Tensor>()->MutableData<T>(), onnxruntime::narrow<size_t>(past_shape.Size()));
-    gsl::span<const T> present_span = gsl::make_span<const T>(present.Get<Tensor>().Data<T>(), onnxruntime::narrow<size_t>(past_shape.Size()));
-    for (size_t j = 0; j < beam_indices.size(); j++) {
-      int32_t beam_index = beam_indices[j];
-      gsl::span<const T> present_beam = present_span.subspan(beam_index * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::span<T> past_beam = past_span.subspan(j * SafeInt<size_t>(block_size_per_beam), onnxruntime::narrow<size_t>(block_size_per_beam));
-      gsl::copy(present_beam, past_beam);
-    }
+    auto block_size_per_beam = onnxruntime::narrow<size_t>(past_shape[1] * past_shape[2] * past_shape[3]);
+
+    ReorderBeamBlocksInPlace<T>(present.GetMutable<Tensor>()->MutableDataAsSpan<T>(), block_size_per_beam,
+                                beam_indices, allocator);
 
-    next_inputs[t5_decoder_first_past_input_idx + i] = past;
+    next_inputs[t5_decoder_first_past_input_idx + i] = present;
   }
 }
 
@@ -1039,6 +1076,18 @@ template Status UpdateDecoderFeeds<MLFloat16>(
     transformers::Sequences& sequences,
     const IConsoleDumper* dumper);
 
+template void ReorderBeamBlocksInPlace<float>(
+    gsl::span<float> buffer,
+    size_t block_size,
+    gsl::span<const int32_t> beam_indices,
+    AllocatorPtr allocator);
+
+template void ReorderBeamBlocksInPlace<MLFloat16>(
+    gsl::span<MLFloat16> buffer,
+    size_t block_size,
+    gsl::span<const int32_t> beam_indices,
+    AllocatorPtr allocator);
+
 template void ExpandInputs<int32_t>(const OrtValue& input, int num_beams, AllocatorPtr allocator, OrtValue& expanded);
 
 template Status ExpandBuffer<int32_t>(
@@ -387,6 +387,14 @@ Status CreateWhisperEncoderInputs(
 template <typename T>
 void ExpandInputs(const OrtValue& input, int num_beams, AllocatorPtr allocator, OrtValue& expanded);
 
+// Rearrange per-beam blocks of a past state buffer in place: block j receives the content of block beam_indices[j].
+// Only blocks of beams that diverged are copied, and a block is staged only when it is both read and overwritten.
+template <typename T>
+void ReorderBeamBlocksInPlace(gsl::span<T> buffer,
+                              size_t block_size,
+                              gsl::span<const int32_t> beam_indices,
+                              AllocatorPtr allocator);
+
 template <typename T>
 Status ExpandBuffer(
     Stream* stream,
@@ -105,7 +105,8 @@ struct ISequences {
 
 struct ILogitsProcessorList {
   virtual ~ILogitsProcessorList() {}
-  virtual void Process(const ISequences* sequences, gsl::span<float>& next_token_scores, int step) = 0;
+  virtual void Process(const ISequences* sequences, gsl::span<float>& next_token_scores, int step,
+                       onnxruntime::concurrency::ThreadPool* thread_pool) = 0;
 };
 
 // Interface for all scorers for beam search or beam sample.
@@ -3,8 +3,10 @@
 
 #pragma once
 #include <algorithm>
+#include <numeric>
 #include <vector>
 
+#include "core/common/safeint.h"
 #include "core/common/span_utils.h"
 #include "contrib_ops/cpu/transformers/greedy_search_impl_base.h"
 
@@ -101,6 +103,17 @@ class GreedySearchGpt : public GreedySearchBase<T, ParametersT> {
       gsl::span<const int32_t> next_tokens,
       int past_sequence_length);
 
+  // Copy the slices of the given rows along the batch axis into a new tensor.
+  void GatherBatchRows(const OrtValue& input,
+                       size_t batch_axis,
+                       gsl::span<const int32_t> rows,
+                       OrtValue& output);
+
+  // Copy the rows of a tensor computed for active sequences back to their positions in a full batch tensor.
+  void ScatterBatchRows(const OrtValue& input,
+                        gsl::span<const int32_t> rows,
+                        OrtValue& output);
+
   const SessionState* init_run_decoder_session_state_ = nullptr;
   GptSubgraph* init_run_gpt_subgraph_ = nullptr;
   GptSubgraph& gpt_subgraph_;
@@ -187,6 +200,52 @@ Status GreedySearchGpt<T, ParametersT>::UpdateFeeds(
                             false);
 }
 
+template <typename T, typename ParametersT>
+void GreedySearchGpt<T, ParametersT>::GatherBatchRows(const OrtValue& input,
+                                                      size_t batch_axis,
+                                                      gsl::span<const int32_t> rows,
+                                                      OrtValue& output) {
+  const Tensor& input_tensor = input.Get<Tensor>();
+  const TensorShape& input_shape = input_tensor.Shape();
+  const int64_t batch_size = input_shape[batch_axis];
+  const size_t outer_size = onnxruntime::narrow<size_t>(input_shape.SizeToDimension(batch_axis));
+  const size_t element_size = input_tensor.SizeInBytes() / onnxruntime::narrow<size_t>(input_shape.Size());
+  const size_t block_bytes = SafeInt<size_t>(input_shape.SizeFromDimension(batch_axis + 1)) * element_size;
+
+  TensorShapeVector output_dims = input_shape.AsShapeVector();
+  output_dims[batch_axis] = static_cast<int64_t>(rows.size());
+  Tensor::InitOrtValue(input_tensor.DataType(), TensorShape(output_dims), this->temp_space_allocator_, output);
+
+  const char* source = static_cast<const char*>(input_tensor.DataRaw());
+  char* target = static_cast<char*>(output.GetMutable<Tensor>()->MutableDataRaw());
+  for (size_t i = 0; i < outer_size; i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      memcpy(target + (i * rows.size() + j) * block_bytes,
+             source + (i * SafeInt<size_t>(batch_size) + rows[j]) * block_bytes,
+             block_bytes);
+    }
+  }
+}
+
+template <typename T, typename ParametersT>
+void GreedySearchGpt<T, ParametersT>::ScatterBatchRows(const OrtValue& input,
+                                                       gsl::span<const int32_t> rows,
+                                                       OrtValue& output) {
+  const Tensor& input_tensor = input.Get<Tensor>();
+  const TensorShape& input_shape = input_tensor.Shape();
+  const size_t block_bytes = input_tensor.SizeInBytes() / rows.size();
+
+  Tensor* output_tensor = output.GetMutable<Tensor>();
+  ORT_ENFORCE(output_tensor->SizeInBytes() / onnxruntime::narrow<size_t>(output_tensor->Shape()[0]) == block_bytes &&
+              static_cast<size_t>(input_shape[0]) == rows.size());
+
+  const char* source = static_cast<const char*>(input_tensor.DataRaw());
+  char* target = static_cast<char*>(output_tensor->MutableDataRaw());
+  for (size_t j = 0; j < rows.size(); j++) {
+    memcpy(target + rows[j] * SafeInt<size_t>(block_bytes), source + j * block_bytes, block_bytes);
+  }
+}
+
 template <typename T, typename ParametersT>
 Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_run_feeds_fetches_manager,
                                                 const FeedsFetchesManager& feeds_fetches_manager) {
@@ -268,6 +327,19 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
                        this->temp_space_allocator_->Info(),
                        position_ids);
 
+  // Sequences that reach EOS are evicted from the subgraph feeds between decode steps, so the decoder subgraph
+  // only runs on rows that are still generating. active_rows maps a row of the feeds to its row in the batch,
+  // and logits of active rows are scattered back to a full batch buffer before the next token is generated.
+  // This is only done on CPU for greedy search: sampling consumes random numbers for every row, and the
+  // shared past/present buffer has a fixed batch dimension.
+  const bool evict_finished_rows = !this->IsCuda() &&
+                                   !gpt_subgraph_.past_present_share_buffer_ &&
+                                   !std::is_same<ParametersT, SamplingParameters>::value;
+  std::vector<int32_t> active_rows(static_cast<size_t>(parameters->BatchBeamSize()));
+  std::iota(active_rows.begin(), active_rows.end(), 0);
+  std::vector<int32_t> active_next_tokens;
+  OrtValue full_batch_logits;
+
   int current_length = parameters->sequence_length;
   int iteration_counter = 0;
   while (current_length < parameters->max_length) {
@@ -312,10 +384,23 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
 
     ORT_RETURN_IF_ERROR(status);
 
-    const OrtValue& logits = fetches[0];
+    const OrtValue* logits = &fetches[0];
+    if (active_rows.size() < static_cast<size_t>(parameters->BatchBeamSize())) {
+      if (!full_batch_logits.IsAllocated()) {
+        TensorShapeVector logits_dims = logits->Get<Tensor>().Shape().AsShapeVector();
+        logits_dims[0] = parameters->BatchBeamSize();
+        Tensor::InitOrtValue(logits->Get<Tensor>().DataType(), TensorShape(logits_dims),
+                             this->temp_space_allocator_, full_batch_logits);
+      }
+
+      // Logits of finished rows are stale, which is fine since their next token is always the pad token.
+      ScatterBatchRows(*logits, active_rows, full_batch_logits);
+      logits = &full_batch_logits;
+    }
+
     gsl::span<int32_t> next_tokens;
 
-    ORT_RETURN_IF_ERROR(this->GenerateNextToken(logits,
+    ORT_RETURN_IF_ERROR(this->GenerateNextToken(*logits,
                                                 next_tokens,
                                                 greedy_state,
                                                 sampling_state,
@@ -359,11 +444,60 @@ Status GreedySearchGpt<T, ParametersT>::Execute(const FeedsFetchesManager* init_
 
     // Prepare inputs for next round of subgraph call.
     if (current_length < parameters->max_length) {
+      gsl::span<const int32_t> feed_tokens = ReinterpretAsSpan<const int32_t>(next_tokens);
+
+      if (evict_finished_rows) {
+        // Rows of the current feeds that are still generating.
+        std::vector<int32_t> kept_rows;
+        kept_rows.reserve(active_rows.size());
+        for (size_t i = 0; i < active_rows.size(); i++) {
+          if (!eos_meet[active_rows[i]]) {
+            kept_rows.push_back(static_cast<int32_t>(i));
+          }
+        }
+
+        if (kept_rows.size() < active_rows.size()) {
+          // present_* has shape like (2, batch_size, num_heads, past_sequence_length, head_size)
+          for (size_t i = static_cast<size_t>(gpt_subgraph_.GetFirstPresentOutputIndex()); i < fetches.size(); i++) {
+            OrtValue present;
+            GatherBatchRows(fetches[i], 1, kept_rows, present);
+            fetches[i] = present;
+          }
+
+          OrtValue attention_mask;
+          GatherBatchRows(feeds[2], 0, kept_rows, attention_mask);
+          feeds[2] = attention_mask;
+
+          // Kept rows are in increasing order, so positions and row mapping can be compacted in place.
+          int32_t* positions = greedy_state.next_positions.data();
+          for (size_t k = 0; k < kept_rows.size(); k++) {
+            positions[k] = positions[kept_rows[k]];
+            active_rows[k] = active_rows[kept_rows[k]];
+          }
+          active_rows.resize(kept_rows.size());
+
+          int64_t position_dims[] = {static_cast<int64_t>(active_rows.size()), 1};
+          Tensor::InitOrtValue(DataTypeImpl::GetType<int32_t>(),
+                               TensorShape(&position_dims[0], 2),
+                               positions,
+                               this->temp_space_allocator_->Info(),
+                               position_ids);
+        }
+
+        if (active_rows.size() < static_cast<size_t>(parameters->BatchBeamSize())) {
+          active_next_tokens.resize(active_rows.size());
+          for (size_t k = 0; k < active_rows.size(); k++) {
+            active_next_tokens[k] = next_tokens[active_rows[k]];
+          }
+          feed_tokens = active_next_tokens;
+        }
+      }
+
       bool increase_position = (iteration_counter > 1);
 
       ORT_RETURN_IF_ERROR(UpdateFeeds(fetches, feeds, current_length,
                                       position_ids, increase_position,
-                                      ReinterpretAsSpan<const int32_t>(next_tokens),
+                                      feed_tokens,
                                       current_length - 1));
     }
     if (gpt_subgraph_.past_present_share_buffer_) {
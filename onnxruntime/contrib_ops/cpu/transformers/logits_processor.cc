@@ -6,6 +6,7 @@
 #include "core/common/narrow.h"
 #include "core/common/safeint.h"
 #include "core/common/span_utils.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/cpu/math/softmax_shared.h"
 #include "contrib_ops/cpu/transformers/logits_processor.h"
 #include "contrib_ops/cpu/utils/dump_tensor.h"
@@ -17,16 +18,17 @@ namespace onnxruntime {
 namespace contrib {
 namespace transformers {
 
-// Interface for all scorers for beam search or beam sample.
 template <typename T>
 MinLengthLogitsProcessor<T>::MinLengthLogitsProcessor(int min_length, int eos_token_id)
     : min_length_(min_length), eos_token_id_(eos_token_id) {}
 
 template <typename T>
 void MinLengthLogitsProcessor<T>::Process(const ISequences* sequences,
-                                          NextTokenScores<T>& next_token_scores) {
+                                          int /*batch_beam_index*/,
+                                          gsl::span<T> beam_token_scores) const {
   if (sequences->GetSequenceLength() < min_length_) {
-    next_token_scores.SetScore(eos_token_id_, std::numeric_limits<T>::lowest());
+    assert(eos_token_id_ >= 0 && eos_token_id_ < static_cast<int>(beam_token_scores.size()));
+    beam_token_scores[eos_token_id_] = std::numeric_limits<T>::lowest();
   }
 }
 
@@ -36,25 +38,21 @@ RepetitionPenaltyLogitsProcessor<T>::RepetitionPenaltyLogitsProcessor(float pena
 
 template <typename T>
 void RepetitionPenaltyLogitsProcessor<T>::Process(const ISequences* sequences,
-                                                  NextTokenScores<T>& next_token_scores) {
-  const int batch_beam_size = next_token_scores.batch_beam_size;
-  for (int i = 0; i < batch_beam_size; i++) {
-    gsl::span<T> beam_token_scores = next_token_scores.GetScores(i);
-    gsl::span<const int32_t> sequence = sequences->GetSequence(i);
-
-    // Find unique word IDs in sequence.
-    std::unordered_set<int32_t> unique_word_ids;
-    for (const auto& word_id : sequence) {
-      unique_word_ids.insert(word_id);
-    }
+                                                  int batch_beam_index,
+                                                  gsl::span<T> beam_token_scores) const {
+  gsl::span<const int32_t> sequence = sequences->GetSequence(batch_beam_index);
 
-    for (const int32_t word_id : unique_word_ids) {
-      T score = beam_token_scores[word_id];
+  // Find unique word IDs in sequence. Sorting a small copy is much cheaper than building a hash set per row.
+  InlinedVector<int32_t> unique_word_ids(sequence.begin(), sequence.end());
+  std::sort(unique_word_ids.begin(), unique_word_ids.end());
+  auto unique_end = std::unique(unique_word_ids.begin(), unique_word_ids.end());
 
-      // If score < 0, then repetition penalty > 1.0 has to multiplied to reduce the previous token probability,
-      // This assumes that scores are either positive (like ctrl) or negative (like GPT-2), but not a mixture.
-      beam_token_scores[word_id] = (score < 0 ? score * penalty_ : score / penalty_);
-    }
+  for (auto it = unique_word_ids.begin(); it != unique_end; ++it) {
+    T score = beam_token_scores[*it];
+
+    // If score < 0, then repetition penalty > 1.0 has to multiplied to reduce the previous token probability,
+    // This assumes that scores are either positive (like ctrl) or negative (like GPT-2), but not a mixture.
+    beam_token_scores[*it] = (score < 0 ? score * penalty_ : score / penalty_);
   }
 }
 
@@ -64,34 +62,48 @@ NoRepeatNGramLogitsProcessor<T>::NoRepeatNGramLogitsProcessor(int ngram_size) :
 
 template <typename T>
 void NoRepeatNGramLogitsProcessor<T>::Process(const ISequences* sequences,
-                                              NextTokenScores<T>& next_token_scores) {
+                                              int batch_beam_index,
+                                              gsl::span<T> beam_token_scores) const {
   if (ngram_size_ == 0 || ngram_size_ > sequences->GetSequenceLength()) {
     return;
   }
 
-  const gsl::index prefix_length = static_cast<gsl::index>(ngram_size_) - 1;
-  int batch_beam_size = next_token_scores.batch_beam_size;
+  gsl::span<const int32_t> sequence = sequences->GetSequence(batch_beam_index);
 
-  for (int i = 0; i < batch_beam_size; i++) {
-    gsl::span<T> beam_token_scores = next_token_scores.GetScores(i);
-    gsl::span<const int32_t> sequence = sequences->GetSequence(i);
-
-    gsl::span<const int32_t> prefix = sequence.subspan(sequence.size() - prefix_length);
-    ORT_ENFORCE(prefix.size() == narrow<size_t>(prefix_length));
+  if (ngram_size_ == 1) {
+    for (const int32_t word_id : sequence) {
+      beam_token_scores[word_id] = std::numeric_limits<T>::lowest();
+    }
+    return;
+  }
 
-    std::unordered_set<int32_t> blocked_word_ids;
-    for (int j = 0; j <= static_cast<int>(sequence.size()) - ngram_size_; j++) {
-      // Here we use naive algorithm for matching. The complexity is O(batch_beam_size * ngram_size * sequence_length)
-      // TODO(tianleiwu): build N-Gram index (hash table with prefix of length NGram - 1 as key,
-      //                  and list of last word of NGram as value) for fast matching.
-      if (ngram_size_ == 1 || SpanEq(prefix, sequence.subspan(j, prefix_length))) {
-        blocked_word_ids.insert(sequence[static_cast<gsl::index>(j) + prefix_length]);
-      }
+  const size_t prefix_length = static_cast<size_t>(ngram_size_) - 1;
+  gsl::span<const int32_t> prefix = sequence.subspan(sequence.size() - prefix_length);
+  ORT_ENFORCE(prefix.size() == prefix_length);
+
+  // Match the prefix against every window of the sequence with a rolling hash, so that the cost is
+  // O(sequence_length) per beam instead of O(ngram_size * sequence_length). A hash hit is verified before
+  // the following word is blocked. Blocking is idempotent, so no set of blocked words is needed.
+  constexpr uint64_t kBase = 0x100000001B3ULL;
+  uint64_t leading_power = 1;  // kBase^(prefix_length - 1)
+  uint64_t prefix_hash = 0;
+  uint64_t window_hash = 0;
+  for (size_t k = 0; k < prefix_length; k++) {
+    prefix_hash = prefix_hash * kBase + static_cast<uint32_t>(prefix[k]);
+    window_hash = window_hash * kBase + static_cast<uint32_t>(sequence[k]);
+    if (k > 0) {
+      leading_power *= kBase;
     }
+  }
 
-    for (const int32_t word_id : blocked_word_ids) {
-      beam_token_scores[word_id] = std::numeric_limits<T>::lowest();
+  const size_t num_windows = sequence.size() - prefix_length;  // windows that are followed by a word
+  for (size_t j = 0; j < num_windows; j++) {
+    if (window_hash == prefix_hash && SpanEq(prefix, sequence.subspan(j, prefix_length))) {
+      beam_token_scores[sequence[j + prefix_length]] = std::numeric_limits<T>::lowest();
     }
+
+    window_hash = (window_hash - static_cast<uint32_t>(sequence[j]) * leading_power) * kBase +
+                  static_cast<uint32_t>(sequence[j + prefix_length]);
   }
 }
 
@@ -102,50 +114,43 @@ VocabMaskLogitsProcessor<T>::VocabMaskLogitsProcessor(const gsl::span<const int3
 
 template <typename T>
 void VocabMaskLogitsProcessor<T>::Process(const ISequences* /*sequences*/,
-                                          NextTokenScores<T>& next_token_scores) {
+                                          int /*batch_beam_index*/,
+                                          gsl::span<T> beam_token_scores) const {
   assert(!vocab_mask_.empty());
 
   // Process vocabulary mask and set tokens with mask value 0 to -inf.
-  T* p = next_token_scores.scores.data();
-  // next_token_scores shape (batch_size * num_beams, vocab_size)
-  // vocab_mask shape (vocab_size).
-  for (int i = 0; i < next_token_scores.batch_beam_size; i++) {
-    for (int j = 0; j < next_token_scores.vocab_size; j++, p++) {
-      if (vocab_mask_[j] == 0) {
-        *p = std::numeric_limits<T>::lowest();
-      }
-    }
+  // vocab_mask shape (vocab_size). The loop is written as a select so that it can be vectorized.
+  T* p = beam_token_scores.data();
+  const int32_t* mask = vocab_mask_.data();
+  const size_t vocab_size = beam_token_scores.size();
+  for (size_t j = 0; j < vocab_size; j++) {
+    p[j] = mask[j] == 0 ? std::numeric_limits<T>::lowest() : p[j];
   }
 }
 
 template <typename T>
 PrefixVocabMaskLogitsProcessor<T>::PrefixVocabMaskLogitsProcessor(const gsl::span<const int32_t>& prefix_vocab_mask,
-                                                                  int batch_size)
+                                                                  int batch_size,
+                                                                  int num_beams)
     : prefix_vocab_mask_(prefix_vocab_mask),
-      batch_size_(batch_size) {
+      batch_size_(batch_size),
+      num_beams_(num_beams) {
 }
 
 template <typename T>
 void PrefixVocabMaskLogitsProcessor<T>::Process(const ISequences* /*sequences*/,
-                                                NextTokenScores<T>& next_token_scores) {
+                                                int batch_beam_index,
+                                                gsl::span<T> beam_token_scores) const {
   assert(!prefix_vocab_mask_.empty());
-
-  // next_token_scores shape (batch_size * num_beams, vocab_size)
-  int num_beams = next_token_scores.batch_beam_size / batch_size_;
-  assert(num_beams * batch_size_ == next_token_scores.batch_beam_size);
+  assert(batch_beam_index / num_beams_ < batch_size_);
 
   // Process prefix vocabulary mask and set tokens with mask value 0 to -inf.
   // prefix_vocab_mask shape (batch_size, vocab_size).
-  T* p = next_token_scores.scores.data();
-  for (int i = 0; i < batch_size_; i++) {
-    size_t prefix_vocab_mask_offset = SafeInt<size_t>(i) * next_token_scores.vocab_size;
-    for (int j = 0; j < num_beams; j++) {
-      for (int k = 0; k < next_token_scores.vocab_size; k++, p++) {
-        if (prefix_vocab_mask_[prefix_vocab_mask_offset + static_cast<size_t>(k)] == 0) {
-          *p = std::numeric_limits<T>::lowest();
-        }
-      }
-    }
+  const size_t vocab_size = beam_token_scores.size();
+  const int32_t* mask = prefix_vocab_mask_.data() + SafeInt<size_t>(batch_beam_index / num_beams_) * vocab_size;
+  T* p = beam_token_scores.data();
+  for (size_t k = 0; k < vocab_size; k++) {
+    p[k] = mask[k] == 0 ? std::numeric_limits<T>::lowest() : p[k];
   }
 }
 
@@ -155,36 +160,42 @@ TemperatureLogitsProcessor<T>::TemperatureLogitsProcessor(float temperature) : t
 
 template <typename T>
 void TemperatureLogitsProcessor<T>::Process(const ISequences* /*sequences*/,
-                                            NextTokenScores<T>& next_token_scores) {
+                                            int /*batch_beam_index*/,
+                                            gsl::span<T> beam_token_scores) const {
   if (temperature_ == 1.0f) {
     return;
   }
 
-  T* p = next_token_scores.scores.data();
-  for (size_t i = 0; i < next_token_scores.scores.size(); i++) {
-    *p /= temperature_;
-    ++p;
+  T* p = beam_token_scores.data();
+  const size_t vocab_size = beam_token_scores.size();
+  for (size_t i = 0; i < vocab_size; i++) {
+    p[i] /= temperature_;
   }
 }
 
 template <typename T>
 PresencePenaltyLogitsProcessor<T>::PresencePenaltyLogitsProcessor(const gsl::span<const int32_t>& presence_mask,
-                                                                  float presence_penalty)
-    : presence_mask_(presence_mask), presence_penalty_(presence_penalty) {
+                                                                  float presence_penalty,
+                                                                  int num_beams)
+    : presence_mask_(presence_mask), presence_penalty_(presence_penalty), num_beams_(num_beams) {
 }
 
 template <typename T>
-void PresencePenaltyLogitsProcessor<T>::Process(const ISequences*,
-                                                NextTokenScores<T>& next_token_scores) {
+void PresencePenaltyLogitsProcessor<T>::Process(const ISequences* /*sequences*/,
+                                                int batch_beam_index,
+                                                gsl::span<T> beam_token_scores) const {
   if (presence_penalty_ == 0.0f) {
     return;
   }
 
   assert(!presence_mask_.empty());
 
-  T* p = next_token_scores.scores.data();
-  for (size_t i = 0; i < next_token_scores.scores.size(); i++) {
-    *p -= presence_mask_[i] * presence_penalty_;
+  // presence_mask shape (batch_size, vocab_size).
+  const size_t vocab_size = beam_token_scores.size();
+  const int32_t* mask = presence_mask_.data() + SafeInt<size_t>(batch_beam_index / num_beams_) * vocab_size;
+  T* p = beam_token_scores.data();
+  for (size_t i = 0; i < vocab_size; i++) {
+    p[i] -= static_cast<T>(mask[i]) * presence_penalty_;
   }
 }
 
@@ -202,15 +213,36 @@ void LogitsProcessorList::Init(const SamplingParameters& parameters) {
 
 void LogitsProcessorList::Process(const ISequences* sequences,
                                   gsl::span<float>& next_token_scores,
-                                  int step) {
-  NextTokenScores<float> input_scores = {next_token_scores, batch_beam_size_, vocab_size_};
-  for (size_t i = 0; i < processor_list_.size(); i++) {
-    // Prefix vocab mask is applied to first iteration only.
-    if (step > 1 && processor_list_[i] == prefix_vocab_mask_processor_.get()) {
+                                  int step,
+                                  onnxruntime::concurrency::ThreadPool* thread_pool) {
+  // Prefix vocab mask is applied to first iteration only.
+  InlinedVector<const ILogitsProcessor<float>*> active_processors;
+  active_processors.reserve(processor_list_.size());
+  for (const ILogitsProcessor<float>* processor : processor_list_) {
+    if (step > 1 && processor == prefix_vocab_mask_processor_.get()) {
       continue;
     }
-    processor_list_[i]->Process(sequences, input_scores);
+    active_processors.push_back(processor);
   }
+
+  if (active_processors.empty()) {
+    return;
+  }
+
+  // Apply all processors to one row before moving to the next row, and process rows in parallel.
+  NextTokenScores<float> input_scores = {next_token_scores, batch_beam_size_, vocab_size_};
+  const double cost = static_cast<double>(vocab_size_) * static_cast<double>(active_processors.size());
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(batch_beam_size_), cost,
+      [&](std::ptrdiff_t begin, std::ptrdiff_t end) {
+        for (std::ptrdiff_t i = begin; i < end; i++) {
+          const int batch_beam_index = static_cast<int>(i);
+          gsl::span<float> beam_token_scores = input_scores.GetScores(batch_beam_index);
+          for (const ILogitsProcessor<float>* processor : active_processors) {
+            processor->Process(sequences, batch_beam_index, beam_token_scores);
+          }
+        }
+      });
 }
 
 }  // namespace transformers
@@ -44,13 +44,24 @@ void DumpScores(const char* name, const NextTokenScores<T>& next_token_scores) {
 #endif
 
 // Interface for all scorers for beam search or beam sample.
+// A processor updates the scores of one row (one beam) at a time. This allows the processor list to apply all
+// processors in a single pass over a row while it is hot in cache, and to process rows in parallel.
 template <typename T>
 class ILogitsProcessor {
  public:
   virtual ~ILogitsProcessor() {}
 
   virtual void Process(const ISequences* sequences,
-                       NextTokenScores<T>& next_token_scores) = 0;
+                       int batch_beam_index,
+                       gsl::span<T> beam_token_scores) const = 0;
+
+  // Apply the processor to all rows of next token scores.
+  void Process(const ISequences* sequences,
+               NextTokenScores<T>& next_token_scores) const {
+    for (int i = 0; i < next_token_scores.batch_beam_size; i++) {
+      Process(sequences, i, next_token_scores.GetScores(i));
+    }
+  }
 };
 
 template <typename T>
@@ -58,8 +69,10 @@ class MinLengthLogitsProcessor : public ILogitsProcessor<T> {
  public:
   MinLengthLogitsProcessor(int min_length, int eos_token_id);
 
+  using ILogitsProcessor<T>::Process;
   void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+               int batch_beam_index,
+               gsl::span<T> beam_token_scores) const override;
 
  private:
   int min_length_;
@@ -71,8 +84,10 @@ class RepetitionPenaltyLogitsProcessor : public ILogitsProcessor<T> {
  public:
   RepetitionPenaltyLogitsProcessor(float penalty);
 
+  using ILogitsProcessor<T>::Process;
   void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+               int batch_beam_index,
+               gsl::span<T> beam_token_scores) const override;
 
  private:
   float penalty_;
@@ -83,8 +98,10 @@ class NoRepeatNGramLogitsProcessor : public ILogitsProcessor<T> {
  public:
   NoRepeatNGramLogitsProcessor(int ngram_size);
 
+  using ILogitsProcessor<T>::Process;
   void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+               int batch_beam_index,
+               gsl::span<T> beam_token_scores) const override;
 
  private:
   int ngram_size_;
@@ -95,8 +112,10 @@ class VocabMaskLogitsProcessor : public ILogitsProcessor<T> {
  public:
   VocabMaskLogitsProcessor(const gsl::span<const int32_t>& vocab_mask);
 
+  using ILogitsProcessor<T>::Process;
   void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+               int batch_beam_index,
+               gsl::span<T> beam_token_scores) const override;
 
  private:
   gsl::span<const int32_t> vocab_mask_;
@@ -105,14 +124,17 @@ class VocabMaskLogitsProcessor : public ILogitsProcessor<T> {
 template <typename T>
 class PrefixVocabMaskLogitsProcessor : public ILogitsProcessor<T> {
  public:
-  PrefixVocabMaskLogitsProcessor(const gsl::span<const int32_t>& vocab_mask, int batch_size);
+  PrefixVocabMaskLogitsProcessor(const gsl::span<const int32_t>& vocab_mask, int batch_size, int num_beams);
 
+  using ILogitsProcessor<T>::Process;
   void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+               int batch_beam_index,
+               gsl::span<T> beam_token_scores) const override;
 
  private:
   gsl::span<const int32_t> prefix_vocab_mask_;
   const int batch_size_;
+  const int num_beams_;
 };
 
 template <typename T>
@@ -120,8 +142,10 @@ class TemperatureLogitsProcessor : public ILogitsProcessor<T> {
  public:
   TemperatureLogitsProcessor(float temperature);
 
+  using ILogitsProcessor<T>::Process;
   void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+               int batch_beam_index,
+               gsl::span<T> beam_token_scores) const override;
 
  private:
   float temperature_;
@@ -146,14 +170,18 @@ template <typename T>
 class PresencePenaltyLogitsProcessor : public ILogitsProcessor<T> {
  public:
   PresencePenaltyLogitsProcessor(const gsl::span<const int32_t>& presence_mask,
-                                 float presence_penalty);
+                                 float presence_penalty,
+                                 int num_beams);
 
+  using ILogitsProcessor<T>::Process;
   void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override;
+               int batch_beam_index,
+               gsl::span<T> beam_token_scores) const override;
 
  private:
   gsl::span<const int32_t> presence_mask_;
   float presence_penalty_;
+  int num_beams_;
 };
 
 template <typename T>
@@ -176,108 +204,106 @@ class TimestampLogitsProcessor : public ILogitsProcessor<T> {
         beginning_timestamp_token_id_(beginning_timestamp_token_id),
         max_initial_timestamp_index_(max_initial_timestamp_index) {}
 
+  using ILogitsProcessor<T>::Process;
   void Process(const ISequences* sequences,
-               NextTokenScores<T>& next_token_scores) override {
-    const int batch_beam_size = next_token_scores.batch_beam_size;
-    const int vocab_size = next_token_scores.vocab_size;
-    for (int i = 0; i < batch_beam_size; i++) {
-      gsl::span<T> beam_token_scores = next_token_scores.GetScores(i);
-      gsl::span<const int32_t> sequence = sequences->GetSequence(i);
-      const size_t seq_length = sequence.size();
-
-      // Find first timestamp
-      size_t sample_begin = 0;
-      for (size_t j = 0; j < seq_length; j++) {
-        sample_begin++;
-        if (sequence[j] >= beginning_timestamp_token_id_) {
-          break;
-        }
+               int batch_beam_index,
+               gsl::span<T> beam_token_scores) const override {
+    const int vocab_size = static_cast<int>(beam_token_scores.size());
+    gsl::span<const int32_t> sequence = sequences->GetSequence(batch_beam_index);
+    const size_t seq_length = sequence.size();
+
+    // Find first timestamp
+    size_t sample_begin = 0;
+    for (size_t j = 0; j < seq_length; j++) {
+      sample_begin++;
+      if (sequence[j] >= beginning_timestamp_token_id_) {
+        break;
       }
+    }
 
-      // Suppress tokens
-      for (int j = 0; j < vocab_size; j++) {
-        // Suppress notimestamps and solm tokens
-        if (j == no_timestamps_token_id_ || j == start_of_lm_token_id_) {
-          beam_token_scores[j] = std::numeric_limits<T>::lowest();
-        }
+    // Suppress tokens
+    for (int j = 0; j < vocab_size; j++) {
+      // Suppress notimestamps and solm tokens
+      if (j == no_timestamps_token_id_ || j == start_of_lm_token_id_) {
+        beam_token_scores[j] = std::numeric_limits<T>::lowest();
+      }
 
-        // Suppress sot, translate and transcribe tokens
-        if (seq_length > sample_begin) {
-          if (j == start_of_transcript_token_id_ || j == translate_token_id_ || j == transcribe_token_id_) {
-            beam_token_scores[j] = std::numeric_limits<T>::lowest();
-          }
+      // Suppress sot, translate and transcribe tokens
+      if (seq_length > sample_begin) {
+        if (j == start_of_transcript_token_id_ || j == translate_token_id_ || j == transcribe_token_id_) {
+          beam_token_scores[j] = std::numeric_limits<T>::lowest();
         }
       }
+    }
 
-      // Timestamps should be in pair except the first one
-      const bool last_was_timestamp = seq_length > 0 && sequence.back() >= beginning_timestamp_token_id_;
-      const bool penultimate_was_timestamp = seq_length <= sample_begin || sequence[seq_length - 2] >= beginning_timestamp_token_id_;
-      if (last_was_timestamp) {
-        if (penultimate_was_timestamp) {
-          // If timestamps show up in pair, or it's the first timestamp, no more timestamp is generated
-          for (int j = beginning_timestamp_token_id_; j < vocab_size; j++) {
-            beam_token_scores[j] = std::numeric_limits<T>::lowest();
-          }
-        } else {
-          // If timestamp doesn't show up in pair, generate timestamp
-          for (int j = 0; j < end_of_text_token_id_; j++) {
-            beam_token_scores[j] = std::numeric_limits<T>::lowest();
-          }
+    // Timestamps should be in pair except the first one
+    const bool last_was_timestamp = seq_length > 0 && sequence.back() >= beginning_timestamp_token_id_;
+    const bool penultimate_was_timestamp = seq_length <= sample_begin || sequence[seq_length - 2] >= beginning_timestamp_token_id_;
+    if (last_was_timestamp) {
+      if (penultimate_was_timestamp) {
+        // If timestamps show up in pair, or it's the first timestamp, no more timestamp is generated
+        for (int j = beginning_timestamp_token_id_; j < vocab_size; j++) {
+          beam_token_scores[j] = std::numeric_limits<T>::lowest();
+        }
+      } else {
+        // If timestamp doesn't show up in pair, generate timestamp
+        for (int j = 0; j < end_of_text_token_id_; j++) {
+          beam_token_scores[j] = std::numeric_limits<T>::lowest();
         }
       }
+    }
 
-      // Find timestamp tokens
-      std::vector<int32_t> timestamps;
-      for (const auto& word_id : sequence) {
-        if (word_id >= beginning_timestamp_token_id_) {
-          timestamps.push_back(word_id);
-        }
+    // Find timestamp tokens
+    std::vector<int32_t> timestamps;
+    for (const auto& word_id : sequence) {
+      if (word_id >= beginning_timestamp_token_id_) {
+        timestamps.push_back(word_id);
       }
+    }
 
-      // Timestamps will not decrease
-      const size_t timestamps_len = timestamps.size();
-      if (timestamps_len > 0) {
-        int timestamp_last = 0;
-        if (last_was_timestamp && !penultimate_was_timestamp) {
-          // For single timestamp at the end, next timestamp must not be smaller
-          timestamp_last = timestamps.back();
-        } else {
-          // For paired timestamp at the end, next timestamp must be greater
-          timestamp_last = timestamps.back() + 1;
-        }
+    // Timestamps will not decrease
+    const size_t timestamps_len = timestamps.size();
+    if (timestamps_len > 0) {
+      int timestamp_last = 0;
+      if (last_was_timestamp && !penultimate_was_timestamp) {
+        // For single timestamp at the end, next timestamp must not be smaller
+        timestamp_last = timestamps.back();
+      } else {
+        // For paired timestamp at the end, next timestamp must be greater
+        timestamp_last = timestamps.back() + 1;
+      }
 
-        for (int j = beginning_timestamp_token_id_; j < timestamp_last; j++) {
-          beam_token_scores[j] = std::numeric_limits<T>::lowest();
-        }
+      for (int j = beginning_timestamp_token_id_; j < timestamp_last; j++) {
+        beam_token_scores[j] = std::numeric_limits<T>::lowest();
       }
+    }
 
-      if (seq_length == sample_begin) {
-        const int last_allowed = beginning_timestamp_token_id_ + max_initial_timestamp_index_;
-        for (int j = last_allowed + 1; j < vocab_size; j++) {
-          beam_token_scores[j] = std::numeric_limits<T>::lowest();
-        }
+    if (seq_length == sample_begin) {
+      const int last_allowed = beginning_timestamp_token_id_ + max_initial_timestamp_index_;
+      for (int j = last_allowed + 1; j < vocab_size; j++) {
+        beam_token_scores[j] = std::numeric_limits<T>::lowest();
       }
+    }
 
-      // Caculate logsumexp on timestamps
-      float timestamp_logprob = std::numeric_limits<T>::lowest();
-      {
-        float logsumexp = 0.0f;
-        const float logprob_max = *std::max_element(beam_token_scores.begin() + beginning_timestamp_token_id_, beam_token_scores.end());
-        for (int j = beginning_timestamp_token_id_; j < vocab_size; ++j) {
-          if (beam_token_scores[j] > std::numeric_limits<T>::lowest()) {
-            logsumexp += expf(beam_token_scores[j] - logprob_max);
-          }
-        }
-        if (logsumexp > 0.0f) {
-          timestamp_logprob = logf(logsumexp) + logprob_max;
+    // Caculate logsumexp on timestamps
+    float timestamp_logprob = std::numeric_limits<T>::lowest();
+    {
+      float logsumexp = 0.0f;
+      const float logprob_max = *std::max_element(beam_token_scores.begin() + beginning_timestamp_token_id_, beam_token_scores.end());
+      for (int j = beginning_timestamp_token_id_; j < vocab_size; ++j) {
+        if (beam_token_scores[j] > std::numeric_limits<T>::lowest()) {
+          logsumexp += expf(beam_token_scores[j] - logprob_max);
         }
       }
+      if (logsumexp > 0.0f) {
+        timestamp_logprob = logf(logsumexp) + logprob_max;
+      }
+    }
 
-      const float max_text_token_logprob = *std::max_element(beam_token_scores.begin(), beam_token_scores.begin() + beginning_timestamp_token_id_);
-      if (timestamp_logprob > max_text_token_logprob) {
-        for (int j = 0; j < beginning_timestamp_token_id_; ++j) {
-          beam_token_scores[j] = std::numeric_limits<T>::lowest();
-        }
+    const float max_text_token_logprob = *std::max_element(beam_token_scores.begin(), beam_token_scores.begin() + beginning_timestamp_token_id_);
+    if (timestamp_logprob > max_text_token_logprob) {
+      for (int j = 0; j < beginning_timestamp_token_id_; ++j) {
+        beam_token_scores[j] = std::numeric_limits<T>::lowest();
       }
     }
   }
@@ -299,7 +325,8 @@ class LogitsProcessorList : public ILogitsProcessorList {
   void Init(const BeamSearchParameters& parameters);
   void Init(const GreedySearchParameters& parameters);
   void Init(const SamplingParameters& parameters);
-  void Process(const ISequences* sequences, gsl::span<float>& next_token_scores, int step);
+  void Process(const ISequences* sequences, gsl::span<float>& next_token_scores, int step,
+               onnxruntime::concurrency::ThreadPool* thread_pool) override;
 
  private:
   template <typename GenerationParametersT>
@@ -326,7 +353,8 @@ class LogitsProcessorList : public ILogitsProcessorList {
     if (!parameters.prefix_vocab_mask.empty()) {
       prefix_vocab_mask_processor_ = std::make_unique<
           PrefixVocabMaskLogitsProcessor<float>>(parameters.prefix_vocab_mask,
-                                                 parameters.batch_size);
+                                                 parameters.batch_size,
+                                                 parameters.num_beams);
       processor_list_.push_back(prefix_vocab_mask_processor_.get());
     }
 
@@ -344,7 +372,8 @@ class LogitsProcessorList : public ILogitsProcessorList {
     if (!parameters.presence_mask.empty()) {
       presence_penalty_processor_ = std::make_unique<
           PresencePenaltyLogitsProcessor<float>>(parameters.presence_mask,
-                                                 parameters.presence_penalty);
+                                                 parameters.presence_penalty,
+                                                 parameters.num_beams);
       processor_list_.push_back(presence_penalty_processor_.get());
     }
 
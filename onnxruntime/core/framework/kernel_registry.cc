@@ -115,6 +115,29 @@ bool MatchKernelDefTypes(const std::unordered_map<std::string, std::vector<MLDat
 
   return match;
 }
+
+template <typename T>
+void AppendBytes(std::string& key, const T& value) {
+  key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Key of the lookup cache for a node: the kernel map key followed by what VerifyVersion and MatchKernelDefTypes read
+// from the node. The types are interned strings, so their addresses identify them.
+std::string GetLookupCacheKey(const std::string& map_key, const Node& node) {
+  std::string key = map_key;
+  AppendBytes(key, node.SinceVersion());
+  AppendBytes(key, node.InputArgCount().size());
+  for (int count : node.InputArgCount()) {
+    AppendBytes(key, count);
+  }
+  for (const auto defs : {node.InputDefs(), node.OutputDefs()}) {
+    AppendBytes(key, defs.size());
+    for (const NodeArg* def : defs) {
+      AppendBytes(key, def->Exists() ? def->Type() : nullptr);
+    }
+  }
+  return key;
+}
 }  // namespace
 
 static bool VerifyVersion(int since_ver, const KernelDef& kernel_def, std::string& error_str) {
@@ -188,9 +211,24 @@ Status KernelRegistry::TryFindKernelImpl(const Node& node,
   const auto& node_provider = node.GetExecutionProviderType();
   const auto& expected_provider = (node_provider.empty() ? exec_provider : node_provider);
 
-  auto range = kernel_creator_fn_map_.equal_range(GetMapKey(node.OpType(), node.Domain(), expected_provider));
+  const std::string map_key = GetMapKey(node.OpType(), node.Domain(), expected_provider);
   if (out) *out = nullptr;
 
+  // the explicit type_constraints are not part of the node, so only the lookups using the node's types are cached
+  std::string cache_key;
+  if (kernel_type_str_resolver != nullptr) {
+    cache_key = GetLookupCacheKey(map_key, node);
+    std::lock_guard<std::mutex> lock(lookup_cache_mutex_);
+    if (auto it = lookup_cache_.find(cache_key); it != lookup_cache_.end()) {
+      if (out) {
+        *out = it->second;
+      }
+      return Status::OK();
+    }
+  }
+
+  auto range = kernel_creator_fn_map_.equal_range(map_key);
+
   std::vector<std::string> verify_kernel_def_error_strs;
 
   for (auto i = range.first; i != range.second; ++i) {
@@ -199,6 +237,10 @@ Status KernelRegistry::TryFindKernelImpl(const Node& node,
       if (out) {
         *out = &i->second;
       }
+      if (!cache_key.empty()) {
+        std::lock_guard<std::mutex> lock(lookup_cache_mutex_);
+        lookup_cache_.emplace(std::move(cache_key), &i->second);
+      }
       return Status::OK();
     }
 
@@ -327,6 +369,10 @@ Status KernelRegistry::Register(KernelCreateInfo&& create_info) {
   // Register the kernel.
   // Ownership of the KernelDef is transferred to kernel_creator_fn_map_.
   kernel_creator_fn_map_.emplace(key, std::move(create_info));
+
+  // the new kernel may match nodes that were matched to another one before
+  std::lock_guard<std::mutex> lock(lookup_cache_mutex_);
+  lookup_cache_.clear();
   return Status::OK();
 }
 
@@ -55,6 +55,11 @@ class OpKernelContextInternal : public OpKernelContext {
     return session_state_.GetSubgraphSessionState(GetNodeIndex(), attribute_name);
   }
 
+  // Finalizes the SessionState of a subgraph whose initialization was deferred to its first execution, if needed.
+  Status FinalizeDeferredSubgraphSessionState(const std::string& attribute_name) {
+    return session_state_.FinalizeDeferredSubgraphSessionState(GetNodeIndex(), attribute_name);
+  }
+
   const OrtValue* GetInputMLValue(int index) const override {
     return OpKernelContext::GetInputMLValue(index);
   }
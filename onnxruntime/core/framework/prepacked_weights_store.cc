@@ -0,0 +1,157 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/framework/prepacked_weights_store.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <system_error>
+
+#include "core/common/inlined_containers.h"
+#include "core/platform/env.h"
+
+namespace onnxruntime {
+
+namespace {
+
+// An entry starts with a header of uint64_t values: the magic number, the number of buffers, then the size of
+// every buffer and whether it is present (PrePack() may leave null placeholders). The buffers follow, each one
+// aligned like the buffers of the CPU allocator.
+constexpr uint64_t kMagic = 0x3157505045525054;  // "TPREPPW1"
+constexpr size_t kBufferAlignment = 64;
+
+size_t AlignUp(size_t offset) {
+  return (offset + kBufferAlignment - 1) / kBufferAlignment * kBufferAlignment;
+}
+
+// Offsets of the buffers of packed_weights in an entry, and the size of the entry.
+InlinedVector<size_t> GetBufferOffsets(const PrePackedWeights& packed_weights, size_t& entry_size) {
+  const size_t num_buffers = packed_weights.buffers_.size();
+  entry_size = sizeof(uint64_t) * (2 + 2 * num_buffers);
+  InlinedVector<size_t> offsets;
+  offsets.reserve(num_buffers);
+  for (size_t i = 0; i < num_buffers; ++i) {
+    const size_t offset = AlignUp(entry_size);
+    offsets.push_back(offset);
+    entry_size = offset + packed_weights.buffer_sizes_[i];
+  }
+  return offsets;
+}
+
+InlinedVector<uint64_t> GetHeader(const PrePackedWeights& packed_weights) {
+  InlinedVector<uint64_t> header{kMagic, packed_weights.buffers_.size()};
+  for (size_t i = 0; i < packed_weights.buffers_.size(); ++i) {
+    header.push_back(packed_weights.buffer_sizes_[i]);
+    header.push_back(packed_weights.buffers_[i] != nullptr ? 1 : 0);
+  }
+  return header;
+}
+
+Status WriteEntry(const std::filesystem::path& path, const PrePackedWeights& packed_weights,
+                  gsl::span<const size_t> offsets) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  ORT_RETURN_IF_NOT(out.good(), "Failed to create the pre-packed weights file ", path.string());
+
+  const auto header = GetHeader(packed_weights);
+  out.write(reinterpret_cast<const char*>(header.data()),
+            static_cast<std::streamsize>(header.size() * sizeof(uint64_t)));
+  size_t position = header.size() * sizeof(uint64_t);
+  const char padding[kBufferAlignment] = {};
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    out.write(padding, static_cast<std::streamsize>(offsets[i] - position));
+    if (packed_weights.buffers_[i] != nullptr) {
+      out.write(static_cast<const char*>(packed_weights.buffers_[i].get()),
+                static_cast<std::streamsize>(packed_weights.buffer_sizes_[i]));
+    } else {
+      const size_t size = packed_weights.buffer_sizes_[i];
+      for (size_t j = 0; j < size; j += kBufferAlignment) {
+        out.write(padding, static_cast<std::streamsize>(std::min(kBufferAlignment, size - j)));
+      }
+    }
+    position = offsets[i] + packed_weights.buffer_sizes_[i];
+  }
+
+  out.close();
+  ORT_RETURN_IF(out.fail(), "Failed to write the pre-packed weights file ", path.string());
+  return Status::OK();
+}
+
+// Writes the entry under a name unique to this process and call, then renames it.
+Status PublishEntry(const std::filesystem::path& path, const PrePackedWeights& packed_weights,
+                    gsl::span<const size_t> offsets) {
+  static std::atomic<uint64_t> publish_count{0};
+  std::filesystem::path temp_path = path;
+  temp_path += "." + std::to_string(Env::Default().GetSelfPid()) + "." + std::to_string(publish_count++) + ".tmp";
+
+  Status status = WriteEntry(temp_path, packed_weights, offsets);
+  std::error_code error;
+  if (status.IsOK()) {
+    // replaces an entry another process published since the existence check, which has the same content
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Failed to publish the pre-packed weights file ", path.string(),
+                               ": ", error.message());
+    }
+  }
+  if (!status.IsOK()) {
+    std::filesystem::remove(temp_path, error);
+  }
+  return status;
+}
+
+}  // namespace
+
+Status PrepackedWeightsStore::MapOrPublish(const std::string& key, PrePackedWeights& packed_weights) const {
+  ORT_RETURN_IF_NOT(packed_weights.buffers_.size() == packed_weights.buffer_sizes_.size(),
+                    "The pre-packed weights ", key, " have ", packed_weights.buffers_.size(), " buffers but ",
+                    packed_weights.buffer_sizes_.size(), " buffer sizes");
+
+  size_t entry_size = 0;
+  const auto offsets = GetBufferOffsets(packed_weights, entry_size);
+  const std::filesystem::path path = directory_ / key;
+
+  std::error_code error;
+  if (!std::filesystem::exists(path, error)) {
+    std::filesystem::create_directories(directory_, error);
+    ORT_RETURN_IF(error, "Failed to create the pre-packed weights directory ", directory_.string(), ": ",
+                  error.message());
+    ORT_RETURN_IF_ERROR(PublishEntry(path, packed_weights, offsets));
+  }
+
+  const Env& env = Env::Default();
+  size_t file_size = 0;
+  ORT_RETURN_IF_ERROR(env.GetFileLength(path.c_str(), file_size));
+  ORT_RETURN_IF_NOT(file_size == entry_size, "The pre-packed weights file ", path.string(), " has ", file_size,
+                    " bytes, expected ", entry_size);
+
+  Env::MappedMemoryPtr mapped_memory;
+  ORT_RETURN_IF_ERROR(env.MapFileIntoMemory(path.c_str(), 0, entry_size, mapped_memory));
+
+  // The key only holds 61 bits of the hash of the buffers, so compare them before handing the entry to a kernel.
+  // This also catches a truncated or corrupted file. The pages read here are the ones the kernel will use.
+  const auto header = GetHeader(packed_weights);
+  bool matches = std::memcmp(mapped_memory.get(), header.data(), header.size() * sizeof(uint64_t)) == 0;
+  for (size_t i = 0; matches && i < offsets.size(); ++i) {
+    if (packed_weights.buffers_[i] != nullptr) {
+      matches = std::memcmp(mapped_memory.get() + offsets[i], packed_weights.buffers_[i].get(),
+                            packed_weights.buffer_sizes_[i]) == 0;
+    }
+  }
+  ORT_RETURN_IF_NOT(matches, "The pre-packed weights file ", path.string(), " does not match the weights packed by ",
+                    "this process");
+
+  // every buffer holds a reference to the mapping, which is released with the last of them
+  auto unmap = mapped_memory.get_deleter();
+  std::shared_ptr<char> mapping(mapped_memory.release(), unmap);
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    if (packed_weights.buffers_[i] != nullptr) {
+      packed_weights.buffers_[i] = IAllocatorUniquePtr<void>(mapping.get() + offsets[i], [mapping](void*) {});
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "core/common/common.h"
+#include "core/framework/prepacked_weights.h"
+
+namespace onnxruntime {
+
+/// <summary>
+/// A directory of pre-packed weights shared by the processes running the same models on a host.
+///
+/// Every entry is a file named after the key of the weights in PrepackedWeightsContainer
+/// (op_type + "+" + hash of the pre-packed buffers). The first process pre-packing a weight publishes it,
+/// then every process maps the file into memory instead of keeping its own copy of the packed buffers, which are
+/// shared through the page cache. Like every shared pre-packed buffer, the mapped buffers are read-only: the file
+/// is mapped read-only on Windows, and a kernel writing to them elsewhere would only change its private copy.
+///
+/// Entries are published with an atomic rename, so a process never maps a partially written entry. Processes
+/// racing to publish the same key write the same bytes.
+/// </summary>
+class PrepackedWeightsStore final {
+ public:
+  explicit PrepackedWeightsStore(std::filesystem::path directory) : directory_(std::move(directory)) {}
+
+  ORT_DISALLOW_COPY_ASSIGNMENT_AND_MOVE(PrepackedWeightsStore);
+
+  // Replaces the buffers of packed_weights with the buffers of the entry stored for key, mapped into memory.
+  // The entry is published from packed_weights first if it does not exist. An existing entry is only used if its
+  // buffers are identical to the buffers of packed_weights, otherwise an error is returned and packed_weights is
+  // left unchanged. The mapping stays alive as long as one of the returned buffers does.
+  Status MapOrPublish(const std::string& key, PrePackedWeights& packed_weights) const;
+
+ private:
+  std::filesystem::path directory_;
+};
+
+}  // namespace onnxruntime
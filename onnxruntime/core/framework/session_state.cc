@@ -8,6 +8,7 @@
 #include <mutex>
 #include "core/common/logging/logging.h"
 #include "core/common/safeint.h"
+#include "core/common/string_utils.h"
 #include "core/flatbuffers/schema/ort.fbs.h"
 #include "core/framework/allocator.h"
 #include "core/framework/node_index_info.h"
@@ -90,6 +91,11 @@ SessionState::SessionState(Graph& graph,
 {
   enable_mem_pattern_ = sess_options_.enable_mem_pattern &&
                         sess_options_.execution_mode == ExecutionMode::ORT_SEQUENTIAL;
+  const std::string prepacked_weights_store_dir =
+      sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsPrepackedWeightsStoreDirectory, "");
+  if (!prepacked_weights_store_dir.empty()) {
+    prepacked_weights_store_ = std::make_unique<PrepackedWeightsStore>(ToPathString(prepacked_weights_store_dir));
+  }
   if (parent_allocators) {
     allocators_ = parent_allocators;
   } else {
@@ -218,6 +224,27 @@ const KernelCreateInfo& SessionState::GetNodeKernelCreateInfo(NodeIndex node_ind
   return *entry->second;
 }
 
+bool SessionState::UseParallelKernelInitialization() const {
+  return concurrency::ThreadPool::DegreeOfParallelism(thread_pool_) > 1 &&
+         sess_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsParallelKernelInitialization, "0") == "1";
+}
+
+// Runs a kernel constructor or PrePack() on a thread pool worker. Exceptions cannot cross the thread pool,
+// so they are returned as a failed status.
+template <typename TFunc>
+static Status RunKernelInitializationTask(TFunc&& func) {
+  Status status;
+  ORT_TRY {
+    status = func();
+  }
+  ORT_CATCH(const std::exception& ex) {
+    ORT_HANDLE_EXCEPTION([&]() {
+      status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, ex.what());
+    });
+  }
+  return status;
+}
+
 Status SessionState::CreateKernels(const KernelRegistryManager& kernel_registry_manager) {
   const auto& nodes = graph_viewer_->Nodes();
   if (!nodes.empty()) {
@@ -227,7 +254,8 @@ Status SessionState::CreateKernels(const KernelRegistryManager& kernel_registry_
     }
     session_kernels_.clear();
     session_kernels_.resize(max_nodeid + 1);
-    for (const auto& node : nodes) {
+
+    auto create_kernel = [this, &kernel_registry_manager](const Node& node) -> Status {
       // construct and save the kernels
       const KernelCreateInfo& kci = GetNodeKernelCreateInfo(node.Index());
 
@@ -236,7 +264,34 @@ Status SessionState::CreateKernels(const KernelRegistryManager& kernel_registry_
       const IExecutionProvider& exec_provider = *execution_providers_.Get(exec_provider_name);
 
       // assumes vector is already resize()'ed to the number of nodes in the graph
-      ORT_RETURN_IF_ERROR(kernel_registry_manager.CreateKernel(node, exec_provider, *this, kci, session_kernels_[node.Index()]));
+      return kernel_registry_manager.CreateKernel(node, exec_provider, *this, kci, session_kernels_[node.Index()]);
+    };
+
+    // Kernels of the CPU EP only read the node and the session state when they are constructed, so they can be
+    // created concurrently. Other EPs may set up device state or use the FuncManager, so their kernels are created
+    // on this thread.
+    const bool parallel = UseParallelKernelInitialization();
+    InlinedVector<const Node*> cpu_nodes;
+    for (const auto& node : nodes) {
+      if (parallel && node.GetExecutionProviderType() == kCpuExecutionProvider) {
+        cpu_nodes.push_back(&node);
+      } else {
+        ORT_RETURN_IF_ERROR(create_kernel(node));
+      }
+    }
+
+    if (!cpu_nodes.empty()) {
+      std::vector<Status> statuses(cpu_nodes.size());
+      concurrency::ThreadPool::TrySimpleParallelFor(
+          thread_pool_, static_cast<std::ptrdiff_t>(cpu_nodes.size()),
+          [&create_kernel, &cpu_nodes, &statuses](std::ptrdiff_t i) {
+            const auto index = static_cast<size_t>(i);
+            statuses[index] = RunKernelInitializationTask([&]() { return create_kernel(*cpu_nodes[index]); });
+          });
+      // report the error of the first node, as when kernels are created one at a time
+      for (const auto& status : statuses) {
+        ORT_RETURN_IF_ERROR(status);
+      }
     }
   }
   node_index_info_.emplace(*graph_viewer_, ort_value_name_idx_map_);
@@ -403,201 +458,314 @@ static std::string GenerateKeyForPrepackedWeightsMap(const std::string& op_type,
   return ss_1.str();
 }
 
+bool SessionState::GetPrePackTask(const Node& node, int input_idx,
+                                  bool should_cache_prepacked_weights_for_shared_initializers,
+                                  const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map,
+                                  PrePackTask& task) {
+  const NodeArg* input_def = node.InputDefs()[input_idx];
+  if (!input_def->Exists()) {
+    return false;
+  }
+
+  const std::string& input_name = input_def->Name();
+  SessionState* st = this;
+  auto* prepacked_for_graph = &graph_.GetPrepacked();
+  // subgraph can use the value from outer scope,
+  // so it needs to check if current node uses constant initialized tensor from current and outer graphs
+  do {
+    int ort_value_idx;
+    if (st->GetOrtValueNameIdxMap().GetIdx(input_name, ort_value_idx).IsOK()) {
+      auto entry = st->constant_initialized_tensors_.find(ort_value_idx);
+      if (entry != st->constant_initialized_tensors_.end()) {
+        task.node = &node;
+        task.kernel = GetMutableKernel(node.Index());
+        task.input_idx = input_idx;
+        task.owner = st;
+        task.prepacked_for_graph = prepacked_for_graph;
+        task.ort_value_idx = ort_value_idx;
+        task.tensor = &entry->second.Get<Tensor>();
+        task.is_packed = false;
+        task.weights = PrePackedWeights{};
+
+        // Caching pre-packed weights is limited to shared initializers associated with the CPU EP for now
+        task.cache_in_container = should_cache_prepacked_weights_for_shared_initializers &&
+                                  initializers_to_share_map.find(input_name) != initializers_to_share_map.end() &&
+                                  node.GetExecutionProviderType() == kCpuExecutionProvider;
+        if (task.cache_in_container) {
+          task.allocator = prepacked_weights_container_->GetOrCreateAllocator(CPU);
+          ORT_ENFORCE(task.allocator.get() != nullptr);
+        } else {
+          task.allocator = GetAllocator(task.kernel->Info().GetDevice(OrtMemType::OrtMemTypeDefault));
+        }
+        return true;
+      }
+      // stop searching in 2 cases:
+      // 1. value is not from OuterScope
+      // 2. value is from OuterScope and the current OuterScope has the value
+      if (st != this || !st->graph_.IsOuterScopeValue(input_name)) {
+        break;
+      }
+    }
+    st = st->Parent();
+    if (st != nullptr) {
+      prepacked_for_graph = &st->graph_.GetPrepacked();
+    }
+  } while (st);
+
+  return false;
+}
+
+void SessionState::MapFromPrepackedWeightsStore(const Node& node, const std::string& key,
+                                                PrePackedWeights& packed_weights) const {
+  // only the buffers of CPU kernels are in host memory
+  if (prepacked_weights_store_ == nullptr || node.GetExecutionProviderType() != kCpuExecutionProvider) {
+    return;
+  }
+
+  auto status = prepacked_weights_store_->MapOrPublish(key, packed_weights);
+  if (!status.IsOK()) {
+    LOGS(logger_, WARNING) << "The pre-packed weights of the node " << node.Name()
+                           << " are not shared with other processes: " << status.ErrorMessage();
+  }
+}
+
+Status SessionState::SharePrePackedWeights(PrePackTask& task,
+                                           InlinedHashMap<std::string, size_t>& constant_initializers_use_count) {
+  const Node& node = *task.node;
+  OpKernel* kernel = task.kernel;
+  const int input_idx = task.input_idx;
+  const std::string& input_name = node.InputDefs()[input_idx]->Name();
+  auto* prepacked_for_graph = task.prepacked_for_graph;
+  PrePackedWeights& weights_to_be_filled_in = task.weights;
+
+  // The reason we invoke PrePack() before looking into the container for any pre-packed weight
+  // cached by another instance of the same op_type (for the same constant initializer) is because
+  // to truly know if we can use a cached pre-packed weight, we would have to compare the cached
+  // pre-packed weight with the pre-packed weight generated by this instance of the same op_type because
+  // other static properties of the node like node attributes could play a role in the pre-packed
+  // weights' contents.
+  if (task.cache_in_container) {
+    // caching of pre-packed weights' turned ON
+    if (task.is_packed) {
+      // BUG CHECK: Ensure that the kernel has filled in the pre-packed weight
+      // to be cached if the weight was pre-packed
+      ORT_ENFORCE(weights_to_be_filled_in.buffers_.size() > 0,
+                  "The kernel corresponding to the node ", node.Name(),
+                  " doesn't have an implementation that can cache computed pre-packed weights");
+
+      const auto& op_type = node.OpType();
+
+      // Sanity check
+      // TODO: Check if some version of the ONNX IR allows op_type to be empty
+      ORT_ENFORCE(!op_type.empty(), "The op type of a node cannot be empty");
+
+      // The key for the pre-packed weights container lookup is the op_type + hash of the prepacked-weight
+      // that we just got by invoking PrePack() on this kernel.
+
+      const std::string prepacked_weights_container_key =
+          GenerateKeyForPrepackedWeightsMap(op_type,
+                                            weights_to_be_filled_in);
+
+      bool container_contains_packed_weight = prepacked_weights_container_->HasWeight(
+          prepacked_weights_container_key);
+
+      if (container_contains_packed_weight) {
+        LOGS(logger_, INFO) << "Using cached version of pre-packed weight for constant initializer: "
+                            << input_name
+                            << " used in the node: " << node.Name() << " which is of op type: "
+                            << node.OpType();
+
+        const auto& prepacked_shared = prepacked_weights_container_->GetWeight(
+            prepacked_weights_container_key);
+        ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(*kernel, input_idx,
+                                                            prepacked_shared,
+                                                            node.Name()));
+
+        ++used_shared_pre_packed_weights_counter_;
+
+        // Write references to what is stored in the shared container
+        // and release memory mapped entries this container may have loaded from disk
+        std::ignore = prepacked_for_graph->ReplaceWithReferenceIfSaving(input_name,
+                                                                        prepacked_weights_container_key,
+                                                                        prepacked_shared);
+
+      } else {
+        // container doesn't contain the pre-packed weight - so write into it for sharing across
+        // kernel instances
+
+        // Check if we loaded it from disk, then put it into the shared container so
+        // everybody can share the same memory mapped entry
+        // the shared container takes ownership of the memory mapped entries
+
+        // The next line replaces the existing entry with references to it
+        // and returns the container that holds the memory mapped entries
+        // so we can transfer it to shared container.
+        // if there is not an entry, we replace it with references to weights_to_be_filled_in
+        // in saving mode and return std::nullopt
+        if (prepacked_for_graph->GetPrepackedWeights(prepacked_weights_container_key) == nullptr) {
+          MapFromPrepackedWeightsStore(node, prepacked_weights_container_key, weights_to_be_filled_in);
+        }
+        auto prepacked_from_disk = prepacked_for_graph->ReplaceWithReferenceIfSaving(
+            input_name,
+            prepacked_weights_container_key,
+            weights_to_be_filled_in);
+
+        if (prepacked_from_disk.has_value()) {
+          weights_to_be_filled_in = std::move(*prepacked_from_disk);
+        }
+
+        if (!prepacked_weights_container_->WriteWeight(prepacked_weights_container_key,
+                                                       std::move(weights_to_be_filled_in))) {
+          return ORT_MAKE_STATUS(
+              ONNXRUNTIME, FAIL,
+              "Unable to write the provided PrePackedWeights instance into the container");
+        }
+
+        const auto& shared_prepacked = prepacked_weights_container_->GetWeight(
+            prepacked_weights_container_key);
+        ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(*kernel, input_idx,
+                                                            shared_prepacked,
+                                                            node.Name()));
+      }
+    }
+
+  } else {
+    // cross session caching of pre-packed weights' turned OFF
+    // we use serialization container to share weights loaded from disk
+    // within this session. Or if the weight is not present on disk,
+    // we store the newly minted pre-packed data.
+
+    // Some kernels (matmul_nbits and non-CPU related kernels) do not share their pre-packed results
+    // even though they set is_packed = true so we leave it up to them.
+    // We can change their behavior if we wish do so in a separate PR
+    // XXX: Interestingly enough, matmul_nbits does accept shared pre-packs, but does not
+    // produce them.
+    if (task.is_packed && !weights_to_be_filled_in.buffers_.empty()) {
+      const auto& op_type = node.OpType();
+      const std::string prepacked_weights_container_key = GenerateKeyForPrepackedWeightsMap(
+          op_type,
+          weights_to_be_filled_in);
+
+      // See if we can use pre-packed data from disk
+      const auto* weights_to_use = prepacked_for_graph->GetPrepackedWeights(
+          prepacked_weights_container_key);
+
+      if (weights_to_use == nullptr) {
+        MapFromPrepackedWeightsStore(node, prepacked_weights_container_key, weights_to_be_filled_in);
+        // In this case pre-packed container owns the data
+        prepacked_for_graph->WritePackedMaybeForSave(input_name, prepacked_weights_container_key,
+                                                     std::move(weights_to_be_filled_in));
+        weights_to_use = prepacked_for_graph->GetPrepackedWeights(prepacked_weights_container_key);
+        assert(weights_to_use != nullptr);
+      }
+
+      ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(*kernel, input_idx,
+                                                          *weights_to_use,
+                                                          node.Name()));
+    }
+  }
+
+  if (task.is_packed) {
+    ++number_of_prepacks_counter_;
+
+    if (constant_initializers_use_count.count(input_name) && --constant_initializers_use_count[input_name] == 0) {
+      // release the constant initialized tensor
+      task.owner->initialized_tensors_.erase(task.ort_value_idx);
+      task.owner->constant_initialized_tensors_.erase(task.ort_value_idx);
+      task.tensor = nullptr;
+    }
+  }
+
+  return Status::OK();
+}
+
+Status SessionState::PrepackConstantInitializedTensorsInParallel(
+    InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
+    const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map,
+    bool should_cache_prepacked_weights_for_shared_initializers) {
+  InlinedVector<const Node*> nodes;
+  for (const auto& node : GetGraphViewer().Nodes()) {
+    nodes.push_back(&node);
+  }
+
+  // A kernel pre-packs its inputs in order and may use what it packed for a previous input, so each kernel
+  // pre-packs one input per wave.
+  // Wave w calls PrePack() for the w-th constant input of every kernel in parallel, then shares the results
+  // in node order on this thread so that the containers are filled in the same order on every run.
+  // A tensor is only released once all its consumers pre-packed it, so looking up the inputs wave by wave
+  // finds the same tensors as a sequential pass.
+  InlinedVector<int> next_input_idx(nodes.size(), 0);
+  std::vector<PrePackTask> tasks;
+  InlinedVector<size_t> cpu_tasks;
+  std::vector<Status> statuses;
+  for (;;) {
+    tasks.clear();
+    cpu_tasks.clear();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      const Node& node = *nodes[i];
+      const int num_inputs = static_cast<int>(node.InputDefs().size());
+      PrePackTask task;
+      while (next_input_idx[i] < num_inputs) {
+        if (GetPrePackTask(node, next_input_idx[i]++, should_cache_prepacked_weights_for_shared_initializers,
+                           initializers_to_share_map, task)) {
+          if (node.GetExecutionProviderType() == kCpuExecutionProvider) {
+            cpu_tasks.push_back(tasks.size());
+          }
+          tasks.push_back(std::move(task));
+          break;
+        }
+      }
+    }
+    if (tasks.empty()) {
+      break;
+    }
+
+    statuses.assign(tasks.size(), Status::OK());
+    concurrency::ThreadPool::TrySimpleParallelFor(
+        thread_pool_, static_cast<std::ptrdiff_t>(cpu_tasks.size()),
+        [&tasks, &cpu_tasks, &statuses](std::ptrdiff_t i) {
+          const size_t index = cpu_tasks[static_cast<size_t>(i)];
+          auto& task = tasks[index];
+          statuses[index] = RunKernelInitializationTask([&task]() {
+            return task.kernel->PrePack(*task.tensor, task.input_idx, task.allocator, task.is_packed, &task.weights);
+          });
+        });
+
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      auto& task = tasks[i];
+      if (task.node->GetExecutionProviderType() != kCpuExecutionProvider) {
+        ORT_RETURN_IF_ERROR(task.kernel->PrePack(*task.tensor, task.input_idx, task.allocator, task.is_packed,
+                                                 &task.weights));
+      } else {
+        ORT_RETURN_IF_ERROR(statuses[i]);
+      }
+      ORT_RETURN_IF_ERROR(SharePrePackedWeights(task, constant_initializers_use_count));
+    }
+  }
+
+  return Status::OK();
+}
+
 Status SessionState::PrepackConstantInitializedTensors(
     InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
     const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map) {
   auto prepacked_constant_weights = [this, &constant_initializers_use_count, &initializers_to_share_map](
                                         bool should_cache_prepacked_weights_for_shared_initializers) -> Status {
+    if (UseParallelKernelInitialization()) {
+      return PrepackConstantInitializedTensorsInParallel(constant_initializers_use_count, initializers_to_share_map,
+                                                         should_cache_prepacked_weights_for_shared_initializers);
+    }
+
     for (auto& node : GetGraphViewer().Nodes()) {
-      auto kernel = GetMutableKernel(node.Index());
-      int input_idx = 0;
-      for (auto& input_def : node.InputDefs()) {
-        if (input_def->Exists()) {
-          const std::string& input_name = input_def->Name();
-          SessionState* st = this;
-          auto* prepacked_for_graph = &graph_.GetPrepacked();
-          // subgraph can use the value from outer scope,
-          // so it needs to check if current node uses constant initialized tensor from current and outer graphs
-          do {
-            int ort_value_idx;
-            if (st->GetOrtValueNameIdxMap().GetIdx(input_name, ort_value_idx).IsOK()) {
-              std::unordered_map<int, OrtValue>& constant_initialized_tensors = st->constant_initialized_tensors_;
-
-              if (constant_initialized_tensors.count(ort_value_idx)) {
-                bool is_packed = false;
-                const Tensor& const_initialized_tensor = constant_initialized_tensors[ort_value_idx].Get<Tensor>();
-
-                auto iter = initializers_to_share_map.find(input_name);
-                bool is_shared_initializer = (iter != initializers_to_share_map.end());
-
-                // Caching pre-packed weights is limited to shared initializers associated with the CPU EP for now
-                if (is_shared_initializer && should_cache_prepacked_weights_for_shared_initializers &&
-                    node.GetExecutionProviderType() == kCpuExecutionProvider) {
-                  // caching of pre-packed weights' turned ON
-
-                  AllocatorPtr allocator_for_caching = prepacked_weights_container_->GetOrCreateAllocator(CPU);
-                  ORT_ENFORCE(allocator_for_caching.get() != nullptr);
-
-                  PrePackedWeights weights_to_be_filled_in;
-                  // The reason we invoke PrePack() before looking into the container for any pre-packed weight
-                  // cached by another instance of the same op_type (for the same constant initializer) is because
-                  // to truly know if we can use a cached pre-packed weight, we would have to compare the cached
-                  // pre-packed  weight with the pre-packed weight generated by this instance of the same op_type
-                  // because other static properties of the node like node attributes could play a role in the
-                  // pre-packed weights' contents.
-                  ORT_RETURN_IF_ERROR(kernel->PrePack(const_initialized_tensor, input_idx, allocator_for_caching,
-                                                      is_packed,
-                                                      &weights_to_be_filled_in));
-
-                  if (is_packed) {
-                    // BUG CHECK: Ensure that the kernel has filled in the pre-packed weight
-                    // to be cached if the weight was pre-packed
-                    ORT_ENFORCE(weights_to_be_filled_in.buffers_.size() > 0,
-                                "The kernel corresponding to the node ", node.Name(),
-                                " doesn't have an implementation that can cache computed pre-packed weights");
-
-                    const auto& op_type = node.OpType();
-
-                    // Sanity check
-                    // TODO: Check if some version of the ONNX IR allows op_type to be empty
-                    ORT_ENFORCE(!op_type.empty(), "The op type of a node cannot be empty");
-
-                    // The key for the pre-packed weights container lookup is the op_type + hash of the prepacked-weight
-                    // that we just got by invoking PrePack() on this kernel.
-
-                    const std::string prepacked_weights_container_key =
-                        GenerateKeyForPrepackedWeightsMap(op_type,
-                                                          weights_to_be_filled_in);
-
-                    bool container_contains_packed_weight = prepacked_weights_container_->HasWeight(
-                        prepacked_weights_container_key);
-
-                    if (container_contains_packed_weight) {
-                      LOGS(logger_, INFO) << "Using cached version of pre-packed weight for constant initializer: "
-                                          << input_name
-                                          << " used in the node: " << node.Name() << " which is of op type: "
-                                          << node.OpType();
-
-                      const auto& prepacked_shared = prepacked_weights_container_->GetWeight(
-                          prepacked_weights_container_key);
-                      ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(*kernel, input_idx,
-                                                                          prepacked_shared,
-                                                                          node.Name()));
-
-                      ++used_shared_pre_packed_weights_counter_;
-
-                      // Write references to what is stored in the shared container
-                      // and release memory mapped entries this container may have loaded from disk
-                      std::ignore = prepacked_for_graph->ReplaceWithReferenceIfSaving(input_name,
-                                                                                      prepacked_weights_container_key,
-                                                                                      prepacked_shared);
-
-                    } else {
-                      // container doesn't contain the pre-packed weight - so write into it for sharing across
-                      // kernel instances
-
-                      // Check if we loaded it from disk, then put it into the shared container so
-                      // everybody can share the same memory mapped entry
-                      // the shared container takes ownership of the memory mapped entries
-
-                      // The next line replaces the existing entry with references to it
-                      // and returns the container that holds the memory mapped entries
-                      // so we can transfer it to shared container.
-                      // if there is not an entry, we replace it with references to weights_to_be_filled_in
-                      // in saving mode and return std::nullopt
-                      auto prepacked_from_disk = prepacked_for_graph->ReplaceWithReferenceIfSaving(
-                          input_name,
-                          prepacked_weights_container_key,
-                          weights_to_be_filled_in);
-
-                      if (prepacked_from_disk.has_value()) {
-                        weights_to_be_filled_in = std::move(*prepacked_from_disk);
-                      }
-
-                      if (!prepacked_weights_container_->WriteWeight(prepacked_weights_container_key,
-                                                                     std::move(weights_to_be_filled_in))) {
-                        return ORT_MAKE_STATUS(
-                            ONNXRUNTIME, FAIL,
-                            "Unable to write the provided PrePackedWeights instance into the container");
-                      }
-
-                      const auto& shared_prepacked = prepacked_weights_container_->GetWeight(
-                          prepacked_weights_container_key);
-                      ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(*kernel, input_idx,
-                                                                          shared_prepacked,
-                                                                          node.Name()));
-                    }
-                  }
-
-                } else {
-                  // cross session caching of pre-packed weights' turned OFF
-                  // we use serialization container to share weights loaded from disk
-                  // within this session. Or if the weight is not present on disk,
-                  // we store the newly minted pre-packed data.
-
-                  AllocatorPtr session_cpu_alloc = GetAllocator(kernel->Info().GetDevice(OrtMemType::OrtMemTypeDefault));
-                  PrePackedWeights weights_to_be_filled_in;
-                  // The reason we invoke PrePack() before looking into the container for any pre-packed weight
-                  // cached by another instance of the same op_type (for the same constant initializer) is because
-                  // to truly know if we can use a cached pre-packed weight, we would have to compare the cached
-                  // pre-packed weight with the pre-packed weight generated by this instance of the same op_type because
-                  // other static properties of the node like node attributes could play a role in the pre-packed
-                  // weights' contents.
-                  ORT_RETURN_IF_ERROR(kernel->PrePack(const_initialized_tensor, input_idx, session_cpu_alloc,
-                                                      is_packed,
-                                                      &weights_to_be_filled_in));
-
-                  // Some kernels (matmul_nbits and non-CPU related kernels) do not share their pre-packed results
-                  // even though they set is_packed = true so we leave it up to them.
-                  // We can change their behavior if we wish do so in a separate PR
-                  // XXX: Interestingly enough, matmul_nbits does accept shared pre-packs, but does not
-                  // produce them.
-                  if (is_packed && !weights_to_be_filled_in.buffers_.empty()) {
-                    const auto& op_type = node.OpType();
-                    const std::string prepacked_weights_container_key = GenerateKeyForPrepackedWeightsMap(
-                        op_type,
-                        weights_to_be_filled_in);
-
-                    // See if we can use pre-packed data from disk
-                    const auto* weights_to_use = prepacked_for_graph->GetPrepackedWeights(
-                        prepacked_weights_container_key);
-
-                    if (weights_to_use == nullptr) {
-                      // In this case pre-packed container owns the data
-                      prepacked_for_graph->WritePackedMaybeForSave(input_name, prepacked_weights_container_key,
-                                                                   std::move(weights_to_be_filled_in));
-                      weights_to_use = prepacked_for_graph->GetPrepackedWeights(prepacked_weights_container_key);
-                      assert(weights_to_use != nullptr);
-                    }
-
-                    ORT_RETURN_IF_ERROR(KernelUseSharedPrePackedBuffers(*kernel, input_idx,
-                                                                        *weights_to_use,
-                                                                        node.Name()));
-                  }
-                }
-
-                if (is_packed) {
-                  ++number_of_prepacks_counter_;
-
-                  if (constant_initializers_use_count.count(input_name) && --constant_initializers_use_count[input_name] == 0) {
-                    // release the constant initialized tensor
-                    st->initialized_tensors_.erase(ort_value_idx);
-                    constant_initialized_tensors.erase(ort_value_idx);
-                  }
-                }
-              }
-              // stop searching in 2 cases:
-              // 1. value is not from OuterScope
-              // 2. value is from OuterScope and the current OuterScope has the value
-              if (st != this || !st->graph_.IsOuterScopeValue(input_name)) {
-                break;
-              }
-            }
-            st = st->Parent();
-            prepacked_for_graph = &st->graph_.GetPrepacked();
-          } while (st);
+      const int num_inputs = static_cast<int>(node.InputDefs().size());
+      for (int input_idx = 0; input_idx < num_inputs; ++input_idx) {
+        PrePackTask task;
+        if (GetPrePackTask(node, input_idx, should_cache_prepacked_weights_for_shared_initializers,
+                           initializers_to_share_map, task)) {
+          ORT_RETURN_IF_ERROR(task.kernel->PrePack(*task.tensor, input_idx, task.allocator, task.is_packed,
+                                                   &task.weights));
+          ORT_RETURN_IF_ERROR(SharePrePackedWeights(task, constant_initializers_use_count));
         }
-        input_idx++;
       }
     }
 
@@ -894,6 +1062,11 @@ const MemoryPatternGroup* SessionState::GetMemoryPatternGroup(
 }
 
 void SessionState::ResolveMemoryPatternFlag() {
+  // subgraphs finalized on first use are resolved then
+  if (!p_seq_exec_plan_.has_value()) {
+    return;
+  }
+
   if (enable_mem_pattern_) {
     for (auto* input : graph_viewer_->GetInputs()) {
       if (!input->HasTensorOrScalarShape()) {
@@ -939,6 +1112,16 @@ void SessionState::ResolveMemoryPatternFlag() {
   }
 }
 
+void SessionState::ResolveMemoryPatternFlags() {
+  ResolveMemoryPatternFlag();
+
+  for (const auto& entry : subgraph_session_states_) {
+    for (const auto& name_to_subgraph_session_state : entry.second) {
+      name_to_subgraph_session_state.second->ResolveMemoryPatternFlags();
+    }
+  }
+}
+
 Status SessionState::UpdateMemoryPatternGroupCache(gsl::span<const OrtValue> tensor_inputs,
                                                    MemoryPatternGroup mem_patterns) const {
   int64_t key = CalculateMemoryPatternsKey(tensor_inputs);
@@ -1607,7 +1790,7 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
         return Status::OK();
       },
       logger_, data_transfer_mgr_, external_data_loader_mgr_, *p_seq_exec_plan_, session_options,
-      memory_profile_func, name_to_buffered_tensor_, graph_.GetPrepacked()));
+      memory_profile_func, name_to_buffered_tensor_, graph_.GetPrepacked(), thread_pool_));
 
 #if !defined(ORT_MINIMAL_BUILD) && defined(ORT_MEMORY_PROFILE)
   // Record Weight allocation info on device
@@ -1621,11 +1804,28 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
     CleanInitializedTensorsFromGraph();
   }
 
+  TimePoint tp;
+  if (profiler_.IsEnabled()) {
+    tp = profiler_.Start();
+  }
+
   ORT_RETURN_IF_ERROR(CreateKernels(kernel_registry_manager));
 
+  if (profiler_.IsEnabled()) {
+    profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "kernel_creation", tp,
+                                    {{"node_count", std::to_string(graph_viewer_->NumberOfNodes())}});
+    tp = profiler_.Start();
+  }
+
   if (!disable_prepacking) {
+    const size_t prepacks_before = number_of_prepacks_counter_;
     ORT_RETURN_IF_ERROR(PrepackConstantInitializedTensors(constant_initializers_use_count,
                                                           session_options.initializers_to_share_map));
+
+    if (profiler_.IsEnabled()) {
+      profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "prepacking", tp,
+                                      {{"prepack_count", std::to_string(number_of_prepacks_counter_ - prepacks_before)}});
+    }
   }
 
   ORT_RETURN_IF_ERROR(
@@ -1638,6 +1838,21 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
   SessionOptions subgraph_session_options(session_options);
   subgraph_session_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
 
+  // 'If' branches may be finalized by the first Run executing them instead. Prepacked initializers are saved with the
+  // model after the session is initialized, so every subgraph needs to be finalized by then.
+  const bool lazy_if_branches =
+      !save_prepacked_initializers &&
+      session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsLazySubgraphInitialization, "0") == "1";
+  InlinedHashSet<std::string> prewarmed_branches;
+  if (lazy_if_branches) {
+    const std::string prewarm =
+        session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsLazySubgraphInitializationPrewarm, "");
+    for (const auto& entry : utils::SplitString(prewarm, ",")) {
+      prewarmed_branches.emplace(entry);
+    }
+  }
+  std::shared_ptr<const SessionOptions> deferred_session_options;
+
   for (const auto& node_to_subgraph_ss : subgraph_session_states_) {
     Node& node = *graph_.GetNode(node_to_subgraph_ss.first);
 
@@ -1663,19 +1878,30 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
                                                                subgraph_session_state.GetGraphViewer(),
                                                                subgraph_outer_scope_node_arg_to_location_map));
 
-      ORT_RETURN_IF_ERROR(subgraph_session_state.FinalizeSessionStateImpl(
-          graph_location, kernel_registry_manager, &node, subgraph_session_options, remove_initializers,
-          save_prepacked_initializers,
-          constant_initializers_use_count, subgraph_outer_scope_node_arg_to_location_map, true));
+      const bool defer = lazy_if_branches && node.OpType() == "If" && node.Domain() == kOnnxDomain &&
+                         prewarmed_branches.count(node.Name()) == 0 &&
+                         prewarmed_branches.count(node.Name() + ":" + attr_name) == 0;
+      if (!defer) {
+        ORT_RETURN_IF_ERROR(FinalizeSubgraphSessionState(
+            graph_location, kernel_registry_manager, node, attr_name, subgraph_session_state,
+            subgraph_session_options, remove_initializers, save_prepacked_initializers,
+            constant_initializers_use_count, subgraph_outer_scope_node_arg_to_location_map));
+        continue;
+      }
 
-      // setup all the info for handling the feeds and fetches used in subgraph execution
-      auto* p_op_kernel = GetMutableKernel(node.Index());
-      ORT_ENFORCE(p_op_kernel);
+      if (!deferred_session_options) {
+        deferred_session_options = std::make_shared<const SessionOptions>(subgraph_session_options);
+      }
 
-      // Downcast is safe, since only control flow nodes have subgraphs
-      // (node.GetAttributeNameToMutableSubgraphMap() is non-empty)
-      auto& control_flow_kernel = static_cast<controlflow::IControlFlowKernel&>(*p_op_kernel);
-      ORT_RETURN_IF_ERROR(control_flow_kernel.SetupSubgraphExecutionInfo(*this, attr_name, subgraph_session_state));
+      auto deferred = std::make_unique<DeferredSubgraphFinalization>();
+      deferred->graph_location = graph_location;
+      deferred->kernel_registry_manager = &kernel_registry_manager;
+      deferred->session_options = deferred_session_options;
+      deferred->remove_initializers = remove_initializers;
+      deferred->outer_scope_node_arg_to_location_map = std::move(subgraph_outer_scope_node_arg_to_location_map);
+      deferred_subgraph_finalizations_[node.Index()][attr_name] = std::move(deferred);
+      LOGS(logger_, VERBOSE) << "Deferred the initialization of subgraph '" << attr_name << "' of node '"
+                             << node.Name() << "' to its first execution.";
     }
 
     // TODO: Once the subgraph session states have been finalized, can we go back and plan the location of implicit
@@ -1686,6 +1912,91 @@ Status SessionState::FinalizeSessionStateImpl(const std::basic_string<PATH_CHAR_
   return Status::OK();
 }
 
+Status SessionState::FinalizeSubgraphSessionState(
+    const std::basic_string<PATH_CHAR_TYPE>& graph_location,
+    const KernelRegistryManager& kernel_registry_manager,
+    Node& node, const std::string& attribute_name,
+    SessionState& subgraph_session_state,
+    const SessionOptions& subgraph_session_options,
+    bool remove_initializers,
+    bool save_prepacked_initializers,
+    InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
+    const InlinedHashMap<OrtValueName, OrtDevice>& outer_scope_node_arg_to_location_map) {
+  ORT_RETURN_IF_ERROR(subgraph_session_state.FinalizeSessionStateImpl(
+      graph_location, kernel_registry_manager, &node, subgraph_session_options, remove_initializers,
+      save_prepacked_initializers,
+      constant_initializers_use_count, outer_scope_node_arg_to_location_map, true));
+
+  // setup all the info for handling the feeds and fetches used in subgraph execution
+  auto* p_op_kernel = GetMutableKernel(node.Index());
+  ORT_ENFORCE(p_op_kernel);
+
+  // Downcast is safe, since only control flow nodes have subgraphs
+  // (node.GetAttributeNameToMutableSubgraphMap() is non-empty)
+  auto& control_flow_kernel = static_cast<controlflow::IControlFlowKernel&>(*p_op_kernel);
+  return control_flow_kernel.SetupSubgraphExecutionInfo(*this, attribute_name, subgraph_session_state);
+}
+
+Status SessionState::FinalizeDeferredSubgraphSessionState(NodeIndex index, const std::string& attribute_name) const {
+  const auto node_entry = deferred_subgraph_finalizations_.find(index);
+  if (node_entry == deferred_subgraph_finalizations_.cend()) {
+    return Status::OK();
+  }
+  const auto entry = node_entry->second.find(attribute_name);
+  if (entry == node_entry->second.cend()) {
+    return Status::OK();
+  }
+
+  DeferredSubgraphFinalization& deferred = *entry->second;
+  if (deferred.finalized.load(std::memory_order_acquire)) {
+    return deferred.status;
+  }
+
+  std::lock_guard<std::mutex> lock(deferred.mutex);
+  if (!deferred.finalized.load(std::memory_order_relaxed)) {
+    // Finalization only modifies the subgraph SessionState, which isn't used before this returns, and the entries of
+    // the control flow kernel for this subgraph.
+    auto& self = const_cast<SessionState&>(*this);
+    Node& node = *self.graph_.GetNode(index);
+    SessionState& subgraph_session_state = *self.GetMutableSubgraphSessionState(index, attribute_name);
+
+    // The initializers of the outer graphs may be in use by running kernels, so none is released after pre-packing.
+    InlinedHashMap<std::string, size_t> constant_initializers_use_count;
+
+    TimePoint tp;
+    if (profiler_.IsEnabled()) {
+      tp = profiler_.Start();
+    }
+
+    ORT_TRY {
+      deferred.status = self.FinalizeSubgraphSessionState(
+          deferred.graph_location, *deferred.kernel_registry_manager, node, attribute_name, subgraph_session_state,
+          *deferred.session_options, deferred.remove_initializers, false, constant_initializers_use_count,
+          deferred.outer_scope_node_arg_to_location_map);
+    }
+    ORT_CATCH(const std::exception& ex) {
+      ORT_HANDLE_EXCEPTION([&]() {
+        deferred.status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Exception initializing subgraph '", attribute_name,
+                                          "' of node '", node.Name(), "': ", ex.what());
+      });
+    }
+
+    // memory pattern flags are resolved when the session is initialized, which skipped this subgraph
+    if (deferred.status.IsOK()) {
+      subgraph_session_state.ResolveMemoryPatternFlags();
+    }
+
+    if (profiler_.IsEnabled()) {
+      profiler_.EndTimeAndRecordEvent(profiling::SESSION_EVENT, "subgraph_initialization", tp,
+                                      {{"node", node.Name()}, {"attribute", attribute_name}});
+    }
+
+    deferred.finalized.store(true, std::memory_order_release);
+  }
+
+  return deferred.status;
+}
+
 #ifdef ORT_ENABLE_STREAM
 static void BindToDeviceStream(const SequentialExecutionPlan& execution_plan,
                                DeviceStreamCollection& device_stream_map,
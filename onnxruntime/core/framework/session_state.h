@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <map>
 #include <unordered_map>
@@ -26,6 +27,7 @@
 #include "core/framework/feeds_fetches_manager.h"
 #include "core/framework/framework_common.h"
 #include "core/framework/prepacked_weights_container.h"
+#include "core/framework/prepacked_weights_store.h"
 #include "core/framework/fuse_nodes_funcs.h"
 #include "core/framework/kernel_registry_manager.h"
 #include "core/framework/mem_pattern.h"
@@ -257,6 +259,12 @@ class SessionState {
   */
   void ResolveMemoryPatternFlag();
 
+  /**
+  Calls ResolveMemoryPatternFlag for this SessionState and the subgraph SessionStates it contains.
+  Subgraphs that are finalized on first use are skipped, and resolved when they are finalized.
+  */
+  void ResolveMemoryPatternFlags();
+
   struct NodeInfo {
     /**
      *
@@ -292,6 +300,10 @@ class SessionState {
   /// Return SessionState for the given Node index and attribute name if found.
   const SessionState* GetSubgraphSessionState(NodeIndex index, const std::string& attribute_name) const;
 
+  /// Finalize the SessionState for the given Node index and attribute name if its finalization was deferred to its
+  /// first use (see kOrtSessionOptionsLazySubgraphInitialization). Safe to call from concurrent Run calls.
+  Status FinalizeDeferredSubgraphSessionState(NodeIndex index, const std::string& attribute_name) const;
+
   concurrency::ThreadPool* GetThreadPool() const noexcept { return thread_pool_; }
   concurrency::ThreadPool* GetInterOpThreadPool() const noexcept { return inter_op_thread_pool_; }
 
@@ -413,6 +425,48 @@ class SessionState {
   Status PrepackConstantInitializedTensors(InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
                                            const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map);
 
+  // A constant initialized tensor consumed by an input of a kernel, and the result of pre-packing it.
+  struct PrePackTask {
+    const Node* node{};
+    OpKernel* kernel{};
+    int input_idx{};
+    // session state holding the tensor: this one, or an ancestor if the tensor is an outer scope value
+    SessionState* owner{};
+    PrepackedWeightsForGraph* prepacked_for_graph{};
+    int ort_value_idx{};
+    const Tensor* tensor{};
+    // the pre-packed weights are shared across sessions through prepacked_weights_container_
+    bool cache_in_container{};
+    AllocatorPtr allocator;
+    bool is_packed{};
+    PrePackedWeights weights;
+  };
+
+  // Returns true and fills in task if input input_idx of node is a constant initialized tensor of this graph or of
+  // an outer scope.
+  bool GetPrePackTask(const Node& node, int input_idx, bool should_cache_prepacked_weights_for_shared_initializers,
+                      const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map,
+                      PrePackTask& task);
+
+  // Hands the weights pre-packed by task.kernel->PrePack() to the kernel or replaces them with a shared copy,
+  // then releases the constant initialized tensor once all its consumers pre-packed it.
+  Status SharePrePackedWeights(PrePackTask& task,
+                               InlinedHashMap<std::string, size_t>& constant_initializers_use_count);
+
+  // Replaces packed_weights with the entry stored for key in prepacked_weights_store_, if any,
+  // so that the processes running the same model share the pages of the pre-packed weights.
+  void MapFromPrepackedWeightsStore(const Node& node, const std::string& key, PrePackedWeights& packed_weights) const;
+
+  // Pre-packs the constant inputs of the kernels of the CPU execution provider as parallel tasks.
+  Status PrepackConstantInitializedTensorsInParallel(
+      InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
+      const std::unordered_map<std::string, const OrtValue*>& initializers_to_share_map,
+      bool should_cache_prepacked_weights_for_shared_initializers);
+
+  // True if the kernels of the CPU execution provider are created and pre-packed in parallel on the intra-op
+  // thread pool. See kOrtSessionOptionsParallelKernelInitialization.
+  bool UseParallelKernelInitialization() const;
+
   SessionState* GetMutableSubgraphSessionState(onnxruntime::NodeIndex index, const std::string& attribute_name);
 
   Status CreateSubgraphSessionState();
@@ -433,6 +487,17 @@ class SessionState {
                                   const InlinedHashMap<OrtValueName, OrtDevice>& outer_scope_node_arg_to_location_map = {},
                                   bool graph_info_already_created = false);
 
+  // Finalize the SessionState of a subgraph of node and set up the control flow kernel of node to execute it.
+  Status FinalizeSubgraphSessionState(const std::basic_string<PATH_CHAR_TYPE>& graph_loc,
+                                      const KernelRegistryManager& kernel_registry_manager,
+                                      Node& node, const std::string& attribute_name,
+                                      SessionState& subgraph_session_state,
+                                      const SessionOptions& subgraph_session_options,
+                                      bool remove_initializers,
+                                      bool save_prepacked_initializers,
+                                      InlinedHashMap<std::string, size_t>& constant_initializers_use_count,
+                                      const InlinedHashMap<OrtValueName, OrtDevice>& outer_scope_node_arg_to_location_map);
+
 #ifdef ENABLE_TRAINING
   Status GeneratePatternGroupCache(
       gsl::span<const OrtValue> inputs,
@@ -545,6 +610,23 @@ class SessionState {
 
   SubgraphSessionStateMap subgraph_session_states_;
 
+  // What FinalizeSubgraphSessionState needs for a subgraph whose finalization is deferred to its first use.
+  struct DeferredSubgraphFinalization {
+    std::basic_string<PATH_CHAR_TYPE> graph_location;
+    const KernelRegistryManager* kernel_registry_manager = nullptr;
+    std::shared_ptr<const SessionOptions> session_options;
+    bool remove_initializers = false;
+    InlinedHashMap<OrtValueName, OrtDevice> outer_scope_node_arg_to_location_map;
+
+    std::mutex mutex;
+    std::atomic<bool> finalized{false};
+    Status status;
+  };
+
+  // Same layout as subgraph_session_states_. The maps are only modified during session initialization.
+  InlinedHashMap<NodeIndex, InlinedHashMap<std::string, std::unique_ptr<DeferredSubgraphFinalization>>>
+      deferred_subgraph_finalizations_;
+
   // either threadpool could be nullptr
   concurrency::ThreadPool* const thread_pool_{};
   concurrency::ThreadPool* const inter_op_thread_pool_{};
@@ -563,6 +645,10 @@ class SessionState {
   // prepacked_weights_container_ can be nullptr if no caching is required for prepacked weights
   PrepackedWeightsContainer* const prepacked_weights_container_{};
 
+  // Directory of pre-packed weights shared across processes. nullptr unless
+  // kOrtSessionOptionsPrepackedWeightsStoreDirectory is set.
+  std::unique_ptr<PrepackedWeightsStore> prepacked_weights_store_;
+
 #ifdef ENABLE_TRAINING
 // Needed for ORTTrainer. Should be removed along with ORTTrainer code
 #ifndef DISABLE_ABSEIL
@@ -1,11 +1,13 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <core/common/status.h>
 
@@ -28,6 +30,8 @@
 #include "core/session/onnxruntime_session_options_config_keys.h"
 #include "core/framework/mem_buffer.h"
 #include "core/framework/tensor_allocator.h"
+#include "core/platform/path_lib.h"
+#include "core/platform/threadpool.h"
 #if !defined(ORT_MINIMAL_BUILD) && defined(ORT_MEMORY_PROFILE)
 #include "core/framework/memory_info.h"
 #endif
@@ -97,6 +101,35 @@ static common::Status ExtDataTensorProtoToTensor(const Env& env,
   return common::Status::OK();
 }
 
+// reads the external data of tensor_proto from its file into the buffer of tensor, which must already be allocated
+// with the shape and type of tensor_proto
+static common::Status ReadExtDataIntoTensor(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& proto_path,
+                                            const ONNX_NAMESPACE::TensorProto& tensor_proto, Tensor& tensor) {
+  std::basic_string<ORTCHAR_T> tensor_proto_dir;
+  if (!proto_path.empty()) {
+    ORT_RETURN_IF_ERROR(GetDirNameFromFilePath(proto_path, tensor_proto_dir));
+  }
+
+  std::basic_string<ORTCHAR_T> external_data_file_path;
+  FileOffsetType file_offset = 0;
+  SafeInt<size_t> raw_data_len = 0;
+  ORT_RETURN_IF_ERROR(utils::GetExternalDataInfo(tensor_proto, tensor_proto_dir, external_data_file_path,
+                                                 file_offset, raw_data_len));
+  ORT_RETURN_IF(static_cast<size_t>(raw_data_len) != tensor.SizeInBytes(), "External data of initializer ",
+                tensor_proto.name(), " has ", static_cast<size_t>(raw_data_len), " bytes, expected ",
+                tensor.SizeInBytes());
+
+  ORT_RETURN_IF_ERROR(env.ReadFileIntoBuffer(external_data_file_path.c_str(), file_offset, tensor.SizeInBytes(),
+                                             gsl::make_span(static_cast<char*>(tensor.MutableDataRaw()),
+                                                            tensor.SizeInBytes())));
+  if constexpr (endian::native != endian::little) {
+    utils::ConvertRawDataInTensorProto(const_cast<ONNX_NAMESPACE::TensorProto*>(&tensor_proto),
+                                       tensor.MutableDataRaw(), tensor.SizeInBytes());
+  }
+
+  return common::Status::OK();
+}
+
 // If tensor_proto's external file path is kTensorProtoMemoryAddressTag, and
 // buffered_tensor is not null, buffered_tensor holds the real buffer pointed
 // by tensor_proto. buffered_tensor must be the owner of the buffer and deleter
@@ -148,6 +181,24 @@ static common::Status DeserializeTensorProto(const Env& env, const std::basic_st
                                                      ext_data_deleter, prepacked_for_graph,
                                                      buffered_tensor));
 
+      // The mapped buffer is only used as is when it is aligned like an allocated one. Data at an arbitrary file
+      // offset, e.g. raw data that ModelOptions::load_initializers_in_place left in the model file, is read into an
+      // allocated tensor instead. None of the mapping has been read yet, so dropping it costs nothing.
+      if (buffered_tensor == nullptr && reinterpret_cast<uintptr_t>(p_tensor->DataRaw()) % kAllocAlignment != 0) {
+        if (ext_data_deleter.f) {
+          ext_data_deleter.f(ext_data_deleter.param);
+        }
+
+        p_tensor.reset();
+        ORT_RETURN_IF_ERROR(AllocateTensor(m, p_tensor, type, tensor_shape, use_device_allocator_for_initializers,
+                                           alloc));
+        ORT_RETURN_IF_ERROR(ReadExtDataIntoTensor(env, proto_path, tensor_proto, *p_tensor));
+
+        auto ml_tensor = DataTypeImpl::GetType<Tensor>();
+        ort_value.Init(p_tensor.release(), ml_tensor, ml_tensor->GetDeleteFunc());
+        return common::Status::OK();
+      }
+
       ExtDataValueDeleter deleter{ext_data_deleter, p_tensor.get()};
       MLDataType ml_tensor_type = DataTypeImpl::GetType<Tensor>();
       ort_value.Init(p_tensor.release(), ml_tensor_type, deleter);
@@ -266,6 +317,76 @@ common::Status CopyTensorFromCPUToDevice(
   }
 }
 
+// Reads the external data of initializers into the page cache, in chunks spread across the thread pool, so the
+// mappings created for them afterwards are backed by pages that are already in memory. This is best effort:
+// errors are left to be reported when the initializers are created.
+static void PrefetchExternalData(const Env& env, const std::basic_string<PATH_CHAR_TYPE>& graph_loc,
+                                 const InlinedHashMap<int, const ONNX_NAMESPACE::TensorProto*>& initializers,
+                                 concurrency::ThreadPool* thread_pool, const logging::Logger& logger) {
+  constexpr size_t kChunkSize = 16 * 1024 * 1024;
+  // 4KB is the smallest page size of the platforms ORT runs on, so touching a byte every 4KB touches every page
+  // whatever the actual page size is
+  constexpr size_t kTouchStride = 4096;
+
+  struct Chunk {
+    size_t path_index;
+    FileOffsetType offset;
+    size_t length;
+  };
+
+  std::basic_string<ORTCHAR_T> model_dir;
+  if (!graph_loc.empty() && !GetDirNameFromFilePath(graph_loc, model_dir).IsOK()) {
+    return;
+  }
+
+  std::vector<std::basic_string<ORTCHAR_T>> paths;
+  std::vector<Chunk> chunks;
+  size_t total_length = 0;
+  for (const auto& entry : initializers) {
+    const ONNX_NAMESPACE::TensorProto& tensor_proto = *entry.second;
+    if (!utils::HasExternalData(tensor_proto)) {
+      continue;
+    }
+
+    std::basic_string<ORTCHAR_T> path;
+    FileOffsetType offset = 0;
+    SafeInt<size_t> length = 0;
+    if (!utils::GetExternalDataInfo(tensor_proto, model_dir, path, offset, length).IsOK() ||
+        path == utils::kTensorProtoMemoryAddressTag) {
+      continue;
+    }
+
+    if (paths.empty() || paths.back() != path) {
+      paths.push_back(std::move(path));
+    }
+    for (size_t chunk_offset = 0; chunk_offset < length; chunk_offset += kChunkSize) {
+      chunks.push_back({paths.size() - 1, offset + static_cast<FileOffsetType>(chunk_offset),
+                        std::min(kChunkSize, static_cast<size_t>(length) - chunk_offset)});
+    }
+    total_length += length;
+  }
+
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(chunks.size()), [&](std::ptrdiff_t i) {
+        const Chunk& chunk = chunks[i];
+        Env::MappedMemoryPtr mapped_memory;
+        if (!env.MapFileIntoMemory(paths[chunk.path_index].c_str(), chunk.offset, chunk.length, mapped_memory)
+                 .IsOK()) {
+          return;
+        }
+        // reading a byte of every page faults it in; the pages stay in the page cache after the unmapping
+        const volatile char* data = mapped_memory.get();
+        char value = 0;
+        for (size_t offset = 0; offset < chunk.length; offset += kTouchStride) {
+          value ^= data[offset];
+        }
+        ORT_UNUSED_PARAMETER(value);
+      });
+
+  LOGS(logger, INFO) << "Prefetched " << total_length << " bytes of external initializer data in " << chunks.size()
+                     << " chunks";
+}
+
 common::Status SaveInitializedTensors(
     const Env& env, const std::basic_string<PATH_CHAR_TYPE>& graph_loc,
     const GraphViewer& graph, const AllocatorPtr& default_cpu_alloc,
@@ -280,7 +401,8 @@ common::Status SaveInitializedTensors(
     const SessionOptions& session_options,
     const MemoryProfileFunction& memory_profile_func,
     std::unordered_map<std::string, std::unique_ptr<Tensor>>& buffered_tensors,
-    PrepackedWeightsForGraph& prepacked_for_graph) {
+    PrepackedWeightsForGraph& prepacked_for_graph,
+    concurrency::ThreadPool* thread_pool) {
   LOGS(logger, INFO) << "Saving initialized tensors.";
   ORT_ENFORCE(ort_value_name_idx_map.MaxIdx() > -1, "OrtValue indexes should have been populated.");
 
@@ -376,6 +498,15 @@ common::Status SaveInitializedTensors(
 
   OrtCallback deleter{nullptr, nullptr};
 
+#if !defined(__wasm__)
+  if (session_options.config_options.GetConfigOrDefault(kOrtSessionOptionsExternalInitializersLoadMode, "lazy") ==
+      "parallel") {
+    PrefetchExternalData(env, graph_loc, id_to_initialized_tensor, thread_pool, logger);
+  }
+#else
+  ORT_UNUSED_PARAMETER(thread_pool);
+#endif
+
   // 3. create weight tensors based on weights buffer
   for (const auto& entry : id_to_initialized_tensor) {
     int ort_value_index = entry.first;
@@ -26,6 +26,9 @@ class OrtValueNameIdxMap;
 class DataTransferManager;
 class ExternalDataLoaderManager;
 class NodeArg;
+namespace concurrency {
+class ThreadPool;
+}
 #if !defined(ORT_MINIMAL_BUILD) && defined(ORT_MEMORY_PROFILE)
 class MemoryInfo;
 #endif
@@ -52,7 +55,8 @@ common::Status SaveInitializedTensors(
     const SessionOptions& session_options,
     const MemoryProfileFunction& memory_profile_func,
     std::unordered_map<std::string, std::unique_ptr<Tensor>>& buffered_tensors,
-    PrepackedWeightsForGraph& prepacked_for_graph);
+    PrepackedWeightsForGraph& prepacked_for_graph,
+    concurrency::ThreadPool* thread_pool);
 
 common::Status AllocateTensor(
     const onnxruntime::MemBuffer* m,
@@ -1383,6 +1383,32 @@ ONNX_MS_OPERATOR_SET_SCHEMA(Sampling, 1,
                                   GreedySearchShapeInference(ctx);
                                 }));
 
+constexpr const char* BatchedLoraAdd_ver1_doc = R"DOC(
+Adds the low-rank (LoRA) delta of a per-row adapter to the output of a base MatMul:
+output[b] = base_output[b] + scale[i] * MatMul(MatMul(input[b], lora_a[i]), lora_b[i]), where i = adapter_index[b].
+All adapters are stacked along the first dimension of lora_a and lora_b so that a batch can mix requests
+that use different adapters. Rows with a negative adapter index use the base output unchanged.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(BatchedLoraAdd, 1,
+                            OpSchema()
+                                .SetDoc(BatchedLoraAdd_ver1_doc)
+                                .Input(0, "input", "2D input tensor with shape (batch_size, hidden_size) or 3D input tensor with shape (batch_size, sequence_length, hidden_size)", "T")
+                                .Input(1, "base_output", "Output of the base MatMul with shape (batch_size, output_size) or (batch_size, sequence_length, output_size)", "T")
+                                .Input(2, "lora_a", "3D input tensor with shape (num_adapters, hidden_size, rank)", "T")
+                                .Input(3, "lora_b", "3D input tensor with shape (num_adapters, rank, output_size)", "T")
+                                .Input(4, "adapter_index", "1D input tensor with shape (batch_size). Index of the adapter used by each row, or -1 for none", "I")
+                                .Input(5, "scale", "1D optional input tensor with shape (num_adapters). Scale of each adapter. Default is 1.0", "T", OpSchema::Optional)
+                                .Output(0, "output", "Output tensor with the same shape as base_output", "T")
+                                .TypeConstraint("T", {"tensor(float)"}, "Constrain input and output types to float tensors.")
+                                .TypeConstraint("I", {"tensor(int32)"}, "Constrain adapter index to int32 tensor.")
+                                .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+                                  propagateElemTypeFromInputToOutput(ctx, 1, 0);
+                                  if (hasInputShape(ctx, 1)) {
+                                    propagateShapeFromInputToOutput(ctx, 1, 0);
+                                  }
+                                }));
+
 constexpr const char* MoE_ver1_doc = R"DOC(
       Mixture of experts. Examples: Switch transformer(https://arxiv.org/pdf/2101.03961.pdf) use top 1,
       GLaM(https://arxiv.org/abs/2112.06905) activates top 2 FFN, Vision MOE(https://arxiv.org/pdf/2106.05974.pdf)
@@ -2300,6 +2326,35 @@ ONNX_MS_OPERATOR_SET_SCHEMA(MurmurHash3, 1,
                                   updateOutputShape(ctx, 0, input_shape);
                                 }));
 
+constexpr const char* OneHotMatMul_ver1_doc = R"DOC(
+Computes MatMul(OneHot(indices, depth, values=[0, 1], axis=-1), B) where depth is the first dimension of B,
+without materializing the one-hot tensor: every index selects a row of B. As in OneHot, a negative index
+counts from the end of the depth and the rows of out of range indices are zero.
+)DOC";
+
+ONNX_MS_OPERATOR_SET_SCHEMA(OneHotMatMul, 1,
+                            OpSchema()
+                                .SetDoc(OneHotMatMul_ver1_doc)
+                                .Input(0, "indices", "Indices of the rows of B, of any shape.", "T1")
+                                .Input(1, "B", "2-dimensional matrix of shape [depth, N].", "T")
+                                .Output(0, "Y", "Output of shape indices.shape + [N].", "T")
+                                .TypeConstraint("T1", {"tensor(int32)", "tensor(int64)"},
+                                                "Constrain indices to integer tensors.")
+                                .TypeConstraint("T", {"tensor(float)"}, "Constrain B and Y to float tensors.")
+                                .TypeAndShapeInferenceFunction([](ONNX_NAMESPACE::InferenceContext& ctx) {
+                                  propagateElemTypeFromInputToOutput(ctx, 1, 0);
+                                  if (!hasInputShape(ctx, 0) || !hasInputShape(ctx, 1)) {
+                                    return;
+                                  }
+                                  const auto& b_shape = getInputShape(ctx, 1);
+                                  if (b_shape.dim_size() != 2) {
+                                    fail_shape_inference("B must be 2-dimensional.");
+                                  }
+                                  ONNX_NAMESPACE::TensorShapeProto output_shape = getInputShape(ctx, 0);
+                                  *output_shape.add_dim() = b_shape.dim(1);
+                                  updateOutputShape(ctx, 0, output_shape);
+                                }));
+
 ONNX_MS_OPERATOR_SET_SCHEMA(GatherND, 1,
                             OpSchema()
                                 .Input(0, "data", "Tensor of rank r >= 1.", "T")
@@ -3,6 +3,7 @@
 
 #include "core/graph/graph.h"
 
+#include <atomic>
 #include <cassert>
 #include <fstream>
 #include <iostream>
@@ -204,6 +205,8 @@ NodeArg::NodeArg(const std::string& name, const TypeProto* p_node_arg_type) {
   } else {
     type_ = nullptr;
   }
+
+  MarkChanged();
 }
 #endif  // #if !defined(ORT_MINIMAL_BUILD) || defined(ORT_EXTENDED_MINIMAL_BUILD) || defined(ORT_MINIMAL_BUILD_CUSTOM_OPS)
 
@@ -216,6 +219,13 @@ NodeArg::NodeArg(NodeArgInfo&& node_arg_info) {
   else {
     type_ = nullptr;
   }
+
+  MarkChanged();
+}
+
+void NodeArg::MarkChanged() noexcept {
+  static std::atomic<uint64_t> next_version{0};
+  version_ = next_version.fetch_add(1, std::memory_order_relaxed);
 }
 
 const std::string& NodeArg::Name() const noexcept {
@@ -298,6 +308,7 @@ bool NodeArg::HasTensorOrScalarShape() const {
 
 #if !defined(ORT_MINIMAL_BUILD) || defined(ORT_EXTENDED_MINIMAL_BUILD)
 void NodeArg::SetShape(const TensorShapeProto& shape) {
+  MarkChanged();
   const auto type_case = node_arg_info_.type().value_case();
   switch (type_case) {
     case TypeProto::kTensorType:
@@ -329,6 +340,7 @@ void NodeArg::SetShape(const TensorShapeProto& shape) {
 }
 
 void NodeArg::ClearShape() {
+  MarkChanged();
   const auto type_case = node_arg_info_.type().value_case();
   switch (type_case) {
     case TypeProto::kTensorType:
@@ -392,6 +404,8 @@ common::Status NodeArg::OverrideTypesHelper(const ONNX_NAMESPACE::TypeProto& inp
 
 common::Status NodeArg::UpdateTypeAndShape(const ONNX_NAMESPACE::TypeProto& input_type, bool strict,
                                            bool override_types, const logging::Logger& logger) {
+  MarkChanged();
+
   if (!utils::HasType(node_arg_info_)) {
     SetType(input_type);
     return Status::OK();
@@ -515,6 +529,7 @@ void NodeArg::SetType(DataType p_type) {
 
   type_ = p_type;
   *(node_arg_info_.mutable_type()) = DataTypeUtils::ToTypeProto(p_type);
+  MarkChanged();
 }
 
 #endif  // !defined(ORT_MINIMAL_BUILD)
@@ -524,6 +539,7 @@ void NodeArg::SetType(DataType p_type) {
 void NodeArg::SetType(const TypeProto& type_proto) {
   type_ = DataTypeUtils::ToType(type_proto);
   *(node_arg_info_.mutable_type()) = type_proto;
+  MarkChanged();
 }
 
 #endif  // !defined(ORT_MINIMAL_BUILD) || defined(ORT_EXTENDED_MINIMAL_BUILD)
@@ -993,6 +1009,9 @@ void Node::CreateSubgraph(const std::string& attr_name) {
 
 void Node::AddAttributeProto(AttributeProto value) {
   utils::SetNodeAttribute(std::move(value), attributes_);
+#if !defined(ORT_MINIMAL_BUILD)
+  attributes_changed_since_inference_ = true;
+#endif
   if (graph_) {
     graph_->SetGraphResolveNeeded();
     graph_->SetGraphProtoSyncNeeded();
@@ -1043,6 +1062,9 @@ void Node::AddAttribute(std::string attr_name, GraphProto value) {
 bool Node::ClearAttribute(const std::string& attr_name) {
   graph_->SetGraphResolveNeeded();
   graph_->SetGraphProtoSyncNeeded();
+#if !defined(ORT_MINIMAL_BUILD)
+  attributes_changed_since_inference_ = true;
+#endif
   return attributes_.erase(attr_name) > 0;
 }
 
@@ -3102,6 +3124,67 @@ common::Status Graph::TypeCheckInputsAndInitializers() {
   return Status::OK();
 }
 
+void Graph::GetInferenceStamps(const Node& node, InlinedVector<uint64_t>& stamps) const {
+  stamps.clear();
+  stamps.push_back(node.InputDefs().size());
+  // the lowest bit records whether an input is a constant initializer, as the inferencing of ops like Reshape
+  // reads the values of those. the stamps of the initializers are updated when the values change.
+  for (const NodeArg* input : node.InputDefs()) {
+    const bool is_constant = input->Exists() && GetConstantInitializer(input->Name(), true) != nullptr;
+    stamps.push_back((input->Version() << 1) | (is_constant ? 1 : 0));
+  }
+  for (const NodeArg* output : node.OutputDefs()) {
+    stamps.push_back(output->Version() << 1);
+  }
+}
+
+Status Graph::InferAndVerifyTypeMatchIfChanged(Node& node, const OpSchema& op, const ResolveOptions& options) {
+  // The types in subgraphs and the outer scope values used by them are not tracked, and overriding types may
+  // change the outputs of a node that is otherwise unchanged.
+  if (parent_node_ != nullptr || node.ContainsSubgraph() || options.override_types) {
+    node.inference_stamps_.clear();
+    return InferAndVerifyTypeMatch(node, op, options);
+  }
+
+  InlinedVector<uint64_t> stamps;
+  GetInferenceStamps(node, stamps);
+  if (!node.attributes_changed_since_inference_ && !node.inference_stamps_.empty() &&
+      std::equal(stamps.begin(), stamps.end(), node.inference_stamps_.begin(), node.inference_stamps_.end())) {
+    return Status::OK();
+  }
+
+  // When a changed node is inferred again, an output that ends up with the same type and shape keeps its stamp
+  // so the nodes consuming it are not inferred again too.
+  const bool inferred_before = !node.inference_stamps_.empty();
+  InlinedVector<std::pair<uint64_t, std::string>> previous_outputs;
+  if (inferred_before) {
+    for (const NodeArg* output : node.OutputDefs()) {
+      const TypeProto* type = output->TypeAsProto();
+      previous_outputs.emplace_back(output->Version(), type != nullptr ? type->SerializeAsString() : std::string());
+    }
+  }
+
+  node.inference_stamps_.clear();
+  ORT_RETURN_IF_ERROR(InferAndVerifyTypeMatch(node, op, options));
+
+  if (inferred_before) {
+    auto& output_defs = node.MutableDefinitions().output_defs;
+    for (size_t i = 0; i < output_defs.size(); ++i) {
+      NodeArg& output = *output_defs[i];
+      const TypeProto* type = output.TypeAsProto();
+      if (output.version_ != previous_outputs[i].first && type != nullptr &&
+          type->SerializeAsString() == previous_outputs[i].second) {
+        output.version_ = previous_outputs[i].first;
+      }
+    }
+  }
+
+  GetInferenceStamps(node, stamps);
+  node.inference_stamps_.assign(stamps.begin(), stamps.end());
+  node.attributes_changed_since_inference_ = false;
+  return Status::OK();
+}
+
 Status Graph::VerifyNodeAndOpMatch(const ResolveOptions& options) {
   CheckerContext ctx;
   ctx.set_ir_version(gsl::narrow_cast<int>(IrVersion()));
@@ -3166,6 +3249,7 @@ Status Graph::VerifyNodeAndOpMatch(const ResolveOptions& options) {
       }
 
       SetOpSchemaFromRegistryForNode(node);
+      node.inference_stamps_.clear();
 
       if (!node.op_) {
         // check whether it refer to a function.
@@ -3223,7 +3307,7 @@ Status Graph::VerifyNodeAndOpMatch(const ResolveOptions& options) {
       }
     }
 
-    NO_CHANGE_ON_SYNC_FLAG(ORT_RETURN_IF_ERROR(InferAndVerifyTypeMatch(node, *p_op, options)));
+    NO_CHANGE_ON_SYNC_FLAG(ORT_RETURN_IF_ERROR(InferAndVerifyTypeMatchIfChanged(node, *p_op, options)));
 
     // Accumulate output names of the iterated Node
     for (const auto& output : node.OutputDefs()) {
@@ -3413,6 +3497,7 @@ void Graph::AddInitializedTensor(const TensorProto& tensor) {
   const gsl::not_null<TensorProto*> tensor_added{graph_proto_->add_initializer()};
   *(tensor_added) = tensor;
   name_to_initial_tensor_.emplace(tensor.name(), tensor_added);
+  MarkInitializerChanged(tensor.name());
   SetGraphResolveNeeded();
   if (!is_loaded_from_model_file_ && GetNodeArg(tensor.name()) == nullptr) {
     // make sure there is a NodeArg for the initializer as SetGraphInputsOutputs may add it to the graph inputs.
@@ -3508,6 +3593,7 @@ void Graph::RemoveInitializedTensor(const std::string& tensor_name) {
     // doesn't matter if it existed or not
     ORT_IGNORE_RETURN_VALUE(ortvalue_initializers_.erase(tensor_name));
 
+    MarkInitializerChanged(tensor_name);
     SetGraphResolveNeeded();
   } else {
 #if !defined(DISABLE_SPARSE_TENSORS)
@@ -3565,6 +3651,7 @@ Status Graph::ReplaceInitializedTensorImpl(ONNX_NAMESPACE::TensorProto new_initi
               "graph_proto_ is not in sync with name_to_initial_tensor_");
 
   **existing_entry = std::move(new_initializer);
+  MarkInitializerChanged(name_to_initializer_it->first);
 
   return Status::OK();
 }
@@ -4541,6 +4628,13 @@ void Graph::ComputeOverridableInitializers() {
   }
 }
 
+void Graph::MarkInitializerChanged(const std::string& name) {
+  auto node_arg = node_args_.find(name);
+  if (node_arg != node_args_.end()) {
+    node_arg->second->MarkChanged();
+  }
+}
+
 #if !defined(ORT_MINIMAL_BUILD)
 
 GSL_SUPPRESS(es .84)  // warning about ignoring return value from insert(...)
@@ -4924,6 +5018,7 @@ Status Graph::AddConstantProtoAsInitializer(const ONNX_NAMESPACE::NodeProto& nod
   auto insert_result = name_to_initial_tensor_.emplace(tensor->name(), tensor);
   ORT_ENFORCE(insert_result.second, "Constant node name: ", tensor->name(),
               " conflicts with graph initializer. Check that the node names have been made unique.");
+  MarkInitializerChanged(tensor->name());
   if (GetNodeArg(tensor->name()) == nullptr) {
     TypeProto t{TypeProtoFromTensorProto(*tensor)};
     ORT_IGNORE_RETURN_VALUE(GetOrCreateNodeArg(tensor->name(), &t));
@@ -1,7 +1,11 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <filesystem>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include "core/common/logging/logging.h"
 #include "core/flatbuffers/schema/ort.fbs.h"
 #include "core/flatbuffers/flatbuffers_utils.h"
@@ -488,6 +492,184 @@ Status Model::Load(ModelProto&& model_proto,
   return status;
 }
 
+namespace {
+
+// Initializers with less raw data than this keep it in the TensorProto when a model is loaded with
+// ModelOptions::load_initializers_in_place, as the optimizers read small initializers often.
+constexpr size_t kMinInPlaceInitializerSize = 1024;
+
+// A field of a serialized protobuf message.
+struct WireField {
+  uint64_t number;
+  uint32_t wire_type;
+  const uint8_t* begin;    // start of the tag
+  const uint8_t* payload;  // start of the value, after the length of a length-delimited field
+  const uint8_t* end;
+};
+
+bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && p < end; shift += 7) {
+    const uint8_t byte = *p++;
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reads the field that starts at p and moves p past it. Returns false if the data is malformed.
+bool ReadWireField(const uint8_t*& p, const uint8_t* end, WireField& field) {
+  field.begin = p;
+  uint64_t tag = 0;
+  if (!ReadVarint(p, end, tag)) {
+    return false;
+  }
+
+  field.number = tag >> 3;
+  field.wire_type = static_cast<uint32_t>(tag & 7);
+  uint64_t size = 0;
+  switch (field.wire_type) {
+    case 0:  // varint
+      field.payload = p;
+      if (!ReadVarint(p, end, size)) {
+        return false;
+      }
+      size = 0;
+      break;
+    case 1:  // fixed64
+      size = 8;
+      break;
+    case 2:  // length-delimited
+      if (!ReadVarint(p, end, size)) {
+        return false;
+      }
+      break;
+    case 5:  // fixed32
+      size = 4;
+      break;
+    default:  // groups, which ONNX does not use
+      return false;
+  }
+
+  if (field.wire_type != 0) {
+    field.payload = p;
+  }
+  if (size > static_cast<uint64_t>(end - p)) {
+    return false;
+  }
+  p += size;
+  field.end = p;
+  return true;
+}
+
+void AppendField(const WireField& field, std::string& fields) {
+  fields.append(reinterpret_cast<const char*>(field.begin), static_cast<size_t>(field.end - field.begin));
+}
+
+// Parses the TensorProto in [begin, end) of the mapped model file. Large raw data is not copied: the tensor is given
+// external data at the offset of the raw data in the file instead. Protobuf does not align raw data, so whether the
+// initializer can use a mapping of the file or needs its own buffer is decided when the session creates it.
+bool ParseTensorInPlace(const uint8_t* begin, const uint8_t* end, const uint8_t* file_begin,
+                        const std::filesystem::path& location, TensorProto& tensor) {
+  std::string other_fields;
+  const uint8_t* raw_data = nullptr;
+  size_t raw_data_size = 0;
+  for (const uint8_t* p = begin; p < end;) {
+    WireField field;
+    if (!ReadWireField(p, end, field)) {
+      return false;
+    }
+    if (field.number == TensorProto::kRawDataFieldNumber && field.wire_type == 2) {
+      raw_data = field.payload;
+      raw_data_size = static_cast<size_t>(field.end - field.payload);
+    } else {
+      AppendField(field, other_fields);
+    }
+  }
+
+  if (!tensor.ParseFromString(other_fields)) {
+    return false;
+  }
+
+  if (raw_data != nullptr) {
+    const auto raw_data_offset = static_cast<size_t>(raw_data - file_begin);
+    if (raw_data_size < kMinInPlaceInitializerSize || utils::HasExternalData(tensor)) {
+      tensor.set_raw_data(raw_data, raw_data_size);
+    } else {
+      ExternalDataInfo::SetExternalLocationToProto(location, static_cast<int64_t>(raw_data_offset), raw_data_size,
+                                                   tensor);
+    }
+  }
+  return true;
+}
+
+// Parses a serialized ModelProto without the raw data of the initializers of its main graph, which is left in the
+// file. Only the graph structure is copied, and one initializer at a time, so the whole model is never in memory,
+// and a file of more than 2GB can be loaded as long as the rest of the model is smaller than that.
+Status LoadModelProtoInPlace(const PathString& file_path, ModelProto& model_proto) {
+  const Env& env = Env::Default();
+  size_t file_size = 0;
+  ORT_RETURN_IF_ERROR(env.GetFileLength(file_path.c_str(), file_size));
+  ORT_RETURN_IF(file_size == 0, "Load model ", ToUTF8String(file_path), " failed. The file is empty");
+
+  // the pages holding the raw data of large initializers are never read through this mapping
+  Env::MappedMemoryPtr mapped_file;
+  ORT_RETURN_IF_ERROR(env.MapFileIntoMemory(file_path.c_str(), 0, file_size, mapped_file));
+  const auto* file_begin = reinterpret_cast<const uint8_t*>(mapped_file.get());
+  const uint8_t* file_end = file_begin + file_size;
+  const std::filesystem::path location = std::filesystem::path(file_path).filename();
+
+  std::string model_fields;
+  std::string graph_fields;
+  std::vector<std::pair<const uint8_t*, const uint8_t*>> initializers;
+  bool result = true;
+  for (const uint8_t* p = file_begin; result && p < file_end;) {
+    WireField field;
+    result = ReadWireField(p, file_end, field);
+    if (!result) {
+      break;
+    }
+    if (field.number != ModelProto::kGraphFieldNumber || field.wire_type != 2) {
+      AppendField(field, model_fields);
+      continue;
+    }
+
+    // repeated occurrences of a message field are merged, so the fields of all of them make up the graph
+    for (const uint8_t* q = field.payload; q < field.end;) {
+      WireField graph_field;
+      result = ReadWireField(q, field.end, graph_field);
+      if (!result) {
+        break;
+      }
+      if (graph_field.number == GraphProto::kInitializerFieldNumber && graph_field.wire_type == 2) {
+        initializers.emplace_back(graph_field.payload, graph_field.end);
+      } else {
+        AppendField(graph_field, graph_fields);
+      }
+    }
+  }
+
+  result = result && model_proto.ParseFromString(model_fields);
+  if (result && !(graph_fields.empty() && initializers.empty())) {
+    GraphProto& graph = *model_proto.mutable_graph();
+    result = graph.ParseFromString(graph_fields);
+    graph.mutable_initializer()->Reserve(narrow<int>(initializers.size()));
+    for (size_t i = 0; result && i < initializers.size(); ++i) {
+      result = ParseTensorInPlace(initializers[i].first, initializers[i].second, file_begin, location,
+                                  *graph.add_initializer());
+    }
+  }
+
+  if (!result) {
+    return Status(ONNXRUNTIME, INVALID_PROTOBUF, "Protobuf parsing failed.");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 template <typename T, typename Loader>
 static Status LoadModelHelper(const T& file_path, Loader loader) {
   int fd;
@@ -536,6 +718,13 @@ template <typename T>
 static Status LoadModel(const T& file_path, std::shared_ptr<Model>& p_model,
                         const IOnnxRuntimeOpSchemaRegistryList* local_registries,
                         const logging::Logger& logger, const ModelOptions& options) {
+  // the raw data of the initializers is referenced as it is laid out in the file, which is little-endian
+  if (options.load_initializers_in_place && endian::native == endian::little) {
+    ModelProto model_proto;
+    ORT_RETURN_IF_ERROR(LoadModelProtoInPlace(ToPathString(file_path), model_proto));
+    return Model::Load(std::move(model_proto), ToPathString(file_path), p_model, local_registries, logger, options);
+  }
+
   const auto loader = [&file_path, &p_model, local_registries, &logger, &options](int fd) {
     return Model::Load(fd, ToPathString(file_path), p_model, local_registries, logger, options);
   };
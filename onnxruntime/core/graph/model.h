@@ -38,6 +38,14 @@ struct ModelOptions {
   // be returned.
   bool strict_shape_type_inference;
 
+  // If true, a model loaded from a file is parsed without copying the raw data of large initializers of the main
+  // graph. They are converted to external data that points at their bytes in the model file, so peak memory during
+  // load stays close to the size of the graph structure. CPU initializers whose data is aligned to kAllocAlignment
+  // in the file are later memory-mapped in place, the others are read into their own buffer. The external data
+  // references the model file by its file name, so a copy of the model saved to another directory without writing
+  // its initializers to a new external data file can no longer find their data.
+  bool load_initializers_in_place = false;
+
   ModelOptions(bool allow_released_opsets_only, bool strict_shape_type_inference)
       : allow_released_opsets_only(allow_released_opsets_only),
         strict_shape_type_inference(strict_shape_type_inference) {}
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include <limits>
+#include <optional>
 
 #include "core/optimizer/constant_folding.h"
 #include "core/optimizer/initializer.h"
@@ -11,6 +12,9 @@
 #include "core/optimizer/utils.h"
 #include "core/framework/op_kernel.h"
 #include "core/framework/tensorprotoutils.h"
+#include "core/common/parse_string.h"
+#include "core/platform/threadpool.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 
 using namespace onnxruntime::common;
 
@@ -20,8 +24,10 @@ ConstantFolding::ConstantFolding(const IExecutionProvider& execution_provider,
                                  bool skip_dequantize_linear,
                                  const ConfigOptions& config_options,
                                  const InlinedHashSet<std::string_view>& compatible_execution_providers,
-                                 const InlinedHashSet<std::string>& excluded_initializers) noexcept
-    : ConstantFolding("ConstantFolding", execution_provider, skip_dequantize_linear, config_options, compatible_execution_providers, excluded_initializers) {
+                                 const InlinedHashSet<std::string>& excluded_initializers,
+                                 concurrency::ThreadPool* intra_op_thread_pool) noexcept
+    : ConstantFolding("ConstantFolding", execution_provider, skip_dequantize_linear, config_options, compatible_execution_providers, excluded_initializers,
+                      intra_op_thread_pool) {
 }
 
 ConstantFolding::ConstantFolding(const std::string& name,
@@ -29,12 +35,14 @@ ConstantFolding::ConstantFolding(const std::string& name,
                                  bool skip_dequantize_linear,
                                  const ConfigOptions& config_options,
                                  const InlinedHashSet<std::string_view>& compatible_execution_providers,
-                                 const InlinedHashSet<std::string>& excluded_initializers) noexcept
+                                 const InlinedHashSet<std::string>& excluded_initializers,
+                                 concurrency::ThreadPool* intra_op_thread_pool) noexcept
     : GraphTransformer(name, compatible_execution_providers),
       skip_dequantize_linear_(skip_dequantize_linear),
       config_options_(config_options),
       excluded_initializers_(excluded_initializers),
-      execution_provider_(execution_provider) {
+      execution_provider_(execution_provider),
+      intra_op_thread_pool_(intra_op_thread_pool) {
 }
 
 // We need to handle a Shape node separately as the input doesn't need to be a constant initializer for
@@ -140,11 +148,214 @@ static Status ConstantFoldIfNode(Graph& graph, Node& if_node, const logging::Log
   return status;
 }
 
+namespace {
+
+// The expansion ratio limit does not apply to outputs smaller than this.
+constexpr size_t kMinBytesForExpansionRatio = 4096;
+
+// Limits on the tensors constant folding adds to the graph.
+// See kOrtSessionOptionsConstantFoldingMaxOutputBytes and kOrtSessionOptionsConstantFoldingMaxExpansionRatio.
+struct FoldingBudget {
+  size_t max_output_bytes = 0;
+  double max_expansion_ratio = 0.0;
+
+  bool Allows(size_t input_bytes, size_t output_bytes) const {
+    if (max_output_bytes != 0 && output_bytes > max_output_bytes) {
+      return false;
+    }
+    return max_expansion_ratio == 0.0 || output_bytes < kMinBytesForExpansionRatio ||
+           static_cast<double>(output_bytes) <= max_expansion_ratio * static_cast<double>(input_bytes);
+  }
+};
+
+// A node to fold by computing it. It is computed by FoldNodes, in parallel with the other nodes collected with it,
+// none of which consumes the outputs of another.
+struct NodeToFold {
+  Node* node;
+  std::unique_ptr<OptimizerExecutionFrame::Info> info;
+  std::unique_ptr<const OpKernel> kernel;
+  std::vector<int> fetch_mlvalue_idxs;
+  size_t input_bytes;
+  std::vector<OrtValue> fetches;
+  Status status;
+};
+
+size_t GetInputBytes(const InitializedTensorSet& constant_inputs) {
+  size_t input_bytes = 0;
+  for (const auto& entry : constant_inputs) {
+    size_t size = 0;
+    if (utils::GetSizeInBytesFromTensorProto<0>(*entry.second, &size).IsOK()) {
+      input_bytes += size;
+    }
+  }
+  return input_bytes;
+}
+
+// Size of the outputs of the node according to their inferred shapes, or nullopt if a shape is not fully known.
+std::optional<size_t> GetInferredOutputBytes(const Node& node) {
+  size_t output_bytes = 0;
+  for (const auto* output_def : node.OutputDefs()) {
+    if (!output_def->Exists()) {
+      continue;
+    }
+    const auto* type = output_def->TypeAsProto();
+    size_t size = 0;
+    if (type == nullptr || !utils::HasTensorType(*type) ||
+        !utils::GetSizeInBytesFromTensorTypeProto<0>(type->tensor_type(), &size).IsOK()) {
+      return std::nullopt;
+    }
+    output_bytes += size;
+  }
+  return output_bytes;
+}
+
+void RemoveFoldedNode(Graph& graph, Node& node) {
+  // Remove single-output node chain for inputs of the node
+  auto p_ip_node = node.InputNodesBegin();
+  const auto p_ip_node_end = node.InputNodesEnd();
+  while (p_ip_node != p_ip_node_end) {
+    const auto& input_node = *p_ip_node;
+    // Update the node iterator before removing the corresponding node because removing
+    // the node will invalidate the node iterator
+    ++p_ip_node;
+    graph_utils::RemoveNodesWithOneOutputBottomUp(graph, input_node);
+  }
+
+  // Remove the output edges of the constant node and then remove the node itself.
+  graph_utils::RemoveNodeOutputEdges(graph, node);
+  graph.RemoveNode(node.Index());
+}
+
+bool ConsumesOutputOf(const Node& node, const InlinedHashSet<NodeIndex>& producers) {
+  for (auto it = node.InputNodesBegin(), end = node.InputNodesEnd(); it != end; ++it) {
+    if (producers.count(it->Index()) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Status ComputeNode(NodeToFold& to_fold, const logging::Logger& logger) {
+  OptimizerExecutionFrame frame(*to_fold.info, to_fold.fetch_mlvalue_idxs);
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning(disable : 6387)
+#endif
+  OpKernelContext op_kernel_context(&frame, to_fold.kernel.get(), /*stream*/ nullptr, nullptr, logger);
+  ORT_RETURN_IF_ERROR(to_fold.kernel->Compute(&op_kernel_context));
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+  return frame.GetOutputs(to_fold.fetches);
+}
+
+// Computes the nodes, spread across the thread pool, then replaces the outputs of each of them with initializers
+// and removes it, in the order the nodes were collected in.
+Status FoldNodes(Graph& graph, std::vector<NodeToFold>& nodes, const FoldingBudget& budget,
+                 concurrency::ThreadPool* thread_pool, bool& modified, bool& have_updated_nodes,
+                 const logging::Logger& logger) {
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      thread_pool, static_cast<std::ptrdiff_t>(nodes.size()), [&nodes, &logger](std::ptrdiff_t i) {
+        NodeToFold& to_fold = nodes[i];
+        ORT_TRY {
+          to_fold.status = ComputeNode(to_fold, logger);
+        }
+        ORT_CATCH(const std::exception& ex) {
+          ORT_HANDLE_EXCEPTION([&]() {
+            to_fold.status = ORT_MAKE_STATUS(ONNXRUNTIME, FAIL, "Constant folding of node '", to_fold.node->Name(),
+                                             "' failed: ", ex.what());
+          });
+        }
+        // the inputs are not needed anymore
+        to_fold.kernel.reset();
+        to_fold.info.reset();
+      });
+
+  for (NodeToFold& to_fold : nodes) {
+    ORT_RETURN_IF_ERROR(to_fold.status);
+    Node& node = *to_fold.node;
+
+    // Go over all output node args and substitute them with the newly computed tensors, which will be
+    // added to the graph as initializers.
+    ORT_ENFORCE(to_fold.fetches.size() == node.OutputDefs().size());
+    bool converted_to_constant = true;
+    size_t output_bytes = 0;
+    for (size_t fetch_idx = 0; fetch_idx < to_fold.fetches.size(); ++fetch_idx) {
+      const auto& constant_arg_out = *node.OutputDefs()[fetch_idx];
+      // XXX: Add support for SparseTensors outputs when we have sparse outputs
+      if (!utils::HasTensorType(*constant_arg_out.TypeAsProto())) {
+        LOGS(logger, INFO) << "Unsupported output type of " << constant_arg_out.Type()
+                           << ". Can't constant fold " << node.OpType() << " node '" << node.Name() << "'";
+        converted_to_constant = false;
+        break;
+      }
+      output_bytes += to_fold.fetches[fetch_idx].Get<Tensor>().SizeInBytes();
+    }
+
+    if (converted_to_constant && !budget.Allows(to_fold.input_bytes, output_bytes)) {
+      LOGS(logger, INFO) << "Not constant folding " << node.OpType() << " node '" << node.Name() << "' as its "
+                         << output_bytes << " bytes of outputs exceed the constant folding limits";
+      converted_to_constant = false;
+    }
+
+    if (!converted_to_constant) {
+      continue;
+    }
+
+    for (size_t fetch_idx = 0; fetch_idx < to_fold.fetches.size(); ++fetch_idx) {
+      OrtValue& ort_value = to_fold.fetches[fetch_idx];
+      // Build the TensorProto that corresponds to the computed OrtValue and add it as initializer to the graph.
+      auto* constant_arg_out = node.MutableOutputDefs()[fetch_idx];
+      const Tensor& out_tensor = ort_value.Get<Tensor>();
+      ONNX_NAMESPACE::TensorProto out_tensorproto = utils::TensorToTensorProto(out_tensor, constant_arg_out->Name());
+
+      ONNX_NAMESPACE::TensorShapeProto result_shape;
+      for (auto& dim : out_tensor.Shape().GetDims()) {
+        result_shape.add_dim()->set_dim_value(dim);
+      }
+
+      constant_arg_out->SetShape(result_shape);
+      graph.AddInitializedTensor(out_tensorproto);
+    }
+    to_fold.fetches.clear();
+
+    RemoveFoldedNode(graph, node);
+    modified = true;
+    have_updated_nodes = true;
+  }
+
+  nodes.clear();
+  return Status::OK();
+}
+
+}  // namespace
+
 Status ConstantFolding::ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const {
   bool have_updated_nodes = false;
   GraphViewer graph_viewer(graph);
   auto& order = graph_viewer.GetNodesInTopologicalOrder();
 
+  FoldingBudget budget;
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options_.GetConfigOrDefault(kOrtSessionOptionsConstantFoldingMaxOutputBytes, "0"),
+      budget.max_output_bytes));
+  ORT_RETURN_IF_ERROR(ParseStringWithClassicLocale(
+      config_options_.GetConfigOrDefault(kOrtSessionOptionsConstantFoldingMaxExpansionRatio, "0"),
+      budget.max_expansion_ratio));
+
+  // Nodes are collected until one that consumes the output of a collected node is reached, so all the collected
+  // nodes can be computed at the same time. The graph is then updated as if they had been folded one by one.
+  // The number collected is bounded as each holds a copy of its inputs.
+  const int degree_of_parallelism = concurrency::ThreadPool::DegreeOfParallelism(intra_op_thread_pool_);
+  const size_t max_nodes_to_fold = degree_of_parallelism > 1 ? 4 * static_cast<size_t>(degree_of_parallelism) : 1;
+  std::vector<NodeToFold> nodes_to_fold;
+  InlinedHashSet<NodeIndex> nodes_to_fold_indices;
+  const auto fold_collected_nodes = [&]() {
+    nodes_to_fold_indices.clear();
+    return FoldNodes(graph, nodes_to_fold, budget, intra_op_thread_pool_, modified, have_updated_nodes, logger);
+  };
+
 #if !defined(DISABLE_SPARSE_TENSORS)
   std::function<bool(const std::string&)> is_sparse_initializer_check = [&graph](const std::string& name) -> bool {
     return graph.IsSparseInitializer(name);
@@ -153,6 +364,10 @@ Status ConstantFolding::ApplyImpl(Graph& graph, bool& modified, int graph_level,
 
   for (NodeIndex i : order) {
     auto* node = graph.GetNode(i);
+    if (node != nullptr && ConsumesOutputOf(*node, nodes_to_fold_indices)) {
+      ORT_RETURN_IF_ERROR(fold_collected_nodes());
+    }
+
     if (!node || !AllowConstantFolding(*node)) {
       continue;
     }
@@ -233,20 +448,30 @@ Status ConstantFolding::ApplyImpl(Graph& graph, bool& modified, int graph_level,
         }
       }
 
+      // skip computing a node whose outputs are known to exceed the limits from their inferred shapes
+      const size_t input_bytes = GetInputBytes(constant_inputs);
+      if (const auto output_bytes = GetInferredOutputBytes(*node);
+          output_bytes.has_value() && !budget.Allows(input_bytes, *output_bytes)) {
+        LOGS(logger, INFO) << "Not constant folding " << node->OpType() << " node '" << node->Name() << "' as its "
+                           << *output_bytes << " bytes of outputs exceed the constant folding limits";
+        continue;
+      }
+
 #if !defined(DISABLE_SPARSE_TENSORS)
       // Create execution frame for executing constant nodes.
-      OptimizerExecutionFrame::Info info({node}, constant_inputs, graph.ModelPath(), execution_provider_,
-                                         is_sparse_initializer_check, logger);
+      auto info = std::make_unique<OptimizerExecutionFrame::Info>(
+          std::vector<const Node*>{node}, constant_inputs, graph.ModelPath(), execution_provider_,
+          is_sparse_initializer_check, logger);
 #else
       // Create execution frame for executing constant nodes.
-      OptimizerExecutionFrame::Info info(
-          {node}, constant_inputs, graph.ModelPath(), execution_provider_, [](const std::string&) { return false; },
-          logger);
+      auto info = std::make_unique<OptimizerExecutionFrame::Info>(
+          std::vector<const Node*>{node}, constant_inputs, graph.ModelPath(), execution_provider_,
+          [](const std::string&) { return false; }, logger);
 #endif
 
       std::vector<int> fetch_mlvalue_idxs;
       for (const auto* node_out : node->OutputDefs()) {
-        fetch_mlvalue_idxs.push_back(info.GetMLValueIndex(node_out->Name()));
+        fetch_mlvalue_idxs.push_back(info->GetMLValueIndex(node_out->Name()));
       }
 
       const bool node_on_cpu_ep = node->GetExecutionProviderType() == kCpuExecutionProvider;
@@ -261,12 +486,12 @@ Status ConstantFolding::ApplyImpl(Graph& graph, bool& modified, int graph_level,
         // override the EP assigned to the node so that it will use the CPU kernel for Compute.
         node->SetExecutionProviderType(kCpuExecutionProvider);
 
-        kernel = info.CreateKernel(node, config_options_);
+        kernel = info->CreateKernel(node, config_options_);
 
         // undo the EP change to the value that was assigned at graph partitioning time
         node->SetExecutionProviderType(ep_type);
       } else {
-        kernel = info.CreateKernel(node, config_options_);
+        kernel = info->CreateKernel(node, config_options_);
       }
 
       // We currently constant fold using the CPU EP only.
@@ -282,74 +507,21 @@ Status ConstantFolding::ApplyImpl(Graph& graph, bool& modified, int graph_level,
         continue;
       }
 
-      OptimizerExecutionFrame frame(info, fetch_mlvalue_idxs);
-#ifdef _WIN32
-#pragma warning(push)
-#pragma warning(disable : 6387)
-#endif
-      OpKernelContext op_kernel_context(&frame, kernel.get(), /*stream*/ nullptr, nullptr, logger);
-      ORT_RETURN_IF_ERROR(kernel->Compute(&op_kernel_context));
-#ifdef _WIN32
-#pragma warning(pop)
-#endif
-
-      std::vector<OrtValue> fetches;
-      ORT_RETURN_IF_ERROR(frame.GetOutputs(fetches));
-
-      // Go over all output node args and substitute them with the newly computed tensors, which will be
-      // added to the graph as initializers.
-      ORT_ENFORCE(fetches.size() == node->OutputDefs().size());
-      converted_to_constant = true;
-      for (size_t fetch_idx = 0; fetch_idx < fetches.size(); ++fetch_idx) {
-        const auto& constant_arg_out = *node->OutputDefs()[fetch_idx];
-        // XXX: Add support for SparseTensors outputs when we have sparse outputs
-        if (!utils::HasTensorType(*constant_arg_out.TypeAsProto())) {
-          LOGS(logger, INFO) << "Unsupported output type of " << constant_arg_out.Type()
-                             << ". Can't constant fold " << node->OpType() << " node '" << node->Name() << "'";
-          converted_to_constant = false;
-          break;
-        }
-      }
-
-      if (converted_to_constant) {
-        for (size_t fetch_idx = 0; fetch_idx < fetches.size(); ++fetch_idx) {
-          OrtValue& ort_value = fetches[fetch_idx];
-          // Build the TensorProto that corresponds to the computed OrtValue and add it as initializer to the graph.
-          auto* constant_arg_out = node->MutableOutputDefs()[fetch_idx];
-          const Tensor& out_tensor = ort_value.Get<Tensor>();
-          ONNX_NAMESPACE::TensorProto out_tensorproto = utils::TensorToTensorProto(out_tensor, constant_arg_out->Name());
-
-          ONNX_NAMESPACE::TensorShapeProto result_shape;
-          for (auto& dim : out_tensor.Shape().GetDims()) {
-            result_shape.add_dim()->set_dim_value(dim);
-          }
-
-          constant_arg_out->SetShape(result_shape);
-          graph.AddInitializedTensor(out_tensorproto);
-        }
+      nodes_to_fold_indices.insert(node->Index());
+      nodes_to_fold.push_back(NodeToFold{node, std::move(info), std::move(kernel), std::move(fetch_mlvalue_idxs),
+                                         input_bytes, {}, Status::OK()});
+      if (nodes_to_fold.size() == max_nodes_to_fold) {
+        ORT_RETURN_IF_ERROR(fold_collected_nodes());
       }
     }
 
     if (converted_to_constant) {
-      // Remove single-output node chain for inputs of the node
-      auto p_ip_node = node->InputNodesBegin();
-      const auto p_ip_node_end = node->InputNodesEnd();
-      while (p_ip_node != p_ip_node_end) {
-        const auto& input_node = *p_ip_node;
-        // Update the node iterator before removing the corresponding node because removing
-        // the node will invalidate the node iterator
-        ++p_ip_node;
-        graph_utils::RemoveNodesWithOneOutputBottomUp(graph, input_node);
-      }
-
-      // Remove the output edges of the constant node and then remove the node itself.
-      graph_utils::RemoveNodeOutputEdges(graph, *node);
-      graph.RemoveNode(node->Index());
+      RemoveFoldedNode(graph, *node);
       modified = true;
       have_updated_nodes = true;
     }
   }
 
-  return Status::OK();
+  return fold_collected_nodes();
 }
 }  // namespace onnxruntime
@@ -9,24 +9,30 @@
 #include "core/framework/execution_provider.h"
 
 namespace onnxruntime {
+namespace concurrency {
+class ThreadPool;
+}
 
 /**
 @class ConstantFolding
 
 Transformer that traverses the graph top-down and performs constant folding, i.e.,
 it statically computes parts of the graph that rely only on constant initializers.
+Nodes that do not depend on each other are computed in parallel when a thread pool is provided.
 */
 class ConstantFolding : public GraphTransformer {
  public:
   /*! Constant folding will not be applied to nodes that have one of initializers from excluded_initializers as input.
       For pre-training, the trainable weights are those initializers to be excluded.
       \param execution_provider Execution provider instance to execute constant folding.
+      \param intra_op_thread_pool Thread pool to compute independent nodes on. They are computed serially if null.
   */
   ConstantFolding(const IExecutionProvider& execution_provider,
                   bool skip_dequantize_linear,
                   const ConfigOptions& config_options,
                   const InlinedHashSet<std::string_view>& compatible_execution_providers = {},
-                  const InlinedHashSet<std::string>& excluded_initializers = {}) noexcept;
+                  const InlinedHashSet<std::string>& excluded_initializers = {},
+                  concurrency::ThreadPool* intra_op_thread_pool = nullptr) noexcept;
 
  protected:
   /**
@@ -37,7 +43,8 @@ class ConstantFolding : public GraphTransformer {
                   bool skip_dequantize_linear,
                   const ConfigOptions& config_options,
                   const InlinedHashSet<std::string_view>& compatible_execution_providers = {},
-                  const InlinedHashSet<std::string>& excluded_initializers = {}) noexcept;
+                  const InlinedHashSet<std::string>& excluded_initializers = {},
+                  concurrency::ThreadPool* intra_op_thread_pool = nullptr) noexcept;
   /**
    * Derived class can implement this virtual function to limit the nodes that can be constant folded.
    */
@@ -53,6 +60,7 @@ class ConstantFolding : public GraphTransformer {
   const ConfigOptions& config_options_;
   const InlinedHashSet<std::string> excluded_initializers_;
   const IExecutionProvider& execution_provider_;
+  concurrency::ThreadPool* const intra_op_thread_pool_;
 };
 
 }  // namespace onnxruntime
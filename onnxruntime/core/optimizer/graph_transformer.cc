@@ -8,11 +8,7 @@ using namespace ::onnxruntime::common;
 namespace onnxruntime {
 
 Status GraphTransformer::Apply(Graph& graph, bool& modified, const logging::Logger& logger) const {
-  // the Graph should be in a good state prior this being called, so there should be no need to call Resolve here
-  // ORT_RETURN_IF_ERROR(graph.Resolve());
-
-  auto status = ApplyImpl(graph, modified, 0, logger);
-  LOGS(logger, INFO) << "GraphTransformer " << Name() << " modified: " << modified << " with status: " << status;
+  auto status = ApplyWithoutResolve(graph, modified, logger);
   ORT_RETURN_IF_ERROR(status);
 
 #if !defined(ORT_MINIMAL_BUILD)
@@ -26,4 +22,14 @@ Status GraphTransformer::Apply(Graph& graph, bool& modified, const logging::Logg
   return status;
 }
 
+Status GraphTransformer::ApplyWithoutResolve(Graph& graph, bool& modified, const logging::Logger& logger) const {
+  // the Graph should be in a good state prior this being called (resolved, unless this transformer
+  // CanApplyToUnresolvedGraph), so there should be no need to call Resolve here
+  // ORT_RETURN_IF_ERROR(graph.Resolve());
+
+  auto status = ApplyImpl(graph, modified, 0, logger);
+  LOGS(logger, INFO) << "GraphTransformer " << Name() << " modified: " << modified << " with status: " << status;
+  return status;
+}
+
 }  // namespace onnxruntime
@@ -19,6 +19,20 @@ common::Status GraphTransformerManager::GetSteps(unsigned& steps) const {
   return Status::OK();
 }
 
+// Resolves the graph if a transformer modified it without resolving it.
+static common::Status ResolveIfPending(Graph& graph, bool& resolve_pending) {
+#if !defined(ORT_MINIMAL_BUILD)
+  if (resolve_pending) {
+    resolve_pending = false;
+    return graph.Resolve();
+  }
+#else
+  ORT_UNUSED_PARAMETER(graph);
+  resolve_pending = false;
+#endif
+  return Status::OK();
+}
+
 common::Status GraphTransformerManager::ApplyTransformers(Graph& graph, TransformerLevel level,
                                                           const logging::Logger& logger) const {
   const auto& transformers = level_to_transformer_map_.find(level);
@@ -28,14 +42,24 @@ common::Status GraphTransformerManager::ApplyTransformers(Graph& graph, Transfor
 
   for (unsigned step = 0; step < steps_; ++step) {
     bool graph_changed = false;
+    // Consecutive transformers that can be applied to an unresolved graph (the rule-based ones) share a single
+    // Graph::Resolve after the last of them, instead of one after each that modified the graph.
+    bool resolve_pending = false;
     for (const auto& transformer : transformers->second) {
       if (step > 0 && transformer->ShouldOnlyApplyOnce())
         continue;
 
       bool modified = false;
-      ORT_RETURN_IF_ERROR(transformer->Apply(graph, modified, logger));
+      if (transformer->CanApplyToUnresolvedGraph()) {
+        ORT_RETURN_IF_ERROR(transformer->ApplyWithoutResolve(graph, modified, logger));
+        resolve_pending = resolve_pending || modified;
+      } else {
+        ORT_RETURN_IF_ERROR(ResolveIfPending(graph, resolve_pending));
+        ORT_RETURN_IF_ERROR(transformer->Apply(graph, modified, logger));
+      }
       graph_changed = graph_changed || modified;
     }
+    ORT_RETURN_IF_ERROR(ResolveIfPending(graph, resolve_pending));
     if (!graph_changed) {
       break;
     }
@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/onehot_matmul_fusion.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/graph/graph_utils.h"
+#include "core/optimizer/initializer.h"
+
+using namespace ONNX_NAMESPACE;
+namespace onnxruntime {
+
+namespace {
+
+// Reads the scalar depth input of OneHot. Non integer depths are truncated as in the OneHot kernel.
+bool GetConstantDepth(const Graph& graph, const NodeArg& depth_arg, int64_t& depth) {
+  const TensorProto* depth_proto = graph_utils::GetConstantInitializer(graph, depth_arg.Name());
+  if (depth_proto == nullptr) {
+    return false;
+  }
+  Initializer depth_init{*depth_proto, graph.ModelPath()};
+  if (depth_init.size() != 1) {
+    return false;
+  }
+  switch (depth_init.data_type()) {
+    case TensorProto_DataType_INT64:
+      depth = *depth_init.data<int64_t>();
+      break;
+    case TensorProto_DataType_INT32:
+      depth = *depth_init.data<int32_t>();
+      break;
+    case TensorProto_DataType_FLOAT:
+      depth = static_cast<int64_t>(*depth_init.data<float>());
+      break;
+    default:
+      return false;
+  }
+  return depth > 0;
+}
+
+// True if the values input of OneHot is the constant [0, 1].
+bool HasZeroOneValues(const Graph& graph, const NodeArg& values_arg) {
+  const TensorProto* values_proto = graph_utils::GetConstantInitializer(graph, values_arg.Name());
+  if (values_proto == nullptr || values_proto->data_type() != TensorProto_DataType_FLOAT) {
+    return false;
+  }
+  Initializer values_init{*values_proto, graph.ModelPath()};
+  const auto values = values_init.DataAsSpan<float>();
+  return values.size() == 2 && values[0] == 0.f && values[1] == 1.f;
+}
+
+// True if B is a constant float [depth, N] matrix without infinity or NaN. 0 * inf is NaN in the dense product,
+// so only finite matrices give the same result when the zero terms are skipped.
+bool IsFiniteWeightMatrix(const Graph& graph, const NodeArg& b_arg, int64_t depth) {
+  const TensorProto* b_proto = graph_utils::GetConstantInitializer(graph, b_arg.Name());
+  if (b_proto == nullptr || b_proto->data_type() != TensorProto_DataType_FLOAT || b_proto->dims_size() != 2 ||
+      b_proto->dims(0) != depth) {
+    return false;
+  }
+  Initializer b_init{*b_proto, graph.ModelPath()};
+  const auto b = b_init.DataAsSpan<float>();
+  return std::all_of(b.begin(), b.end(), [](float v) { return std::isfinite(v); });
+}
+
+bool HasLastAxis(const Node& onehot, const NodeArg& indices_arg) {
+  const auto* axis_attr = graph_utils::GetNodeAttribute(onehot, "axis");
+  if (axis_attr == nullptr || !utils::HasInt(*axis_attr) || axis_attr->i() == -1) {
+    return true;
+  }
+  const auto* indices_shape = indices_arg.Shape();
+  return indices_shape != nullptr && axis_attr->i() == indices_shape->dim_size();
+}
+
+}  // namespace
+
+Status OneHotMatMulFusion::ApplyImpl(Graph& graph, bool& modified, int graph_level,
+                                     const logging::Logger& logger) const {
+  GraphViewer graph_viewer(graph);
+  const auto& order = graph_viewer.GetNodesInTopologicalOrder();
+
+  for (auto index : order) {
+    auto* node_ptr = graph.GetNode(index);
+    if (!node_ptr)
+      continue;  // node was removed
+
+    auto& node = *node_ptr;
+    ORT_RETURN_IF_ERROR(Recurse(node, modified, graph_level, logger));
+
+    if (!graph_utils::IsSupportedOptypeVersionAndDomain(node, "OneHot", {9, 11}) ||
+        !graph_utils::IsSupportedProvider(node, GetCompatibleExecutionProviders()) ||
+        node.GetOutputEdgesCount() != 1 || graph.NodeProducesGraphOutput(node)) {
+      continue;
+    }
+
+    const Node& next_node = *(node.OutputNodesBegin());
+    if (!graph_utils::IsSupportedOptypeVersionAndDomain(next_node, "MatMul", {1, 9, 13}) ||
+        next_node.GetExecutionProviderType() != node.GetExecutionProviderType() ||
+        next_node.InputDefs()[0] != node.OutputDefs()[0]) {
+      continue;
+    }
+
+    const NodeArg& indices_arg = *node.InputDefs()[0];
+    const auto* indices_type = indices_arg.TypeAsProto();
+    if (indices_type == nullptr ||
+        (indices_type->tensor_type().elem_type() != TensorProto_DataType_INT64 &&
+         indices_type->tensor_type().elem_type() != TensorProto_DataType_INT32) ||
+        !HasLastAxis(node, indices_arg)) {
+      continue;
+    }
+
+    int64_t depth = 0;
+    if (!GetConstantDepth(graph, *node.InputDefs()[1], depth) || !HasZeroOneValues(graph, *node.InputDefs()[2]) ||
+        !IsFiniteWeightMatrix(graph, *next_node.InputDefs()[1], depth)) {
+      continue;
+    }
+
+    Node& onehot_node = node;
+    Node& matmul_node = *graph.GetNode(next_node.Index());  // get mutable reference
+
+    InlinedVector<NodeArg*> fused_inputs{onehot_node.MutableInputDefs()[0], matmul_node.MutableInputDefs()[1]};
+    Node& fused_node = graph.AddNode(graph.GenerateNodeName("fused " + matmul_node.Name()), "OneHotMatMul",
+                                     "fused OneHot " + onehot_node.Name() + " with MatMul " + matmul_node.Name(),
+                                     fused_inputs, {}, nullptr, kMSDomain);
+    fused_node.SetExecutionProviderType(matmul_node.GetExecutionProviderType());
+
+    // move the indices edge of onehot_node and the output of matmul_node to fused_node,
+    // delete onehot_node and matmul_node.
+    graph_utils::FinalizeNodeFusion(graph, {onehot_node, matmul_node}, fused_node);
+
+    modified = true;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
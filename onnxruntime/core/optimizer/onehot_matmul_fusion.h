@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class OneHotMatMulFusion
+
+Fuses OneHot(indices, depth, values=[0, 1], axis=-1) -> MatMul(., B) into com.microsoft.OneHotMatMul(indices, B),
+which copies one row of B per index instead of multiplying B by a mostly zero [..., depth] tensor.
+B must be a constant float matrix of shape [depth, N] with finite values, so the gathered rows are exactly
+the rows of the dense product.
+*/
+class OneHotMatMulFusion : public GraphTransformer {
+ public:
+  OneHotMatMulFusion(const InlinedHashSet<std::string_view>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("OneHotMatMulFusion", compatible_execution_providers) {}
+
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+};
+
+}  // namespace onnxruntime
@@ -0,0 +1,473 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/symbolic_shape_folding.h"
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "core/framework/tensorprotoutils.h"
+#include "core/graph/graph_utils.h"
+#include "core/optimizer/utils.h"
+
+using namespace ONNX_NAMESPACE;
+using namespace onnxruntime::common;
+namespace onnxruntime {
+
+namespace {
+
+// The values of larger int64 tensors are not tracked.
+constexpr size_t kMaxShapeValueSize = 64;
+
+// An element of a shape tensor.
+struct SymbolicDim {
+  std::optional<int64_t> value;
+  // the tensor and axis a Shape node read the dimension from, when the value is not known
+  const NodeArg* source = nullptr;
+  int64_t axis = -1;
+  // the dim_param of the dimension, if any
+  std::string symbol;
+};
+
+// The value of an int64 scalar or 1-D tensor.
+struct ShapeValue {
+  InlinedVector<SymbolicDim> dims;
+  bool is_scalar = false;
+
+  bool IsKnown() const {
+    return std::all_of(dims.begin(), dims.end(), [](const SymbolicDim& dim) { return dim.value.has_value(); });
+  }
+};
+
+// node-based so the values stay at the same address as others are added
+using ShapeValueMap = std::unordered_map<const NodeArg*, ShapeValue>;
+
+const ShapeValue* GetShapeValue(const Graph& graph, const NodeArg* arg, ShapeValueMap& values) {
+  if (arg == nullptr || !arg->Exists()) {
+    return nullptr;
+  }
+
+  if (auto it = values.find(arg); it != values.end()) {
+    return &it->second;
+  }
+
+  const TensorProto* initializer = graph_utils::GetConstantInitializer(graph, arg->Name());
+  if (initializer == nullptr || initializer->data_type() != TensorProto_DataType_INT64 ||
+      initializer->dims_size() > 1) {
+    return nullptr;
+  }
+
+  InlinedVector<int64_t> data;
+  if (!optimizer_utils::AppendTensorFromInitializer(graph, *arg, data) || data.size() > kMaxShapeValueSize) {
+    return nullptr;
+  }
+
+  ShapeValue value;
+  value.is_scalar = initializer->dims_size() == 0;
+  for (int64_t element : data) {
+    value.dims.push_back(SymbolicDim{element});
+  }
+  return &values.emplace(arg, std::move(value)).first->second;
+}
+
+int64_t GetIntAttribute(const Node& node, const std::string& name, int64_t default_value) {
+  const auto* attr = graph_utils::GetNodeAttribute(node, name);
+  return attr != nullptr && utils::HasInt(*attr) ? attr->i() : default_value;
+}
+
+// Axes of a Squeeze or Unsqueeze node, from the attribute or the input depending on the opset.
+bool GetAxes(const Graph& graph, const Node& node, InlinedVector<int64_t>& axes) {
+  if (node.SinceVersion() < 13) {
+    return graph_utils::GetRepeatedNodeAttributeValues(node, "axes", axes);
+  }
+  const auto& inputs = node.InputDefs();
+  return inputs.size() > 1 && inputs[1]->Exists() && optimizer_utils::AppendTensorFromInitializer(graph, *inputs[1], axes);
+}
+
+bool IsFirstAxis(gsl::span<const int64_t> axes) {
+  return axes.size() == 1 && (axes[0] == 0 || axes[0] == -1);
+}
+
+// Clamps a Shape or Slice bound to [0, size], counting negative values from the end.
+int64_t ClampIndex(int64_t index, int64_t size) {
+  index = index < 0 ? index + size : index;
+  return std::clamp<int64_t>(index, 0, size);
+}
+
+std::optional<ShapeValue> GetShapeNodeValue(const Node& node) {
+  const NodeArg* input = node.InputDefs()[0];
+  const auto* shape = input->Shape();
+  if (shape == nullptr) {
+    return std::nullopt;
+  }
+
+  // Shape-15 selects a range of the axes with the 'start' and 'end' attributes
+  const int64_t rank = shape->dim_size();
+  const int64_t start = ClampIndex(GetIntAttribute(node, "start", 0), rank);
+  const int64_t end = ClampIndex(GetIntAttribute(node, "end", rank), rank);
+
+  ShapeValue value;
+  for (int64_t axis = start; axis < end; ++axis) {
+    const auto& dim = shape->dim(static_cast<int>(axis));
+    SymbolicDim symbolic_dim;
+    if (utils::HasDimValue(dim)) {
+      symbolic_dim.value = dim.dim_value();
+    } else {
+      symbolic_dim.source = input;
+      symbolic_dim.axis = axis;
+      if (utils::HasDimParam(dim)) {
+        symbolic_dim.symbol = dim.dim_param();
+      }
+    }
+    value.dims.push_back(std::move(symbolic_dim));
+  }
+  return value;
+}
+
+std::optional<ShapeValue> GetGatherValue(const Node& node, const ShapeValue* data, const ShapeValue* indices) {
+  const int64_t axis = GetIntAttribute(node, "axis", 0);
+  if (data == nullptr || data->is_scalar || indices == nullptr || !indices->IsKnown() || (axis != 0 && axis != -1)) {
+    return std::nullopt;
+  }
+
+  const int64_t size = static_cast<int64_t>(data->dims.size());
+  ShapeValue value;
+  value.is_scalar = indices->is_scalar;
+  for (const auto& index_dim : indices->dims) {
+    const int64_t index = *index_dim.value < 0 ? *index_dim.value + size : *index_dim.value;
+    if (index < 0 || index >= size) {
+      return std::nullopt;
+    }
+    value.dims.push_back(data->dims[static_cast<size_t>(index)]);
+  }
+  return value;
+}
+
+std::optional<ShapeValue> GetSliceValue(const Graph& graph, const Node& node,
+                                        gsl::span<const ShapeValue* const> inputs) {
+  // Slice-1 has the bounds in attributes, which exporters don't produce for shape computations anymore
+  if (node.SinceVersion() < 10 || inputs.size() < 3) {
+    return std::nullopt;
+  }
+
+  const ShapeValue* data = inputs[0];
+  const ShapeValue* starts = inputs[1];
+  const ShapeValue* ends = inputs[2];
+  if (data == nullptr || data->is_scalar || starts == nullptr || !starts->IsKnown() || starts->dims.size() != 1 ||
+      ends == nullptr || !ends->IsKnown() || ends->dims.size() != 1) {
+    return std::nullopt;
+  }
+
+  const auto& input_defs = node.InputDefs();
+  InlinedVector<int64_t> axes;
+  if (input_defs.size() > 3 && input_defs[3]->Exists() &&
+      (!optimizer_utils::AppendTensorFromInitializer(graph, *input_defs[3], axes) || !IsFirstAxis(axes))) {
+    return std::nullopt;
+  }
+  InlinedVector<int64_t> steps;
+  if (input_defs.size() > 4 && input_defs[4]->Exists() &&
+      (!optimizer_utils::AppendTensorFromInitializer(graph, *input_defs[4], steps) || steps.size() != 1 ||
+       steps[0] != 1)) {
+    return std::nullopt;
+  }
+
+  const int64_t size = static_cast<int64_t>(data->dims.size());
+  const int64_t start = ClampIndex(*starts->dims[0].value, size);
+  const int64_t end = ClampIndex(*ends->dims[0].value, size);
+  ShapeValue value;
+  for (int64_t i = start; i < end; ++i) {
+    value.dims.push_back(data->dims[static_cast<size_t>(i)]);
+  }
+  return value;
+}
+
+// x op y for Add, Sub, Mul or Div, or nullopt if it divides by zero or overflows int64, in which case the value
+// the node computes at runtime is not folded.
+std::optional<int64_t> ComputeArithmetic(const std::string& op_type, int64_t x, int64_t y) {
+  constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+  constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+  if (op_type == "Add") {
+    if ((y > 0 && x > kMax - y) || (y < 0 && x < kMin - y)) {
+      return std::nullopt;
+    }
+    return x + y;
+  }
+  if (op_type == "Sub") {
+    if ((y < 0 && x > kMax + y) || (y > 0 && x < kMin + y)) {
+      return std::nullopt;
+    }
+    return x - y;
+  }
+  if (op_type == "Mul") {
+    if (x != 0 && y != 0) {
+      const bool overflows = x > 0 ? (y > 0 ? x > kMax / y : y < kMin / x)
+                                   : (y > 0 ? x < kMin / y : x < kMax / y);
+      if (overflows) {
+        return std::nullopt;
+      }
+    }
+    return x * y;
+  }
+  if (y == 0 || (x == kMin && y == -1)) {
+    return std::nullopt;
+  }
+  return x / y;
+}
+
+// Add, Sub, Mul and Div of int64 values. Elements that are not both known are only kept when the other operand
+// leaves them unchanged.
+std::optional<ShapeValue> GetArithmeticValue(const std::string& op_type, const ShapeValue* a, const ShapeValue* b) {
+  if (a == nullptr || b == nullptr || a->dims.empty() || b->dims.empty() ||
+      (a->dims.size() != b->dims.size() && a->dims.size() != 1 && b->dims.size() != 1)) {
+    return std::nullopt;
+  }
+
+  ShapeValue value;
+  value.is_scalar = a->is_scalar && b->is_scalar;
+  const size_t size = std::max(a->dims.size(), b->dims.size());
+  for (size_t i = 0; i < size; ++i) {
+    const SymbolicDim& x = a->dims[a->dims.size() == 1 ? 0 : i];
+    const SymbolicDim& y = b->dims[b->dims.size() == 1 ? 0 : i];
+    if (x.value.has_value() && y.value.has_value()) {
+      std::optional<int64_t> result = ComputeArithmetic(op_type, *x.value, *y.value);
+      if (!result.has_value()) {
+        return std::nullopt;
+      }
+      value.dims.push_back(SymbolicDim{result});
+    } else if (y.value.has_value() && ((*y.value == 0 && (op_type == "Add" || op_type == "Sub")) ||
+                                       (*y.value == 1 && (op_type == "Mul" || op_type == "Div")))) {
+      value.dims.push_back(x);
+    } else if (x.value.has_value() && ((*x.value == 0 && op_type == "Add") || (*x.value == 1 && op_type == "Mul"))) {
+      value.dims.push_back(y);
+    } else {
+      value.dims.push_back(SymbolicDim{});
+    }
+  }
+  return value;
+}
+
+// The value of the output of a node that computes on shapes, or nullopt if it is not one or its inputs are unknown.
+std::optional<ShapeValue> ComputeShapeValue(const Graph& graph, const Node& node, ShapeValueMap& values) {
+  if (node.Domain() != kOnnxDomain || node.OutputDefs().size() != 1) {
+    return std::nullopt;
+  }
+
+  const std::string& op_type = node.OpType();
+  if (op_type == "Shape") {
+    return GetShapeNodeValue(node);
+  }
+
+  const auto& input_defs = node.InputDefs();
+  InlinedVector<const ShapeValue*> inputs;
+  for (const NodeArg* input_def : input_defs) {
+    inputs.push_back(GetShapeValue(graph, input_def, values));
+  }
+  if (inputs.empty() || inputs[0] == nullptr) {
+    return std::nullopt;
+  }
+
+  if (op_type == "Identity" ||
+      (op_type == "Cast" && GetIntAttribute(node, "to", TensorProto_DataType_UNDEFINED) == TensorProto_DataType_INT64)) {
+    return *inputs[0];
+  }
+
+  if (op_type == "Gather") {
+    return GetGatherValue(node, inputs[0], inputs.size() > 1 ? inputs[1] : nullptr);
+  }
+
+  if (op_type == "Unsqueeze" || op_type == "Squeeze") {
+    const bool unsqueeze = op_type == "Unsqueeze";
+    InlinedVector<int64_t> axes;
+    const bool has_axes = GetAxes(graph, node, axes);
+    ShapeValue value = *inputs[0];
+    if (unsqueeze && value.is_scalar && has_axes && IsFirstAxis(axes)) {
+      value.is_scalar = false;
+      return value;
+    }
+    if (!unsqueeze && !value.is_scalar && value.dims.size() == 1 && (!has_axes || IsFirstAxis(axes))) {
+      value.is_scalar = true;
+      return value;
+    }
+    return std::nullopt;
+  }
+
+  if (op_type == "Concat") {
+    const int64_t axis = GetIntAttribute(node, "axis", 0);
+    if (axis != 0 && axis != -1) {
+      return std::nullopt;
+    }
+    ShapeValue value;
+    for (const ShapeValue* input : inputs) {
+      if (input == nullptr || input->is_scalar) {
+        return std::nullopt;
+      }
+      value.dims.insert(value.dims.end(), input->dims.begin(), input->dims.end());
+    }
+    if (value.dims.size() > kMaxShapeValueSize) {
+      return std::nullopt;
+    }
+    return value;
+  }
+
+  if (op_type == "Slice") {
+    return GetSliceValue(graph, node, inputs);
+  }
+
+  if (op_type == "Add" || op_type == "Sub" || op_type == "Mul" || op_type == "Div") {
+    return GetArithmeticValue(op_type, inputs[0], inputs.size() > 1 ? inputs[1] : nullptr);
+  }
+
+  return std::nullopt;
+}
+
+// Converts the value of the shape input of a Reshape to a constant shape. A dimension that is equal to the dimension
+// of the data input at the same axis becomes 0, which Reshape copies from the input, and at most one dimension that
+// is not known otherwise becomes -1, which Reshape infers from the size of the input.
+bool GetConstantReshapeShape(const NodeArg& data, const ShapeValue& shape_value, InlinedVector<int64_t>& shape) {
+  if (shape_value.is_scalar) {
+    return false;
+  }
+
+  const auto* data_shape = data.Shape();
+  bool has_inferred_dim = false;
+  for (size_t i = 0; i < shape_value.dims.size(); ++i) {
+    const SymbolicDim& dim = shape_value.dims[i];
+    if (dim.value.has_value()) {
+      if (*dim.value == -1) {
+        if (has_inferred_dim) {
+          return false;
+        }
+        has_inferred_dim = true;
+      }
+      shape.push_back(*dim.value);
+      continue;
+    }
+
+    const bool same_as_input =
+        (dim.source == &data && dim.axis == static_cast<int64_t>(i)) ||
+        (!dim.symbol.empty() && data_shape != nullptr && static_cast<int>(i) < data_shape->dim_size() &&
+         data_shape->dim(static_cast<int>(i)).dim_param() == dim.symbol);
+    if (same_as_input) {
+      shape.push_back(0);
+    } else if (!has_inferred_dim) {
+      has_inferred_dim = true;
+      shape.push_back(-1);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+TensorProto CreateInt64Initializer(const std::string& name, gsl::span<const int64_t> data, bool is_scalar) {
+  TensorProto initializer;
+  initializer.set_name(name);
+  initializer.set_data_type(TensorProto_DataType_INT64);
+  if (!is_scalar) {
+    initializer.add_dims(static_cast<int64_t>(data.size()));
+  }
+  utils::SetRawDataInTensorProto(initializer, data.data(), data.size() * sizeof(int64_t));
+  return initializer;
+}
+
+// Removes the nodes that don't have any consumers anymore, with the nodes that only fed them.
+void RemoveUnusedNodes(Graph& graph, gsl::span<const NodeIndex> node_indices) {
+  for (NodeIndex node_index : node_indices) {
+    const Node* node = graph.GetNode(node_index);
+    if (node != nullptr && node->GetOutputEdgesCount() == 0 && !graph.NodeProducesGraphOutput(*node)) {
+      graph_utils::RemoveNodesWithOneOutputBottomUp(graph, *node);
+    }
+  }
+}
+
+InlinedVector<NodeIndex> GetInputNodeIndices(const Node& node) {
+  InlinedVector<NodeIndex> input_nodes;
+  for (auto it = node.InputNodesBegin(), end = node.InputNodesEnd(); it != end; ++it) {
+    input_nodes.push_back(it->Index());
+  }
+  return input_nodes;
+}
+
+}  // namespace
+
+Status SymbolicShapeFolding::ApplyImpl(Graph& graph, bool& modified, int graph_level,
+                                       const logging::Logger& logger) const {
+  GraphViewer graph_viewer(graph);
+  const auto& node_topology_list = graph_viewer.GetNodesInTopologicalOrder();
+
+  ShapeValueMap values;
+  int folded_count = 0;
+  for (auto node_index : node_topology_list) {
+    auto* p_node = graph.GetNode(node_index);
+    if (p_node == nullptr) {
+      continue;  // we removed the node as part of an earlier fold
+    }
+
+    Node& node = *p_node;
+    ORT_RETURN_IF_ERROR(Recurse(node, modified, graph_level, logger));
+
+    if (!graph_utils::IsSupportedProvider(node, GetCompatibleExecutionProviders())) {
+      continue;
+    }
+
+    if (graph_utils::IsSupportedOptypeVersionAndDomain(node, "Reshape", {5, 13, 14, 19, 21}) &&
+        GetIntAttribute(node, "allowzero", 0) == 0) {
+      NodeArg& shape_arg = *node.MutableInputDefs()[1];
+      const ShapeValue* shape_value = nullptr;
+      InlinedVector<int64_t> shape;
+      if (!graph_utils::IsConstantInitializer(graph, shape_arg.Name()) &&
+          (shape_value = GetShapeValue(graph, &shape_arg, values)) != nullptr &&
+          GetConstantReshapeShape(*node.InputDefs()[0], *shape_value, shape)) {
+        const InlinedVector<NodeIndex> input_nodes = GetInputNodeIndices(node);
+        for (auto it = node.InputEdgesBegin(), end = node.InputEdgesEnd(); it != end; ++it) {
+          if (it->GetDstArgIndex() == 1) {
+            graph.RemoveEdge(it->GetNode().Index(), node.Index(), it->GetSrcArgIndex(), 1);
+            break;
+          }
+        }
+
+        NodeArg& new_shape_arg = graph_utils::AddInitializer(
+            graph, CreateInt64Initializer(graph.GenerateNodeArgName(shape_arg.Name()), shape, false));
+        graph_utils::ReplaceNodeInput(node, 1, new_shape_arg);
+        RemoveUnusedNodes(graph, input_nodes);
+        ++folded_count;
+        modified = true;
+      }
+      continue;
+    }
+
+    std::optional<ShapeValue> value = ComputeShapeValue(graph, node, values);
+    if (!value.has_value()) {
+      continue;
+    }
+
+    const NodeArg* output = node.OutputDefs()[0];
+    if (value->IsKnown() && graph_utils::CanReplaceNodeWithInitializer(graph, node, output->Name(), logger)) {
+      InlinedVector<int64_t> data;
+      for (const auto& dim : value->dims) {
+        data.push_back(*dim.value);
+      }
+
+      const InlinedVector<NodeIndex> input_nodes = GetInputNodeIndices(node);
+      NodeArg& new_arg = graph_utils::AddInitializer(graph, CreateInt64Initializer(output->Name(), data,
+                                                                                   value->is_scalar));
+      graph_utils::ReplaceNodeWithInitializer(graph, node, new_arg);
+      RemoveUnusedNodes(graph, input_nodes);
+      ++folded_count;
+      modified = true;
+    }
+
+    values.emplace(output, std::move(*value));
+  }
+
+  if (folded_count > 0) {
+    LOGS(logger, INFO) << "Total folded shape computation count: " << folded_count;
+  }
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class SymbolicShapeFolding
+
+Rewrite graph folding the small subgraphs that compute tensor shapes at run time from Shape nodes
+(Shape -> Gather/Slice -> Unsqueeze -> Concat -> Reshape and similar).
+
+The values of these int64 tensors are tracked symbolically from the inferred shapes of the graph: every element is
+either a known value or a dimension of a tensor, identified by the tensor and axis it was read from and by its
+symbolic name (dim_param). Then:
+  - a node whose value is fully known is replaced with an initializer.
+  - the shape input of a Reshape is replaced with a constant shape, using 0 for the dimensions that are equal to the
+    dimension at the same axis of the data input, and -1 for at most one dimension that is not known otherwise.
+The nodes that only computed these values are removed.
+*/
+class SymbolicShapeFolding : public GraphTransformer {
+ public:
+  SymbolicShapeFolding(const InlinedHashSet<std::string_view>& compatible_execution_providers = {}) noexcept
+      : GraphTransformer("SymbolicShapeFolding", compatible_execution_providers) {}
+
+ private:
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+};
+
+}  // namespace onnxruntime
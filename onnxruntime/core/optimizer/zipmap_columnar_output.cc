@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "core/optimizer/zipmap_columnar_output.h"
+
+#include <algorithm>
+
+#include "core/graph/graph_utils.h"
+
+using namespace ONNX_NAMESPACE;
+namespace onnxruntime {
+
+// Builds the constant holding the labels of a ZipMap node. Returns false if the node has no label attribute.
+static bool MakeLabelsTensor(const Node& node, const std::string& name, TensorProto& labels) {
+  labels.set_name(name);
+  const auto* strings = graph_utils::GetNodeAttribute(node, "classlabels_strings");
+  if (strings != nullptr && strings->strings_size() > 0) {
+    labels.set_data_type(TensorProto_DataType_STRING);
+    labels.add_dims(strings->strings_size());
+    *labels.mutable_string_data() = strings->strings();
+    return true;
+  }
+  const auto* ints = graph_utils::GetNodeAttribute(node, "classlabels_int64s");
+  if (ints != nullptr && ints->ints_size() > 0) {
+    labels.set_data_type(TensorProto_DataType_INT64);
+    labels.add_dims(ints->ints_size());
+    *labels.mutable_int64_data() = ints->ints();
+    return true;
+  }
+  return false;
+}
+
+Status ZipMapColumnarOutput::ApplyImpl(Graph& graph, bool& modified, int /*graph_level*/,
+                                       const logging::Logger& logger) const {
+  // The outputs of a subgraph are defined by the node holding it.
+  if (graph.IsSubgraph()) {
+    return Status::OK();
+  }
+
+  std::vector<const NodeArg*> outputs = graph.GetOutputs();
+  InlinedVector<NodeIndex> nodes_to_remove;
+  for (auto& node : graph.Nodes()) {
+    if (!graph_utils::IsSupportedOptypeVersionAndDomain(node, "ZipMap", {1}, kMLDomain) ||
+        node.GetOutputEdgesCount() != 0) {
+      continue;
+    }
+
+    const NodeArg* zipmap_output = node.OutputDefs()[0];
+    auto output_it = std::find(outputs.begin(), outputs.end(), zipmap_output);
+    const NodeArg* zipmap_input = node.InputDefs()[0];
+    // The probabilities must come from a node and must not already be an output of the graph.
+    if (output_it == outputs.end() || graph.GetProducerNode(zipmap_input->Name()) == nullptr ||
+        std::find(outputs.begin(), outputs.end(), zipmap_input) != outputs.end()) {
+      continue;
+    }
+
+    TensorProto labels;
+    if (!MakeLabelsTensor(node, graph.GenerateNodeArgName(zipmap_output->Name() + "_labels"), labels)) {
+      continue;
+    }
+    NodeArg& labels_arg = graph_utils::AddInitializer(graph, labels);
+
+    *output_it = zipmap_input;
+    outputs.insert(output_it + 1, &labels_arg);
+    nodes_to_remove.push_back(node.Index());
+  }
+
+  if (nodes_to_remove.empty()) {
+    return Status::OK();
+  }
+
+  for (NodeIndex index : nodes_to_remove) {
+    graph.RemoveNode(index);
+  }
+  graph.SetOutputs(outputs);
+  modified = true;
+  LOGS(logger, INFO) << "Replaced " << nodes_to_remove.size() << " ZipMap output(s) with probability tensors.";
+
+  return Status::OK();
+}
+
+}  // namespace onnxruntime
@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include "core/optimizer/graph_transformer.h"
+
+namespace onnxruntime {
+
+/**
+@Class ZipMapColumnarOutput
+
+Removes the ZipMap nodes producing an output of the main graph. The output Z (a sequence of maps with one map per
+row) is replaced by the input X of ZipMap, a [N, C] float tensor, followed by a new output named Z + "_labels"
+holding the C class labels of the ZipMap attributes as a constant int64 or string tensor.
+This changes the outputs of the model so it only runs when kOrtSessionOptionsZipMapColumnarOutput is enabled.
+*/
+class ZipMapColumnarOutput : public GraphTransformer {
+ public:
+  ZipMapColumnarOutput() noexcept : GraphTransformer("ZipMapColumnarOutput") {}
+
+  Status ApplyImpl(Graph& graph, bool& modified, int graph_level, const logging::Logger& logger) const override;
+};
+
+}  // namespace onnxruntime
@@ -255,9 +255,6 @@ common::Status If::SetupSubgraphExecutionInfo(const SessionState& session_state,
 }
 
 Status If::Compute(OpKernelContext* ctx) const {
-  ORT_ENFORCE(then_feeds_fetches_manager_ && else_feeds_fetches_manager_,
-              "CreateFeedsFetchesManager must be called prior to execution of graph.");
-
   auto ctx_internal = static_cast<OpKernelContextInternal*>(ctx);
 
   const auto& condition_tensor = *ctx->Input<Tensor>(0);
@@ -268,22 +265,24 @@ Status If::Compute(OpKernelContext* ctx) const {
   auto condition = *condition_tensor.Data<bool>();
 
   auto attribute = condition ? "then_branch" : "else_branch";
+
+  // the branch may be initialized by its first execution (see kOrtSessionOptionsLazySubgraphInitialization),
+  // which sets up the info for it. the other branch may be initialized concurrently so only this branch's is used.
+  ORT_RETURN_IF_ERROR(ctx_internal->FinalizeDeferredSubgraphSessionState(attribute));
+
   auto* session_state = ctx_internal->SubgraphSessionState(attribute);
   ORT_ENFORCE(session_state, "Subgraph SessionState was not found for '", attribute, "' attribute.");
 
   const auto& info = condition ? then_info_ : else_info_;
+  const auto& feeds_fetches_manager = condition ? then_feeds_fetches_manager_ : else_feeds_fetches_manager_;
+  ORT_ENFORCE(info && feeds_fetches_manager, "CreateFeedsFetchesManager must be called prior to execution of graph.");
+
   IfImpl impl{*ctx_internal, *session_state, *info};
 
   auto status = impl.Initialize();
   ORT_RETURN_IF_ERROR(status);
 
-  if (condition) {
-    status = impl.Execute(*then_feeds_fetches_manager_);
-  } else {
-    status = impl.Execute(*else_feeds_fetches_manager_);
-  }
-
-  return status;
+  return impl.Execute(*feeds_fetches_manager);
 }
 
 IfImpl::IfImpl(OpKernelContextInternal& context,
@@ -2,10 +2,13 @@
 // Licensed under the MIT License.
 
 #pragma once
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <vector>
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/ml/lookup_table.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -16,24 +19,56 @@ class DictVectorizerOp final : public OpKernel {
     // In some stupid models, the vocabulary could have duplicated elements.
     // We must support that, otherwise some tests will be break.
     ORT_ENFORCE(info.GetAttrs(std::is_same<AttrType, std::string>::value ? "string_vocabulary" : "int64_vocabulary", vocabulary_).IsOK());
+
+    // positions_ maps a key to its first position in the vocabulary, next_position_ chains the duplicates.
+    positions_.Reserve(vocabulary_.size());
+    next_position_.assign(vocabulary_.size(), kNoPosition);
+    for (size_t i = vocabulary_.size(); i-- > 0;) {
+      const size_t* next = positions_.Find(vocabulary_[i]);
+      if (next != nullptr) {
+        next_position_[i] = *next;
+      }
+      positions_.Insert(vocabulary_[i], i, true);
+    }
+    positions_.Finalize();
   }
+
   common::Status Compute(OpKernelContext* ctx) const override {
     const auto* map = ctx->Input<std::map<AttrType, TargetType> >(0);
     auto* Y = ctx->Output(0, {1, static_cast<int64_t>(vocabulary_.size())});
     auto* y_data = Y->MutableData<TargetType>();
-    for (size_t i = 0, end = vocabulary_.size(); i < end; ++i) {
-      auto index = map->find(vocabulary_[i]);
-      if (index != map->end()) {
-        *y_data++ = index->second;
-      } else {
-        // Any keys not present in the input dictionary, will be zero in the output array
-        *y_data++ = TargetType();
+    if (map->size() > vocabulary_.size()) {
+      for (size_t i = 0, end = vocabulary_.size(); i < end; ++i) {
+        auto index = map->find(vocabulary_[i]);
+        if (index != map->end()) {
+          *y_data++ = index->second;
+        } else {
+          // Any keys not present in the input dictionary, will be zero in the output array
+          *y_data++ = TargetType();
+        }
+      }
+      return Status::OK();
+    }
+
+    // The dictionary is usually much smaller than a wide vocabulary: only its entries are written
+    // over the zeroed output instead of searching the dictionary for every word of the vocabulary.
+    std::fill_n(y_data, vocabulary_.size(), TargetType());
+    for (const auto& entry : *map) {
+      const size_t* position = positions_.Find(entry.first);
+      for (size_t i = position == nullptr ? kNoPosition : *position; i != kNoPosition; i = next_position_[i]) {
+        y_data[i] = entry.second;
       }
     }
     return Status::OK();
   }
 
   std::vector<AttrType> vocabulary_;
+
+ private:
+  static constexpr size_t kNoPosition = std::numeric_limits<size_t>::max();
+
+  LookupTable<AttrType, size_t> positions_;
+  std::vector<size_t> next_position_;
 };
 
 }  // namespace ml
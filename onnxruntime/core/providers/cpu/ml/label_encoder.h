@@ -5,6 +5,7 @@
 #include <filesystem>
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/ml/lookup_table.h"
 #include "core/providers/cpu/ml/ml_common.h"
 #include "core/framework/tensorprotoutils.h"
 #include "core/common/safeint.h"
@@ -24,22 +25,24 @@ class LabelEncoder final : public OpKernel {
 
     auto num_entries = string_classes.size();
 
-    string_to_int_map_.reserve(num_entries);
-    int_to_string_map_.reserve(num_entries);
+    string_to_int_map_.Reserve(num_entries);
+    int_to_string_map_.Reserve(num_entries);
 
     for (size_t i = 0; i < num_entries; ++i) {
       const std::string& str = string_classes[i];
 
-      string_to_int_map_[str] = i;
-      int_to_string_map_[i] = str;
+      string_to_int_map_.Insert(str, static_cast<int64_t>(i), true);
+      int_to_string_map_.Insert(static_cast<int64_t>(i), str, true);
     }
+    string_to_int_map_.Finalize();
+    int_to_string_map_.Finalize();
   }
 
   Status Compute(OpKernelContext* context) const override;
 
  private:
-  std::unordered_map<std::string, int64_t> string_to_int_map_;
-  std::unordered_map<int64_t, std::string> int_to_string_map_;
+  LookupTable<std::string, int64_t> string_to_int_map_;
+  LookupTable<int64_t, std::string> int_to_string_map_;
 
   std::string default_string_;
   int64_t default_int_;
@@ -63,8 +66,9 @@ class LabelEncoder_2 final : public OpKernel {
     ORT_ENFORCE(num_keys == num_values, "The ", key_field_name_, " and ", value_field_name_,
                 " attributes in LabelEncoder ", "(name: ", info.node().Name(), ") must have the same length. ",
                 "However, the number of key is ", num_keys, " and the number of ", "values is ", num_values, ".");
-    map_.reserve(num_keys);
-    for (size_t i = 0; i < num_keys; ++i) map_.emplace(keys[i], values[i]);
+    map_.Reserve(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) map_.Insert(keys[i], values[i], false);
+    map_.Finalize();
   }
 
   Status Compute(OpKernelContext* context) const override {
@@ -72,16 +76,8 @@ class LabelEncoder_2 final : public OpKernel {
     const TensorShape& shape = X->Shape();
     auto* Y = context->Output(0, shape);
 
-    auto input = X->template DataAsSpan<TKey>();
-    auto output = Y->template MutableDataAsSpan<TValue>();
-    auto input_iter = input.begin();
-    auto output_iter = output.begin();
-    while (input_iter != input.end()) {
-      const auto found = map_.find(*input_iter);
-      *output_iter = found == map_.end() ? default_value_ : found->second;
-      ++output_iter;
-      ++input_iter;
-    }
+    map_.Transform(context->GetOperatorThreadPool(), X->template DataAsSpan<TKey>(),
+                   Y->template MutableDataAsSpan<TValue>(), default_value_);
     return Status::OK();
   }
 
@@ -94,7 +90,7 @@ class LabelEncoder_2 final : public OpKernel {
   // A collection of key-value pairs. Each (a_key, a_value) pair
   // means that the "a_key" in the input would be mapped to "a_value".
   // If map_ doesn't contain "a_key", we use default_value_ as its output.
-  InlinedHashMap<TKey, TValue> map_;
+  LookupTable<TKey, TValue> map_;
   TValue default_value_;
   // ONNX attribute name to load keys.
   std::string key_field_name_;
@@ -202,31 +198,25 @@ class LabelEncoder_4 final : public OpKernel {
     auto keys = GetAttribute<TKey>(kernel_info, key_field_name_, "keys_tensor");
     auto values = GetAttribute<TValue>(kernel_info, value_field_name_, "values_tensor");
     ORT_ENFORCE(keys.size() == values.size(), "Keys and values must have the same length.");
+    map_.Reserve(keys.size());
     for (size_t i = 0; i < keys.size(); ++i) {
-      map_.emplace(keys[i], values[i]);
+      map_.Insert(keys[i], values[i], false);
     }
+    map_.Finalize();
   }
   Status Compute(OpKernelContext* context) const override {
     const auto* X = context->Input<Tensor>(0);
     const TensorShape& shape = X->Shape();
     auto* Y = context->Output(0, shape);
 
-    auto input = X->template DataAsSpan<TKey>();
-    auto output = Y->template MutableDataAsSpan<TValue>();
-    auto input_iter = input.begin();
-    auto output_iter = output.begin();
-    while (input_iter != input.end()) {
-      const auto found = map_.find(*input_iter);
-      *output_iter = found == map_.end() ? default_value_ : found->second;
-      ++output_iter;
-      ++input_iter;
-    }
+    map_.Transform(context->GetOperatorThreadPool(), X->template DataAsSpan<TKey>(),
+                   Y->template MutableDataAsSpan<TValue>(), default_value_);
     return Status::OK();
   }
 
  private:
   void InitializeAttrFields(const OpKernelInfo& kernel_info);
-  HashMap<TKey, TValue, NaNHash<TKey>, NaNEqual<TKey>> map_;
+  LookupTable<TKey, TValue, HashMap<TKey, TValue, NaNHash<TKey>, NaNEqual<TKey>>> map_;
   TValue default_value_;
   std::string key_field_name_;
   std::string value_field_name_;
@@ -0,0 +1,112 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "core/common/common.h"
+#include "core/common/inlined_containers.h"
+#include "core/common/narrow.h"
+#include "core/platform/threadpool.h"
+
+namespace onnxruntime {
+namespace ml {
+
+/**
+ * Immutable key to value table used by the encoders (LabelEncoder, CategoryMapper, OneHotEncoder).
+ * It is filled in the kernel constructor with Insert, then frozen with Finalize.
+ * Entries live in a flat hash map (abseil unless disabled, which also hashes strings faster than std::hash).
+ * Integer keys spanning a small range are additionally indexed by a dense array so that a lookup is a bounds check
+ * and a load. Lookups over a whole input are parallelized with Transform.
+ */
+template <typename TKey, typename TValue, typename Map = InlinedHashMap<TKey, TValue>>
+class LookupTable {
+ public:
+  LookupTable() = default;
+  // dense_ points into map_.
+  ORT_DISALLOW_COPY_AND_ASSIGNMENT(LookupTable);
+
+  void Reserve(size_t size) { map_.reserve(size); }
+
+  // Adds an entry. If the key is already present, its value is only replaced when overwrite is true.
+  void Insert(const TKey& key, const TValue& value, bool overwrite) {
+    if (overwrite) {
+      map_.insert_or_assign(key, value);
+    } else {
+      map_.emplace(key, value);
+    }
+  }
+
+  // Must be called once all entries are inserted. Builds the dense index for integer keys.
+  void Finalize() {
+    dense_.clear();
+    if constexpr (std::is_integral_v<TKey>) {
+      if (map_.empty()) {
+        return;
+      }
+      TKey min_key = std::numeric_limits<TKey>::max();
+      TKey max_key = std::numeric_limits<TKey>::min();
+      for (const auto& entry : map_) {
+        min_key = std::min(min_key, entry.first);
+        max_key = std::max(max_key, entry.first);
+      }
+      // Computed in double to avoid overflowing when the keys span the whole integer range.
+      const double range = static_cast<double>(max_key) - static_cast<double>(min_key) + 1;
+      if (range > static_cast<double>(kDenseSlotsPerEntry * map_.size() + kMinDenseSlots)) {
+        return;
+      }
+      dense_min_ = min_key;
+      dense_.assign(static_cast<size_t>(range), nullptr);
+      for (const auto& entry : map_) {
+        dense_[static_cast<size_t>(entry.first - min_key)] = &entry.second;
+      }
+    }
+  }
+
+  // Returns nullptr if key is not in the table.
+  const TValue* Find(const TKey& key) const {
+    if constexpr (std::is_integral_v<TKey>) {
+      if (!dense_.empty()) {
+        // Unsigned arithmetic folds the two bound checks into one.
+        using UKey = std::make_unsigned_t<TKey>;
+        const UKey offset = static_cast<UKey>(static_cast<UKey>(key) - static_cast<UKey>(dense_min_));
+        return offset < dense_.size() ? dense_[offset] : nullptr;
+      }
+    }
+    auto found = map_.find(key);
+    return found == map_.end() ? nullptr : &found->second;
+  }
+
+  // output[i] = value of input[i], or default_value if input[i] is not in the table.
+  void Transform(concurrency::ThreadPool* thread_pool, gsl::span<const TKey> input, gsl::span<TValue> output,
+                 const TValue& default_value) const {
+    // Hashing and copying strings costs more than the lookup of an integer in the dense array.
+    constexpr double cost = std::is_same_v<TKey, std::string> || std::is_same_v<TValue, std::string> ? 64.0 : 4.0;
+    concurrency::ThreadPool::TryParallelFor(
+        thread_pool, narrow<std::ptrdiff_t>(input.size()),
+        TensorOpCost{static_cast<double>(sizeof(TKey)), static_cast<double>(sizeof(TValue)), cost},
+        [this, input, output, &default_value](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (auto i = static_cast<size_t>(first), end = static_cast<size_t>(last); i < end; ++i) {
+            const TValue* value = Find(input[i]);
+            output[i] = value == nullptr ? default_value : *value;
+          }
+        });
+  }
+
+  size_t size() const { return map_.size(); }
+
+ private:
+  static constexpr size_t kDenseSlotsPerEntry = 4;
+  static constexpr size_t kMinDenseSlots = 256;
+
+  Map map_;
+  // dense_[key - dense_min_] points to the value of key in map_, or is nullptr. Empty if the keys are too sparse.
+  std::vector<const TValue*> dense_;
+  TKey dense_min_{};
+};
+
+}  // namespace ml
+}  // namespace onnxruntime
@@ -2,6 +2,8 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/ml/onehotencoder.h"
+
+#include <atomic>
 /**
 https://github.com/onnx/onnx/blob/main/onnx/defs/traditionalml/defs.cc
 ONNX_OPERATOR_SCHEMA(OneHotEncoder)
@@ -56,18 +58,48 @@ OneHotEncoderOp<T>::OneHotEncoderOp(const OpKernelInfo& info) : OpKernel(info),
               "One and only one of the 'cats_*' attributes must be defined");
   if (!tmp_cats_int64s.empty()) {
     num_categories_ = tmp_cats_int64s.size();
+    cats_int64s_.Reserve(tmp_cats_int64s.size());
     for (size_t idx = 0, end = tmp_cats_int64s.size(); idx < end; ++idx) {
-      cats_int64s_[tmp_cats_int64s[idx]] = idx;
+      cats_int64s_.Insert(tmp_cats_int64s[idx], idx, true);
     }
+    cats_int64s_.Finalize();
   } else {
     num_categories_ = tmp_cats_strings.size();
+    cats_strings_.Reserve(tmp_cats_strings.size());
     for (size_t idx = 0, end = tmp_cats_strings.size(); idx < end; ++idx) {
-      cats_strings_[tmp_cats_strings[idx]] = idx;
+      cats_strings_.Insert(tmp_cats_strings[idx], idx, true);
     }
+    cats_strings_.Finalize();
   }
   ORT_ENFORCE(num_categories_ > 0);
 }
 
+template <typename T>
+template <typename TKey, typename GetKey>
+bool OneHotEncoderOp<T>::Encode(concurrency::ThreadPool* thread_pool, const LookupTable<TKey, size_t>& categories,
+                                size_t x_size, GetKey get_key, float* y_data) const {
+  const auto num_categories = onnxruntime::narrow<size_t>(num_categories_);
+  std::atomic<bool> unknown_category{false};
+  // Every row is zeroed and set by the thread that looks its value up.
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, onnxruntime::narrow<std::ptrdiff_t>(x_size),
+      TensorOpCost{static_cast<double>(sizeof(TKey)), static_cast<double>(num_categories * sizeof(float)),
+                   static_cast<double>(num_categories) + (std::is_same_v<TKey, std::string> ? 64.0 : 4.0)},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (auto i = static_cast<size_t>(first), end = static_cast<size_t>(last); i < end; ++i) {
+          float* y_row = y_data + i * num_categories;
+          std::fill_n(y_row, num_categories, 0.0f);
+          const size_t* idx = categories.Find(get_key(i));
+          if (idx != nullptr) {
+            y_row[*idx] = 1.0f;
+          } else if (!zeros_) {
+            unknown_category.store(true, std::memory_order_relaxed);
+          }
+        }
+      });
+  return !unknown_category.load();
+}
+
 template <typename T>
 common::Status OneHotEncoderOp<T>::Compute(OpKernelContext* context) const {
   const auto* X = context->Input<Tensor>(0);
@@ -77,19 +109,11 @@ common::Status OneHotEncoderOp<T>::Compute(OpKernelContext* context) const {
   output_shape.push_back(num_categories_);
 
   Tensor* Y = context->Output(0, TensorShape(output_shape));
-  auto* y_data = Y->MutableData<float>();
-  std::fill_n(y_data, Y->Shape().Size(), 0.0f);
-
   const auto* x_data = X->Data<T>();
-  const auto x_size = input_shape.Size();
-  std::unordered_map<int64_t, size_t>::const_iterator idx;
-  for (int64_t i = 0; i < x_size; ++i) {
-    auto int_idx = cats_int64s_.find(static_cast<int64_t>(x_data[i]));
-    if (int_idx != cats_int64s_.cend())
-      y_data[i * num_categories_ + int_idx->second] = 1.0f;
-    else if (!zeros_)
-      return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
-  }
+  if (!Encode(
+          context->GetOperatorThreadPool(), cats_int64s_, onnxruntime::narrow<size_t>(input_shape.Size()),
+          [x_data](size_t i) { return static_cast<int64_t>(x_data[i]); }, Y->MutableData<float>()))
+    return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
   return Status::OK();
 }
 
@@ -102,18 +126,11 @@ common::Status OneHotEncoderOp<std::string>::Compute(OpKernelContext* context) c
   output_shape.push_back(num_categories_);
 
   Tensor* Y = context->Output(0, TensorShape(output_shape));
-  auto* y_data = Y->MutableData<float>();
-  std::fill_n(y_data, Y->Shape().Size(), 0.0f);
-
   const auto* x_data = X->Data<std::string>();
-  const auto x_size = input_shape.Size();
-  for (int64_t i = 0; i < x_size; ++i) {
-    auto str_idx = cats_strings_.find(x_data[i]);
-    if (str_idx != cats_strings_.cend())
-      y_data[i * num_categories_ + str_idx->second] = 1.0f;
-    else if (!zeros_)
-      return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
-  }
+  if (!Encode(
+          context->GetOperatorThreadPool(), cats_strings_, onnxruntime::narrow<size_t>(input_shape.Size()),
+          [x_data](size_t i) -> const std::string& { return x_data[i]; }, Y->MutableData<float>()))
+    return Status(ONNXRUNTIME, FAIL, "Unknown Category and zeros = 0.");
   return Status::OK();
 }
 
@@ -4,6 +4,7 @@
 #pragma once
 #include "core/common/common.h"
 #include "core/framework/op_kernel.h"
+#include "core/providers/cpu/ml/lookup_table.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -14,8 +15,13 @@ class OneHotEncoderOp final : public OpKernel {
   common::Status Compute(OpKernelContext* context) const override;
 
  private:
-  std::unordered_map<int64_t, size_t> cats_int64s_;
-  std::unordered_map<std::string, size_t> cats_strings_;
+  // Writes the one-hot rows of all inputs. Returns false if a value is not a category and zeros_ is 0.
+  template <typename TKey, typename GetKey>
+  bool Encode(concurrency::ThreadPool* thread_pool, const LookupTable<TKey, size_t>& categories, size_t x_size,
+              GetKey get_key, float* y_data) const;
+
+  LookupTable<int64_t, size_t> cats_int64s_;
+  LookupTable<std::string, size_t> cats_strings_;
   int64_t zeros_;
   int64_t num_categories_;
 };
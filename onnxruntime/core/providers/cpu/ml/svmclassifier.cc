@@ -74,6 +74,33 @@ SVMClassifier::SVMClassifier(const OpKernelInfo& info)
   ORT_ENFORCE(coefficients_.size() > 0);
   weights_are_all_positive_ = std::all_of(coefficients_.cbegin(), coefficients_.cend(),
                                           [](float value) { return value >= 0.f; });
+
+  // The one-vs-one classifier comparing classes i and j combines coefficients_[j - 1] with the kernels of the
+  // support vectors of class i, and coefficients_[i] with the kernels of the support vectors of class j.
+  // Spread them into a dense matrix so that Compute scores all classifiers of all rows with one GEMM.
+  // The matrix has class_count_ / 2 times more values than coefficients_, skip it when it gets too large.
+  constexpr size_t kMaxOvoCoefficients = 4 * 1024 * 1024;
+  const size_t num_classifiers = SafeInt<size_t>(class_count_) * (class_count_ - 1) / 2;
+  if (mode_ == SVM_TYPE::SVM_SVC &&
+      vectors_per_class_.size() == static_cast<size_t>(class_count_) &&
+      coefficients_.size() >= SafeInt<size_t>(vector_count_) * (class_count_ - 1) &&
+      SafeInt<size_t>(vector_count_) * num_classifiers <= kMaxOvoCoefficients) {
+    ovo_coefficients_.resize(SafeInt<size_t>(vector_count_) * num_classifiers, 0.f);
+    const size_t vector_count = narrow<size_t>(vector_count_);
+    size_t classifier_idx = 0;
+    for (size_t i = 0; i < vectors_per_class_.size() - 1; i++) {
+      for (size_t j = i + 1; j < vectors_per_class_.size(); j++, classifier_idx++) {
+        for (int64_t m = 0; m < vectors_per_class_[i]; m++) {
+          const auto sv = narrow<size_t>(starting_vector_[i] + m);
+          ovo_coefficients_[sv * num_classifiers + classifier_idx] = coefficients_[vector_count * (j - 1) + sv];
+        }
+        for (int64_t m = 0; m < vectors_per_class_[j]; m++) {
+          const auto sv = narrow<size_t>(starting_vector_[j] + m);
+          ovo_coefficients_[sv * num_classifiers + classifier_idx] = coefficients_[vector_count * i + sv];
+        }
+      }
+    }
+  }
 }
 
 template <typename LabelType>
@@ -247,61 +274,85 @@ Status SVMClassifier::ComputeImpl(OpKernelContext& ctx,
     batched_kernel_dot<float>(x_data, support_vectors_, num_batches, vector_count_, feature_count_, 0.f, kernels_span,
                               threadpool);
 
-    for (int64_t n = 0; n < num_batches; n++) {
-      // reduce scores from kernels using coefficients, taking into account the varying number of support vectors
-      // per class.
-      // coefficients: [num_classes - 1, vector_count_]
-      //
-      // e.g. say you have 3 classes, with 3 x 3 coefficients
-      //
-      // AA AB AC
-      // BA BB BC
-      // CA CB CC
-      //
-      // you can remove the diagonal line of items comparing a class with itself leaving one less row.
-      //
-      // BA AB AC
-      // CA CB BC
-      //
-      // for each class there is a coefficient per support vector, and a class has one or more support vectors.
-      //
-      // Combine the scores for the two combinations for two classes with their coefficient.
-      // e.g. AB combines with BA.
-      // If A has 3 support vectors and B has 2, there's a 3x2 block for AB and a 2x3 block for BA to combine
-
-      auto cur_kernels = kernels_span.subspan(n * SafeInt<size_t>(vector_count_), onnxruntime::narrow<size_t>(vector_count_));
-      auto cur_scores = classifier_scores.subspan(n * SafeInt<size_t>(num_slots_per_iteration), onnxruntime::narrow<size_t>(num_classifiers));
-      auto cur_votes = votes_span.subspan(n * SafeInt<size_t>(class_count_), onnxruntime::narrow<size_t>(class_count_));
-      auto scores_iter = cur_scores.begin();
-
-      size_t classifier_idx = 0;
-      for (int64_t i = 0; i < class_count_ - 1; i++) {
-        int64_t start_index_i = starting_vector_[onnxruntime::narrow<size_t>(i)];  // start of support vectors for class i
-        int64_t class_i_support_count = vectors_per_class_[onnxruntime::narrow<size_t>(i)];
-        int64_t i_coeff_row_offset = vector_count_ * i;
-
-        for (int64_t j = i + 1; j < class_count_; j++) {
-          int64_t start_index_j = starting_vector_[onnxruntime::narrow<size_t>(j)];  // start of support vectors for class j
-          int64_t class_j_support_count = vectors_per_class_[onnxruntime::narrow<size_t>(j)];
-          int64_t j_coeff_row_offset = vector_count_ * (j - 1);
-
-          double sum = 0;
-
-          const float* val1 = &(coefficients_[j_coeff_row_offset + SafeInt<size_t>(start_index_i)]);
-          const float* val2 = &(cur_kernels[onnxruntime::narrow<size_t>(start_index_i)]);
-          for (int64_t m = 0; m < class_i_support_count; ++m, ++val1, ++val2)
-            sum += *val1 * *val2;
-
-          val1 = &(coefficients_[i_coeff_row_offset + SafeInt<size_t>(start_index_j)]);
-          val2 = &(cur_kernels[onnxruntime::narrow<size_t>(start_index_j)]);
-
-          for (int64_t m = 0; m < class_j_support_count; ++m, ++val1, ++val2)
-            sum += *val1 * *val2;
-
-          sum += rho_[classifier_idx++];
-
-          *scores_iter++ = static_cast<float>(sum);
-          ++(cur_votes[onnxruntime::narrow<size_t>(sum > 0 ? i : j)]);
+    if (!ovo_coefficients_.empty()) {
+      // classifier scores: kernels [num_batches, vector_count_] x ovo_coefficients_ [vector_count_, num_classifiers]
+      // + rho_, the rows of the output being num_slots_per_iteration apart.
+      for (int64_t n = 0; n < num_batches; n++) {
+        std::copy_n(rho_.data(), num_classifiers, classifier_scores.data() + n * num_slots_per_iteration);
+      }
+      math::GemmEx<float, concurrency::ThreadPool>(CBLAS_TRANSPOSE::CblasNoTrans, CBLAS_TRANSPOSE::CblasNoTrans,
+                                                   num_batches, num_classifiers, vector_count_,
+                                                   1.f, kernels_data.data(), narrow<int>(vector_count_),
+                                                   ovo_coefficients_.data(), narrow<int>(num_classifiers),
+                                                   1.f, classifier_scores.data(), narrow<int>(num_slots_per_iteration),
+                                                   threadpool);
+    } else {
+      for (int64_t n = 0; n < num_batches; n++) {
+        // reduce scores from kernels using coefficients, taking into account the varying number of support vectors
+        // per class.
+        // coefficients: [num_classes - 1, vector_count_]
+        //
+        // e.g. say you have 3 classes, with 3 x 3 coefficients
+        //
+        // AA AB AC
+        // BA BB BC
+        // CA CB CC
+        //
+        // you can remove the diagonal line of items comparing a class with itself leaving one less row.
+        //
+        // BA AB AC
+        // CA CB BC
+        //
+        // for each class there is a coefficient per support vector, and a class has one or more support vectors.
+        //
+        // Combine the scores for the two combinations for two classes with their coefficient.
+        // e.g. AB combines with BA.
+        // If A has 3 support vectors and B has 2, there's a 3x2 block for AB and a 2x3 block for BA to combine
+
+        auto cur_kernels = kernels_span.subspan(n * SafeInt<size_t>(vector_count_), onnxruntime::narrow<size_t>(vector_count_));
+        auto cur_scores = classifier_scores.subspan(n * SafeInt<size_t>(num_slots_per_iteration), onnxruntime::narrow<size_t>(num_classifiers));
+        auto scores_iter = cur_scores.begin();
+
+        size_t classifier_idx = 0;
+        for (int64_t i = 0; i < class_count_ - 1; i++) {
+          int64_t start_index_i = starting_vector_[onnxruntime::narrow<size_t>(i)];  // start of support vectors for class i
+          int64_t class_i_support_count = vectors_per_class_[onnxruntime::narrow<size_t>(i)];
+          int64_t i_coeff_row_offset = vector_count_ * i;
+
+          for (int64_t j = i + 1; j < class_count_; j++) {
+            int64_t start_index_j = starting_vector_[onnxruntime::narrow<size_t>(j)];  // start of support vectors for class j
+            int64_t class_j_support_count = vectors_per_class_[onnxruntime::narrow<size_t>(j)];
+            int64_t j_coeff_row_offset = vector_count_ * (j - 1);
+
+            double sum = 0;
+
+            const float* val1 = &(coefficients_[j_coeff_row_offset + SafeInt<size_t>(start_index_i)]);
+            const float* val2 = &(cur_kernels[onnxruntime::narrow<size_t>(start_index_i)]);
+            for (int64_t m = 0; m < class_i_support_count; ++m, ++val1, ++val2)
+              sum += *val1 * *val2;
+
+            val1 = &(coefficients_[i_coeff_row_offset + SafeInt<size_t>(start_index_j)]);
+            val2 = &(cur_kernels[onnxruntime::narrow<size_t>(start_index_j)]);
+
+            for (int64_t m = 0; m < class_j_support_count; ++m, ++val1, ++val2)
+              sum += *val1 * *val2;
+
+            sum += rho_[classifier_idx++];
+
+            *scores_iter++ = static_cast<float>(sum);
+          }
+        }
+      }
+    }
+
+    // one vote per classifier and row, the loop over the rows being the inner one
+    size_t classifier_idx = 0;
+    for (int64_t i = 0; i < class_count_ - 1; i++) {
+      for (int64_t j = i + 1; j < class_count_; j++, classifier_idx++) {
+        const float* cur_score = classifier_scores.data() + classifier_idx;
+        int64_t* cur_votes = votes_span.data();
+        for (int64_t n = 0; n < num_batches; n++, cur_score += num_slots_per_iteration, cur_votes += class_count_) {
+          ++cur_votes[*cur_score > 0 ? i : j];
         }
       }
     }
@@ -39,28 +39,22 @@ class SVMCommon {
     assert(a.size() == size_t(m * k) && b.size() == size_t(k * n) && out.size() == size_t(m * n));
 
     if (kernel_type_ == KERNEL::RBF) {
-      T* cur_out = out.data();
-      const T* cur_batch = a.data();
-
-      // each batch has 'k' features
-      for (int64_t batch = 0; batch < m; ++batch) {
-        const T* cur_support_vector = b.data();
-
-        // broadcast the support vectors against the k features in each batch. output is one value per support vector
-        for (int64_t support_vector = 0; support_vector < n; ++support_vector) {
-          T sum = 0.f;
-          const T* cur_input = cur_batch;
-
-          for (int64_t feature = 0; feature < k; ++feature) {
-            T val = *cur_input++ - *cur_support_vector++;
-            sum += val * val;
-          }
-
-          *cur_out++ = std::exp(-gamma_ * sum);
-        }
+      // |a - b|^2 = |a|^2 + |b|^2 - 2 a.b so the distances come from one GEMM for the cross term.
+      onnxruntime::Gemm<T>::ComputeGemm(CBLAS_TRANSPOSE::CblasNoTrans, CBLAS_TRANSPOSE::CblasTrans,
+                                        m, n, k,
+                                        -2.f, a.data(), b.data(), 0.f,
+                                        nullptr, nullptr,
+                                        out.data(),
+                                        threadpool);
 
-        cur_batch += k;  // move to start of next batch
-      }
+      Eigen::Matrix<T, Eigen::Dynamic, 1> a_norms = ConstEigenMatrixMapRowMajor<T>(a.data(), m, k).rowwise().squaredNorm();
+      Eigen::Matrix<T, Eigen::Dynamic, 1> b_norms = ConstEigenMatrixMapRowMajor<T>(b.data(), n, k).rowwise().squaredNorm();
+      auto distances = EigenMatrixMapRowMajor<T>(out.data(), m, n);
+      distances.colwise() += a_norms;
+      distances.rowwise() += b_norms.transpose();
+      // rounding errors can make the distance of a point to itself slightly negative
+      distances = (distances.array().max(T(0)) * -gamma_).matrix();
+      MlasComputeExp(out.data(), out.data(), out.size());
     } else {
       float alpha = 1.f;
       float beta = 1.f;
@@ -125,6 +119,9 @@ class SVMClassifier final : public OpKernel, private SVMCommon {
   std::vector<float> proba_;
   std::vector<float> probb_;
   std::vector<float> coefficients_;
+  // coefficients_ rearranged as a [vector_count_, num_classifiers] matrix with zeros for the support vectors
+  // a classifier does not use, so that all one-vs-one scores come from one GEMM. Empty if too large.
+  std::vector<float> ovo_coefficients_;
   std::vector<float> support_vectors_;
   std::vector<int64_t> classlabels_ints_;
   std::vector<std::string> classlabels_strings_;
@@ -139,6 +139,12 @@ struct TreeNodeElement {
   inline bool is_missing_track_true() const { return flags & MissingTrack::kTrue; }
 };
 
+// The weight TreeNodeElement::value_or_unique_weight holds for a leaf given by the range of its weights.
+template <typename T>
+inline T GetUniqueWeight(const typename PtrOrWeight<T>::WeightData& leaf, gsl::span<const SparseValue<T>> weights) {
+  return leaf.n_weights == 0 ? T(0) : weights[onnxruntime::narrow<size_t>(leaf.weight)].value;
+}
+
 template <typename InputType, typename ThresholdType, typename OutputType>
 class TreeAggregator {
  protected:
@@ -163,6 +169,10 @@ class TreeAggregator {
   void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& /*prediction*/,
                                   const TreeNodeElement<ThresholdType>& /*root*/) const {}
 
+  void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& /*prediction*/,
+                                  const typename PtrOrWeight<ThresholdType>::WeightData& /*leaf*/,
+                                  gsl::span<const SparseValue<ThresholdType>> /*weights*/) const {}
+
   void MergePrediction1(ScoreValue<ThresholdType>& /*prediction*/, ScoreValue<ThresholdType>& /*prediction2*/) const {}
 
   void FinalizeScores1(OutputType* Z, ScoreValue<ThresholdType>& prediction, int64_t* /*Y*/) const {
@@ -178,6 +188,10 @@ class TreeAggregator {
                                  const TreeNodeElement<ThresholdType>& /*root*/,
                                  gsl::span<const SparseValue<ThresholdType>> /*weights*/) const {}
 
+  void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& /*predictions*/,
+                                 const typename PtrOrWeight<ThresholdType>::WeightData& /*leaf*/,
+                                 gsl::span<const SparseValue<ThresholdType>> /*weights*/) const {}
+
   void MergePrediction(InlinedVector<ScoreValue<ThresholdType>>& /*predictions*/,
                        const InlinedVector<ScoreValue<ThresholdType>>& /*predictions2*/) const {}
 
@@ -215,6 +229,12 @@ class TreeAggregatorSum : public TreeAggregator<InputType, ThresholdType, Output
     prediction.score += root.value_or_unique_weight;
   }
 
+  void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction,
+                                  const typename PtrOrWeight<ThresholdType>::WeightData& leaf,
+                                  gsl::span<const SparseValue<ThresholdType>> weights) const {
+    prediction.score += GetUniqueWeight(leaf, weights);
+  }
+
   void MergePrediction1(ScoreValue<ThresholdType>& prediction,
                         const ScoreValue<ThresholdType>& prediction2) const {
     prediction.score += prediction2.score;
@@ -232,8 +252,14 @@ class TreeAggregatorSum : public TreeAggregator<InputType, ThresholdType, Output
   void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
                                  const TreeNodeElement<ThresholdType>& root,
                                  gsl::span<const SparseValue<ThresholdType>> weights) const {
-    auto it = weights.begin() + root.truenode_or_weight.weight_data.weight;
-    for (int32_t i = 0; i < root.truenode_or_weight.weight_data.n_weights; ++i, ++it) {
+    ProcessTreeNodePrediction(predictions, root.truenode_or_weight.weight_data, weights);
+  }
+
+  void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
+                                 const typename PtrOrWeight<ThresholdType>::WeightData& leaf,
+                                 gsl::span<const SparseValue<ThresholdType>> weights) const {
+    auto it = weights.begin() + leaf.weight;
+    for (int32_t i = 0; i < leaf.n_weights; ++i, ++it) {
       ORT_ENFORCE(it->i < (int64_t)predictions.size());
       predictions[onnxruntime::narrow<size_t>(it->i)].score += it->value;
       predictions[onnxruntime::narrow<size_t>(it->i)].has_score = 1;
@@ -314,9 +340,17 @@ class TreeAggregatorMin : public TreeAggregator<InputType, ThresholdType, Output
 
   void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction,
                                   const TreeNodeElement<ThresholdType>& root) const {
-    prediction.score = (!(prediction.has_score) || root.value_or_unique_weight < prediction.score)
-                           ? root.value_or_unique_weight
-                           : prediction.score;
+    ProcessTreeNodePrediction1(prediction, root.value_or_unique_weight);
+  }
+
+  void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction,
+                                  const typename PtrOrWeight<ThresholdType>::WeightData& leaf,
+                                  gsl::span<const SparseValue<ThresholdType>> weights) const {
+    ProcessTreeNodePrediction1(prediction, GetUniqueWeight(leaf, weights));
+  }
+
+  void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction, ThresholdType weight) const {
+    prediction.score = (!(prediction.has_score) || weight < prediction.score) ? weight : prediction.score;
     prediction.has_score = 1;
   }
 
@@ -335,8 +369,14 @@ class TreeAggregatorMin : public TreeAggregator<InputType, ThresholdType, Output
   void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
                                  const TreeNodeElement<ThresholdType>& root,
                                  gsl::span<const SparseValue<ThresholdType>> weights) const {
-    auto it = weights.begin() + root.truenode_or_weight.weight_data.weight;
-    for (int32_t i = 0; i < root.truenode_or_weight.weight_data.n_weights; ++i, ++it) {
+    ProcessTreeNodePrediction(predictions, root.truenode_or_weight.weight_data, weights);
+  }
+
+  void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
+                                 const typename PtrOrWeight<ThresholdType>::WeightData& leaf,
+                                 gsl::span<const SparseValue<ThresholdType>> weights) const {
+    auto it = weights.begin() + leaf.weight;
+    for (int32_t i = 0; i < leaf.n_weights; ++i, ++it) {
       predictions[onnxruntime::narrow<size_t>(it->i)].score =
           (!predictions[onnxruntime::narrow<size_t>(it->i)].has_score || it->value < predictions[onnxruntime::narrow<size_t>(it->i)].score)
               ? it->value
@@ -371,9 +411,17 @@ class TreeAggregatorMax : public TreeAggregator<InputType, ThresholdType, Output
 
   void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction,
                                   const TreeNodeElement<ThresholdType>& root) const {
-    prediction.score = (!(prediction.has_score) || root.value_or_unique_weight > prediction.score)
-                           ? root.value_or_unique_weight
-                           : prediction.score;
+    ProcessTreeNodePrediction1(prediction, root.value_or_unique_weight);
+  }
+
+  void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction,
+                                  const typename PtrOrWeight<ThresholdType>::WeightData& leaf,
+                                  gsl::span<const SparseValue<ThresholdType>> weights) const {
+    ProcessTreeNodePrediction1(prediction, GetUniqueWeight(leaf, weights));
+  }
+
+  void ProcessTreeNodePrediction1(ScoreValue<ThresholdType>& prediction, ThresholdType weight) const {
+    prediction.score = (!(prediction.has_score) || weight > prediction.score) ? weight : prediction.score;
     prediction.has_score = 1;
   }
 
@@ -391,8 +439,14 @@ class TreeAggregatorMax : public TreeAggregator<InputType, ThresholdType, Output
   void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
                                  const TreeNodeElement<ThresholdType>& root,
                                  gsl::span<const SparseValue<ThresholdType>> weights) const {
-    auto it = weights.begin() + root.truenode_or_weight.weight_data.weight;
-    for (int32_t i = 0; i < root.truenode_or_weight.weight_data.n_weights; ++i, ++it) {
+    ProcessTreeNodePrediction(predictions, root.truenode_or_weight.weight_data, weights);
+  }
+
+  void ProcessTreeNodePrediction(InlinedVector<ScoreValue<ThresholdType>>& predictions,
+                                 const typename PtrOrWeight<ThresholdType>::WeightData& leaf,
+                                 gsl::span<const SparseValue<ThresholdType>> weights) const {
+    auto it = weights.begin() + leaf.weight;
+    for (int32_t i = 0; i < leaf.n_weights; ++i, ++it) {
       predictions[onnxruntime::narrow<size_t>(it->i)].score =
           (!predictions[onnxruntime::narrow<size_t>(it->i)].has_score || it->value > predictions[onnxruntime::narrow<size_t>(it->i)].score)
               ? it->value
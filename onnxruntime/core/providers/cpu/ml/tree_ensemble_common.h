@@ -3,11 +3,17 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <mutex>
+#include <vector>
 #include "core/platform/threadpool.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "tree_ensemble_helper.h"
 #include "tree_ensemble_attribute.h"
 #include "tree_ensemble_aggregator.h"
+#include "tree_ensemble_quick_scorer.h"
+#include "tree_ensemble_compact.h"
 
 namespace onnxruntime {
 namespace ml {
@@ -53,6 +59,10 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
   // `ThresholdType` is used as well for output type (double as well for lightgbm) and not `OutputType`.
   std::vector<SparseValue<ThresholdType>> weights_;
   std::vector<TreeNodeElement<ThresholdType>*> roots_;
+  // Set if the ensemble can be evaluated with QuickScorer, see TreeEnsembleQuickScorer.
+  std::unique_ptr<TreeEnsembleQuickScorer<ThresholdType>> quick_scorer_;
+  // Set if the nodes were converted into TreeEnsembleCompactNodes, nodes_ and roots_ are then empty.
+  std::unique_ptr<TreeEnsembleCompactNodes<ThresholdType>> compact_nodes_;
 
  public:
   TreeEnsembleCommon() {}
@@ -65,14 +75,44 @@ class TreeEnsembleCommon : public TreeEnsembleCommonAttributes {
               int parallel_N,
               const TreeEnsembleAttributesV3<ThresholdType>& attributes);
 
+  // Replaces nodes_ with TreeEnsembleCompactNodes if the ensemble allows it. Returns false otherwise.
+  bool CompactNodes();
+
  protected:
+  // Calls CompactNodes if kOrtSessionOptionsTreeEnsembleCompactNodes is enabled.
+  void CompactNodesIfRequested(const OpKernelInfo& info);
+
   TreeNodeElement<ThresholdType>* ProcessTreeNodeLeave(TreeNodeElement<ThresholdType>* root,
                                                        const InputType* x_data) const;
 
+  // Sets leaves[i] to ProcessTreeNodeLeave(root, x_data + i * stride) for every i < n_rows.
+  void ProcessTreeNodeLeaves(TreeNodeElement<ThresholdType>* root, const InputType* x_data, int64_t stride,
+                             size_t n_rows, TreeNodeElement<ThresholdType>** leaves) const;
+
+  // Evaluates rows [begin, end) in batches of parallel_tree_N_ rows: every tree is evaluated on a whole batch
+  // before moving to the next tree.
+  template <typename AGG>
+  void ComputeAggRowBatches(const InputType* x_data, OutputType* z_data, int64_t* label_data,
+                            int64_t begin, int64_t end, int64_t stride, const AGG& agg) const;
+
   template <typename AGG>
   void ComputeAgg(concurrency::ThreadPool* ttp, const Tensor* X, Tensor* Y, Tensor* label, const AGG& agg) const;
 
+  // Evaluates all trees row by row with a ROW_SCORER such as TreeEnsembleQuickScorer or TreeEnsembleCompactNodes.
+  template <typename AGG, typename ROW_SCORER>
+  void ComputeAggByRows(concurrency::ThreadPool* ttp, const InputType* x_data, OutputType* z_data,
+                        int64_t* label_data, int64_t N, int64_t stride, const AGG& agg,
+                        const ROW_SCORER& row_scorer) const;
+
  private:
+  // Number of rows walked down a tree together by ProcessTreeNodeLeaves.
+  static constexpr size_t kInterleavedRows = 8;
+
+  template <typename CMP>
+  static void ProcessTreeNodeLeavesInterleaved(TreeNodeElement<ThresholdType>* root, const InputType* x_data,
+                                               int64_t stride, size_t n_rows,
+                                               TreeNodeElement<ThresholdType>** leaves, CMP cmp);
+
   bool CheckIfSubtreesAreEqual(const size_t left_id, const size_t right_id, const int64_t tree_id, const InlinedVector<NODE_MODE_ONNX>& cmodes,
                                const InlinedVector<size_t>& truenode_ids, const InlinedVector<size_t>& falsenode_ids, gsl::span<const int64_t> nodes_featureids,
                                gsl::span<const ThresholdType> nodes_values_as_tensor, gsl::span<const float> node_values,
@@ -118,7 +158,9 @@ std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t> bit_cast_i
 template <typename InputType, typename ThresholdType, typename OutputType>
 Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV3<ThresholdType> attributes(info, false);
-  return Init(80, 128, 50, attributes);
+  ORT_RETURN_IF_ERROR(Init(80, 128, 50, attributes));
+  CompactNodesIfRequested(info);
+  return Status::OK();
 }
 
 template <typename InputType, typename ThresholdType, typename OutputType>
@@ -288,9 +330,41 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::Init(
     }
   }
 
+  // Ensembles of shallow trees using a single comparison rule are evaluated with QuickScorer
+  // when several rows are scored. Deeper trees keep the pointer-based traversal.
+  quick_scorer_.reset();
+  if (same_mode_ && !has_missing_tracks_) {
+    auto quick_scorer = std::make_unique<TreeEnsembleQuickScorer<ThresholdType>>();
+    if (quick_scorer->Init(nodes_, roots_, max_feature_id_)) {
+      quick_scorer_ = std::move(quick_scorer);
+    }
+  }
+  compact_nodes_.reset();
+
   return Status::OK();
 }
 
+template <typename InputType, typename ThresholdType, typename OutputType>
+bool TreeEnsembleCommon<InputType, ThresholdType, OutputType>::CompactNodes() {
+  auto compact_nodes = std::make_unique<TreeEnsembleCompactNodes<ThresholdType>>();
+  if (!compact_nodes->Init(nodes_, roots_, max_feature_id_)) {
+    return false;
+  }
+  compact_nodes_ = std::move(compact_nodes);
+  // QuickScorer points to the leaves of nodes_.
+  quick_scorer_.reset();
+  std::vector<TreeNodeElement<ThresholdType>>().swap(nodes_);
+  std::vector<TreeNodeElement<ThresholdType>*>().swap(roots_);
+  return true;
+}
+
+template <typename InputType, typename ThresholdType, typename OutputType>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::CompactNodesIfRequested(const OpKernelInfo& info) {
+  if (info.GetConfigOptions().GetConfigOrDefault(kOrtSessionOptionsTreeEnsembleCompactNodes, "0") == "1") {
+    CompactNodes();
+  }
+}
+
 template <typename InputType, typename ThresholdType, typename OutputType>
 bool TreeEnsembleCommon<InputType, ThresholdType, OutputType>::CheckIfSubtreesAreEqual(
     const size_t left_id, const size_t right_id, const int64_t tree_id, const InlinedVector<NODE_MODE_ONNX>& cmodes,
@@ -432,28 +506,28 @@ Status TreeEnsembleCommon<InputType, ThresholdType, OutputType>::compute(OpKerne
       ComputeAgg(
           ctx->GetOperatorThreadPool(), X, Y, label,
           TreeAggregatorAverage<InputType, ThresholdType, OutputType>(
-              roots_.size(), n_targets_or_classes_,
+              onnxruntime::narrow<size_t>(n_trees_), n_targets_or_classes_,
               post_transform_, base_values_));
       return Status::OK();
     case AGGREGATE_FUNCTION::SUM:
       ComputeAgg(
           ctx->GetOperatorThreadPool(), X, Y, label,
           TreeAggregatorSum<InputType, ThresholdType, OutputType>(
-              roots_.size(), n_targets_or_classes_,
+              onnxruntime::narrow<size_t>(n_trees_), n_targets_or_classes_,
               post_transform_, base_values_));
       return Status::OK();
     case AGGREGATE_FUNCTION::MIN:
       ComputeAgg(
           ctx->GetOperatorThreadPool(), X, Y, label,
           TreeAggregatorMin<InputType, ThresholdType, OutputType>(
-              roots_.size(), n_targets_or_classes_,
+              onnxruntime::narrow<size_t>(n_trees_), n_targets_or_classes_,
               post_transform_, base_values_));
       return Status::OK();
     case AGGREGATE_FUNCTION::MAX:
       ComputeAgg(
           ctx->GetOperatorThreadPool(), X, Y, label,
           TreeAggregatorMax<InputType, ThresholdType, OutputType>(
-              roots_.size(), n_targets_or_classes_,
+              onnxruntime::narrow<size_t>(n_trees_), n_targets_or_classes_,
               post_transform_, base_values_));
       return Status::OK();
     default:
@@ -481,6 +555,16 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
   int64_t* label_data = label == nullptr ? nullptr : label->MutableData<int64_t>();
   auto max_num_threads = concurrency::ThreadPool::DegreeOfParallelism(ttp);
 
+  if (compact_nodes_ != nullptr) {
+    ComputeAggByRows(ttp, x_data, z_data, label_data, N, stride, agg, *compact_nodes_);
+    return;
+  }
+
+  if (quick_scorer_ != nullptr && N > 1) {
+    ComputeAggByRows(ttp, x_data, z_data, label_data, N, stride, agg, *quick_scorer_);
+    return;
+  }
+
   if (n_targets_or_classes_ == 1) {
     if (N == 1) {
       ScoreValue<ThresholdType> score = {0, 0};
@@ -504,35 +588,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
       }
       agg.FinalizeScores1(z_data, score, label_data);
     } else if (N <= parallel_N_ || max_num_threads == 1) { /* section C: 1 output, 2+ rows but not enough rows to parallelize */
-      // Not enough data to parallelize but the computation is split into batches of 128 rows,
-      // and then loop on trees to evaluate every tree on this batch.
-      // This change was introduced by PR: https://github.com/microsoft/onnxruntime/pull/13835.
-      // The input tensor (2D) is stored in a contiguous array. Therefore, it is faster
-      // to loop on tree first and inside that loop evaluate a tree on the input tensor (inner loop).
-      // The processor is faster when it has to move chunks of a contiguous array (branching).
-      // However, if the input tensor is too big, the data does not hold on caches (L1, L2, L3).
-      // In that case, looping first on tree or on data is almost the same. That's why the first loop
-      // split into batch so that every batch holds on caches, then loop on trees and finally loop
-      // on the batch rows.
-      std::vector<ScoreValue<ThresholdType>> scores(parallel_tree_N_);
-      size_t j;
-      int64_t i, batch, batch_end;
-
-      for (batch = 0; batch < N; batch += parallel_tree_N_) {
-        batch_end = std::min(N, batch + parallel_tree_N_);
-        for (i = batch; i < batch_end; ++i) {
-          scores[SafeInt<ptrdiff_t>(i - batch)] = {0, 0};
-        }
-        for (j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-          for (i = batch; i < batch_end; ++i) {
-            agg.ProcessTreeNodePrediction1(scores[SafeInt<ptrdiff_t>(i - batch)], *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-          }
-        }
-        for (i = batch; i < batch_end; ++i) {
-          agg.FinalizeScores1(z_data + i, scores[SafeInt<ptrdiff_t>(i - batch)],
-                              label_data == nullptr ? nullptr : (label_data + i));
-        }
-      }
+      ComputeAggRowBatches(x_data, z_data, label_data, 0, N, stride, agg);
     } else if (n_trees_ > max_num_threads) { /* section D: 1 output, 2+ rows and enough trees to parallelize */
       auto num_threads = std::min<int32_t>(max_num_threads, SafeInt<int32_t>(n_trees_));
       std::vector<ScoreValue<ThresholdType>> scores(SafeInt<size_t>(num_threads) * N);
@@ -544,13 +600,15 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
             num_threads,
             [this, &agg, &scores, num_threads, x_data, N, begin_n, end_n, stride](ptrdiff_t batch_num) {
               auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, onnxruntime::narrow<size_t>(this->n_trees_));
+              std::vector<TreeNodeElement<ThresholdType>*> leaves(onnxruntime::narrow<size_t>(end_n - begin_n));
               for (int64_t i = begin_n; i < end_n; ++i) {
                 scores[batch_num * SafeInt<ptrdiff_t>(N) + i] = {0, 0};
               }
               for (auto j = work.start; j < work.end; ++j) {
+                ProcessTreeNodeLeaves(roots_[j], x_data + begin_n * stride, stride, leaves.size(), leaves.data());
                 for (int64_t i = begin_n; i < end_n; ++i) {
                   agg.ProcessTreeNodePrediction1(scores[batch_num * SafeInt<ptrdiff_t>(N) + i],
-                                                 *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
+                                                 *leaves[onnxruntime::narrow<size_t>(i - begin_n)]);
                 }
               }
             });
@@ -570,19 +628,14 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
             }
           });
     } else { /* section E: 1 output, 2+ rows, parallelization by rows */
-      concurrency::ThreadPool::TryBatchParallelFor(
+      auto num_threads = std::min<int32_t>(max_num_threads, SafeInt<int32_t>(N));
+      concurrency::ThreadPool::TrySimpleParallelFor(
           ttp,
-          SafeInt<int32_t>(N),
-          [this, &agg, x_data, z_data, stride, label_data](ptrdiff_t i) {
-            ScoreValue<ThresholdType> score = {0, 0};
-            for (size_t j = 0; j < static_cast<size_t>(n_trees_); ++j) {
-              agg.ProcessTreeNodePrediction1(score, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride));
-            }
-
-            agg.FinalizeScores1(z_data + i, score,
-                                label_data == nullptr ? nullptr : (label_data + i));
-          },
-          max_num_threads);
+          num_threads,
+          [this, &agg, num_threads, x_data, z_data, label_data, N, stride](ptrdiff_t batch_num) {
+            auto work = concurrency::ThreadPool::PartitionWork(batch_num, onnxruntime::narrow<ptrdiff_t>(num_threads), onnxruntime::narrow<ptrdiff_t>(N));
+            ComputeAggRowBatches(x_data, z_data, label_data, work.start, work.end, stride, agg);
+          });
     }
   } else {
     if (N == 1) {                                               /* section A2: 2+ outputs, 1 row, not enough trees to parallelize */
@@ -611,29 +664,7 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
         agg.FinalizeScores(scores[0], z_data, -1, label_data);
       }
     } else if (N <= parallel_N_ || max_num_threads == 1) { /* section C2: 2+ outputs, 2+ rows, not enough rows to parallelize */
-      std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(parallel_tree_N_);
-      size_t j, limit;
-      int64_t i, batch, batch_end;
-      batch_end = std::min(N, static_cast<int64_t>(parallel_tree_N_));
-      for (i = 0; i < batch_end; ++i) {
-        scores[SafeInt<ptrdiff_t>(i)].resize(onnxruntime::narrow<size_t>(n_targets_or_classes_));
-      }
-      for (batch = 0; batch < N; batch += parallel_tree_N_) {
-        batch_end = std::min(N, batch + parallel_tree_N_);
-        for (i = batch; i < batch_end; ++i) {
-          std::fill(scores[SafeInt<ptrdiff_t>(i - batch)].begin(), scores[SafeInt<ptrdiff_t>(i - batch)].end(), ScoreValue<ThresholdType>({0, 0}));
-        }
-        for (j = 0, limit = roots_.size(); j < limit; ++j) {
-          for (i = batch; i < batch_end; ++i) {
-            agg.ProcessTreeNodePrediction(scores[SafeInt<ptrdiff_t>(i - batch)], *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-          }
-        }
-        for (i = batch; i < batch_end; ++i) {
-          agg.FinalizeScores(scores[SafeInt<ptrdiff_t>(i - batch)], z_data + i * n_targets_or_classes_, -1,
-                             label_data == nullptr ? nullptr : (label_data + i));
-        }
-      }
-
+      ComputeAggRowBatches(x_data, z_data, label_data, 0, N, stride, agg);
     } else if (n_trees_ >= max_num_threads) { /* section: D2: 2+ outputs, 2+ rows, enough trees to parallelize*/
       auto num_threads = std::min<int32_t>(max_num_threads, SafeInt<int32_t>(n_trees_));
       std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(SafeInt<size_t>(num_threads) * N);
@@ -645,13 +676,15 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
             num_threads,
             [this, &agg, &scores, num_threads, x_data, N, stride, begin_n, end_n](ptrdiff_t batch_num) {
               auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_threads, onnxruntime::narrow<size_t>(this->n_trees_));
+              std::vector<TreeNodeElement<ThresholdType>*> leaves(onnxruntime::narrow<size_t>(end_n - begin_n));
               for (int64_t i = begin_n; i < end_n; ++i) {
                 scores[batch_num * SafeInt<ptrdiff_t>(N) + i].resize(onnxruntime::narrow<size_t>(n_targets_or_classes_), {0, 0});
               }
               for (auto j = work.start; j < work.end; ++j) {
+                ProcessTreeNodeLeaves(roots_[j], x_data + begin_n * stride, stride, leaves.size(), leaves.data());
                 for (int64_t i = begin_n; i < end_n; ++i) {
                   agg.ProcessTreeNodePrediction(scores[batch_num * SafeInt<ptrdiff_t>(N) + i],
-                                                *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
+                                                *leaves[onnxruntime::narrow<size_t>(i - begin_n)], weights_);
                 }
               }
             });
@@ -676,25 +709,171 @@ void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAgg(concur
           ttp,
           num_threads,
           [this, &agg, num_threads, x_data, z_data, label_data, N, stride](ptrdiff_t batch_num) {
-            size_t j, limit;
-            InlinedVector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_targets_or_classes_));
             auto work = concurrency::ThreadPool::PartitionWork(batch_num, onnxruntime::narrow<ptrdiff_t>(num_threads), onnxruntime::narrow<ptrdiff_t>(N));
-
-            for (auto i = work.start; i < work.end; ++i) {
-              std::fill(scores.begin(), scores.end(), ScoreValue<ThresholdType>({0, 0}));
-              for (j = 0, limit = roots_.size(); j < limit; ++j) {
-                agg.ProcessTreeNodePrediction(scores, *ProcessTreeNodeLeave(roots_[j], x_data + i * stride), weights_);
-              }
-
-              agg.FinalizeScores(scores,
-                                 z_data + i * n_targets_or_classes_, -1,
-                                 label_data == nullptr ? nullptr : (label_data + i));
-            }
+            ComputeAggRowBatches(x_data, z_data, label_data, work.start, work.end, stride, agg);
           });
     }
   }
 }  // namespace detail
 
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename AGG, typename ROW_SCORER>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAggByRows(
+    concurrency::ThreadPool* ttp, const InputType* x_data, OutputType* z_data, int64_t* label_data,
+    int64_t N, int64_t stride, const AGG& agg, const ROW_SCORER& row_scorer) const {
+  // Rows are split among threads, every thread evaluates all trees for its rows.
+  // Trees are aggregated in the same order as ProcessTreeNodeLeave would visit them.
+  auto num_threads = std::min<int32_t>(concurrency::ThreadPool::DegreeOfParallelism(ttp), SafeInt<int32_t>(N));
+  concurrency::ThreadPool::TrySimpleParallelFor(
+      ttp,
+      num_threads,
+      [this, &agg, &row_scorer, num_threads, x_data, z_data, label_data, N, stride](ptrdiff_t batch_num) {
+        const size_t n_trees = onnxruntime::narrow<size_t>(n_trees_);
+        std::vector<typename ROW_SCORER::ScratchType> scratch(row_scorer.ScratchSize());
+        auto work = concurrency::ThreadPool::PartitionWork(batch_num, onnxruntime::narrow<ptrdiff_t>(num_threads),
+                                                           onnxruntime::narrow<ptrdiff_t>(N));
+        if (n_targets_or_classes_ == 1) {
+          for (auto i = work.start; i < work.end; ++i) {
+            ScoreValue<ThresholdType> score = {0, 0};
+            const InputType* x_row = x_data + i * stride;
+            row_scorer.PrepareRow(x_row, scratch.data());
+            for (size_t j = 0; j < n_trees; ++j) {
+              agg.ProcessTreeNodePrediction1(score, row_scorer.Leaf(j, scratch.data()), weights_);
+            }
+            agg.FinalizeScores1(z_data + i, score, label_data == nullptr ? nullptr : (label_data + i));
+          }
+        } else {
+          InlinedVector<ScoreValue<ThresholdType>> scores(onnxruntime::narrow<size_t>(n_targets_or_classes_));
+          for (auto i = work.start; i < work.end; ++i) {
+            std::fill(scores.begin(), scores.end(), ScoreValue<ThresholdType>({0, 0}));
+            const InputType* x_row = x_data + i * stride;
+            row_scorer.PrepareRow(x_row, scratch.data());
+            for (size_t j = 0; j < n_trees; ++j) {
+              agg.ProcessTreeNodePrediction(scores, row_scorer.Leaf(j, scratch.data()), weights_);
+            }
+            agg.FinalizeScores(scores, z_data + i * n_targets_or_classes_, -1,
+                               label_data == nullptr ? nullptr : (label_data + i));
+          }
+        }
+      });
+}
+
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename AGG>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ComputeAggRowBatches(
+    const InputType* x_data, OutputType* z_data, int64_t* label_data, int64_t begin, int64_t end, int64_t stride,
+    const AGG& agg) const {
+  // The computation is split into batches of parallel_tree_N_ rows, and then loop on trees to evaluate
+  // every tree on this batch.
+  // This change was introduced by PR: https://github.com/microsoft/onnxruntime/pull/13835.
+  // The input tensor (2D) is stored in a contiguous array. Therefore, it is faster
+  // to loop on tree first and inside that loop evaluate a tree on the input tensor (inner loop).
+  // The processor is faster when it has to move chunks of a contiguous array (branching).
+  // However, if the input tensor is too big, the data does not hold on caches (L1, L2, L3).
+  // In that case, looping first on tree or on data is almost the same. That's why the first loop
+  // split into batch so that every batch holds on caches, then loop on trees and finally loop
+  // on the batch rows.
+  const size_t batch_size = onnxruntime::narrow<size_t>(std::min<int64_t>(end - begin, parallel_tree_N_));
+  std::vector<TreeNodeElement<ThresholdType>*> leaves(batch_size);
+  if (n_targets_or_classes_ == 1) {
+    std::vector<ScoreValue<ThresholdType>> scores(batch_size);
+    for (int64_t batch = begin; batch < end; batch += parallel_tree_N_) {
+      const size_t n_rows = onnxruntime::narrow<size_t>(std::min<int64_t>(end - batch, parallel_tree_N_));
+      std::fill_n(scores.begin(), n_rows, ScoreValue<ThresholdType>({0, 0}));
+      for (size_t j = 0, limit = roots_.size(); j < limit; ++j) {
+        ProcessTreeNodeLeaves(roots_[j], x_data + batch * stride, stride, n_rows, leaves.data());
+        for (size_t i = 0; i < n_rows; ++i) {
+          agg.ProcessTreeNodePrediction1(scores[i], *leaves[i]);
+        }
+      }
+      for (size_t i = 0; i < n_rows; ++i) {
+        const int64_t row = batch + static_cast<int64_t>(i);
+        agg.FinalizeScores1(z_data + row, scores[i], label_data == nullptr ? nullptr : (label_data + row));
+      }
+    }
+  } else {
+    std::vector<InlinedVector<ScoreValue<ThresholdType>>> scores(
+        batch_size, InlinedVector<ScoreValue<ThresholdType>>(onnxruntime::narrow<size_t>(n_targets_or_classes_)));
+    for (int64_t batch = begin; batch < end; batch += parallel_tree_N_) {
+      const size_t n_rows = onnxruntime::narrow<size_t>(std::min<int64_t>(end - batch, parallel_tree_N_));
+      for (size_t i = 0; i < n_rows; ++i) {
+        std::fill(scores[i].begin(), scores[i].end(), ScoreValue<ThresholdType>({0, 0}));
+      }
+      for (size_t j = 0, limit = roots_.size(); j < limit; ++j) {
+        ProcessTreeNodeLeaves(roots_[j], x_data + batch * stride, stride, n_rows, leaves.data());
+        for (size_t i = 0; i < n_rows; ++i) {
+          agg.ProcessTreeNodePrediction(scores[i], *leaves[i], weights_);
+        }
+      }
+      for (size_t i = 0; i < n_rows; ++i) {
+        const int64_t row = batch + static_cast<int64_t>(i);
+        agg.FinalizeScores(scores[i], z_data + row * n_targets_or_classes_, -1,
+                           label_data == nullptr ? nullptr : (label_data + row));
+      }
+    }
+  }
+}
+
+template <typename InputType, typename ThresholdType, typename OutputType>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeaves(
+    TreeNodeElement<ThresholdType>* root, const InputType* x_data, int64_t stride, size_t n_rows,
+    TreeNodeElement<ThresholdType>** leaves) const {
+  // The interleaved walk covers the usual ensembles, a single comparison rule without missing value tracks.
+  if (same_mode_ && !has_missing_tracks_) {
+    switch (root->mode()) {
+      case NODE_MODE_ORT::BRANCH_LEQ:
+        ProcessTreeNodeLeavesInterleaved(root, x_data, stride, n_rows, leaves, std::less_equal<>());
+        return;
+      case NODE_MODE_ORT::BRANCH_LT:
+        ProcessTreeNodeLeavesInterleaved(root, x_data, stride, n_rows, leaves, std::less<>());
+        return;
+      case NODE_MODE_ORT::BRANCH_GTE:
+        ProcessTreeNodeLeavesInterleaved(root, x_data, stride, n_rows, leaves, std::greater_equal<>());
+        return;
+      case NODE_MODE_ORT::BRANCH_GT:
+        ProcessTreeNodeLeavesInterleaved(root, x_data, stride, n_rows, leaves, std::greater<>());
+        return;
+      default:
+        break;
+    }
+  }
+  for (size_t i = 0; i < n_rows; ++i) {
+    leaves[i] = ProcessTreeNodeLeave(root, x_data + static_cast<int64_t>(i) * stride);
+  }
+}
+
+// Walks kInterleavedRows rows down the same tree together, one level per iteration. A single row waits
+// for the load of every node before it knows the next one. The rows of a group are independent,
+// so the processor overlaps their loads and hides most of that latency. Rows already on a leaf stay there.
+// The last group is padded with copies of its last row to keep a fixed number of rows the compiler can unroll.
+template <typename InputType, typename ThresholdType, typename OutputType>
+template <typename CMP>
+void TreeEnsembleCommon<InputType, ThresholdType, OutputType>::ProcessTreeNodeLeavesInterleaved(
+    TreeNodeElement<ThresholdType>* root, const InputType* x_data, int64_t stride, size_t n_rows,
+    TreeNodeElement<ThresholdType>** leaves, CMP cmp) {
+  TreeNodeElement<ThresholdType>* nodes[kInterleavedRows];
+  const InputType* rows[kInterleavedRows];
+  for (size_t first = 0; first < n_rows; first += kInterleavedRows) {
+    const size_t count = std::min(kInterleavedRows, n_rows - first);
+    for (size_t k = 0; k < kInterleavedRows; ++k) {
+      nodes[k] = root;
+      rows[k] = x_data + static_cast<int64_t>(first + std::min(k, count - 1)) * stride;
+    }
+    for (bool moved = true; moved;) {
+      moved = false;
+      for (size_t k = 0; k < kInterleavedRows; ++k) {
+        TreeNodeElement<ThresholdType>* node = nodes[k];
+        if (node->is_not_leaf()) {
+          nodes[k] = cmp(rows[k][node->feature_id], node->value_or_unique_weight) ? node->truenode_or_weight.ptr
+                                                                                    : node + 1;
+          moved = true;
+        }
+      }
+    }
+    std::copy_n(nodes, count, leaves + first);
+  }
+}
+
 #define TREE_FIND_VALUE(CMP)                                                                           \
   if (has_missing_tracks_) {                                                                           \
     while (root->is_not_leaf()) {                                                                      \
@@ -839,7 +1018,9 @@ class TreeEnsembleCommonClassifier : public TreeEnsembleCommon<InputType, Thresh
 template <typename InputType, typename ThresholdType, typename OutputType>
 Status TreeEnsembleCommonClassifier<InputType, ThresholdType, OutputType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV3<ThresholdType> attributes(info, true);
-  return Init(80, 128, 50, attributes);
+  ORT_RETURN_IF_ERROR(Init(80, 128, 50, attributes));
+  this->CompactNodesIfRequested(info);
+  return Status::OK();
 }
 
 template <typename InputType, typename ThresholdType, typename OutputType>
@@ -881,7 +1062,7 @@ Status TreeEnsembleCommonClassifier<InputType, ThresholdType, OutputType>::compu
     this->ComputeAgg(
         ctx->GetOperatorThreadPool(), X, Z, label,
         TreeAggregatorClassifier<InputType, ThresholdType, OutputType>(
-            this->roots_.size(), this->n_targets_or_classes_,
+            onnxruntime::narrow<size_t>(this->n_trees_), this->n_targets_or_classes_,
             this->post_transform_, this->base_values_,
             classlabels_int64s_, binary_case_,
             weights_are_all_positive_));
@@ -893,7 +1074,7 @@ Status TreeEnsembleCommonClassifier<InputType, ThresholdType, OutputType>::compu
     this->ComputeAgg(
         ctx->GetOperatorThreadPool(), X, Z, &label_int64,
         TreeAggregatorClassifier<InputType, ThresholdType, OutputType>(
-            this->roots_.size(), this->n_targets_or_classes_,
+            onnxruntime::narrow<size_t>(this->n_trees_), this->n_targets_or_classes_,
             this->post_transform_, this->base_values_,
             class_labels_, binary_case_,
             weights_are_all_positive_));
@@ -919,7 +1100,9 @@ class TreeEnsembleCommonV5 : public TreeEnsembleCommon<IOType, ThresholdType, IO
 template <typename IOType, typename ThresholdType>
 Status TreeEnsembleCommonV5<IOType, ThresholdType>::Init(const OpKernelInfo& info) {
   TreeEnsembleAttributesV5<ThresholdType> attributes(info);
-  return Init(80, 128, 50, attributes);
+  ORT_RETURN_IF_ERROR(Init(80, 128, 50, attributes));
+  this->CompactNodesIfRequested(info);
+  return Status::OK();
 }
 
 template <typename IOType, typename ThresholdType>
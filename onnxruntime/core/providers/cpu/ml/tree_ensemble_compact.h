@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "tree_ensemble_aggregator.h"
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+/**
+ * Compact copy of the nodes of a tree ensemble. A branch node takes 8 bytes instead of
+ * sizeof(TreeNodeElement): a 16-bit feature index, the 16-bit position of its threshold
+ * in the sorted table of the distinct thresholds of that feature, and the 32-bit offset
+ * of its true child. The false child is the next node as in TreeEnsembleCommon::nodes_.
+ * A leaf only keeps the range of its weights in TreeEnsembleCommon::weights_, in a separate
+ * vector referenced by its index.
+ *
+ * Every row is binned once: for every feature, bin is the number of thresholds x falls above
+ * (lower bound for BRANCH_LEQ, upper bound for BRANCH_LT, the table size for NaN). Then
+ * x <= t[k] (or x < t[k]) is equivalent to bin <= k and the trees compare integers only.
+ * The result is exactly the one of the float comparisons.
+ *
+ * Only ensembles with all branch nodes in mode BRANCH_LEQ or BRANCH_LT, no missing value tracks,
+ * no NaN threshold, fewer than 65535 distinct features and fewer than 65535 distinct thresholds
+ * per feature can be stored this way. Init returns false otherwise.
+ */
+template <typename ThresholdType>
+class TreeEnsembleCompactNodes {
+ public:
+  bool Init(const std::vector<TreeNodeElement<ThresholdType>>& nodes,
+            const std::vector<TreeNodeElement<ThresholdType>*>& roots,
+            int64_t max_feature_id) {
+    if (roots.empty() || nodes.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+      return false;
+    }
+
+    // Distinct thresholds of every feature.
+    std::vector<std::vector<ThresholdType>> thresholds(onnxruntime::narrow<size_t>(max_feature_id + 1));
+    NODE_MODE_ORT mode = NODE_MODE_ORT::LEAF;
+    for (const auto& node : nodes) {
+      if (!node.is_not_leaf()) {
+        continue;
+      }
+      if (node.is_missing_track_true() ||
+          (node.mode() != NODE_MODE_ORT::BRANCH_LEQ && node.mode() != NODE_MODE_ORT::BRANCH_LT) ||
+          (mode != NODE_MODE_ORT::LEAF && node.mode() != mode) ||
+          std::isnan(node.value_or_unique_weight)) {
+        return false;
+      }
+      mode = node.mode();
+      thresholds[onnxruntime::narrow<size_t>(node.feature_id)].push_back(node.value_or_unique_weight);
+    }
+
+    std::vector<uint16_t> feature_index(thresholds.size(), kLeaf);
+    features_.clear();
+    thresholds_.clear();
+    for (size_t feature = 0; feature < thresholds.size(); ++feature) {
+      auto& values = thresholds[feature];
+      if (values.empty()) {
+        continue;
+      }
+      std::sort(values.begin(), values.end());
+      values.erase(std::unique(values.begin(), values.end()), values.end());
+      if (features_.size() >= kLeaf || values.size() >= kLeaf) {
+        return false;
+      }
+      feature_index[feature] = static_cast<uint16_t>(features_.size());
+      features_.push_back({feature, thresholds_.size(), thresholds_.size() + values.size()});
+      thresholds_.insert(thresholds_.end(), values.begin(), values.end());
+    }
+
+    nodes_.resize(nodes.size());
+    leaves_.clear();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      const auto& node = nodes[i];
+      Node& compact = nodes_[i];
+      if (!node.is_not_leaf()) {
+        compact.feature = kLeaf;
+        compact.bin = 0;
+        compact.offset = static_cast<int32_t>(leaves_.size());
+        leaves_.push_back(node.truenode_or_weight.weight_data);
+        continue;
+      }
+      const FeatureRange& feature = features_[feature_index[onnxruntime::narrow<size_t>(node.feature_id)]];
+      auto it = std::lower_bound(thresholds_.begin() + feature.begin, thresholds_.begin() + feature.end,
+                                 node.value_or_unique_weight);
+      compact.feature = feature_index[onnxruntime::narrow<size_t>(node.feature_id)];
+      compact.bin = static_cast<uint16_t>(it - (thresholds_.begin() + feature.begin));
+      compact.offset = static_cast<int32_t>(node.truenode_or_weight.ptr - &node);
+    }
+
+    roots_.clear();
+    roots_.reserve(roots.size());
+    for (const auto* root : roots) {
+      roots_.push_back(static_cast<uint32_t>(root - nodes.data()));
+    }
+    strict_ = mode == NODE_MODE_ORT::BRANCH_LT;
+    return true;
+  }
+
+  // Interface used by TreeEnsembleCommon::ComputeAggByRows: PrepareRow fills ScratchSize() values of ScratchType
+  // for one row, then Leaf returns the weights of the exit leaf of every tree for that row.
+  using ScratchType = uint16_t;
+
+  size_t ScratchSize() const { return features_.size(); }
+
+  // Fills bins (one per feature used by the ensemble) for one row.
+  template <typename InputType>
+  void PrepareRow(const InputType* x_data, uint16_t* bins) const {
+    for (size_t f = 0; f < features_.size(); ++f) {
+      const FeatureRange& feature = features_[f];
+      const InputType val = x_data[feature.feature_id];
+      auto begin = thresholds_.begin() + feature.begin;
+      auto end = thresholds_.begin() + feature.end;
+      if (std::isnan(val)) {
+        // NaN goes to the false branch of every node.
+        bins[f] = static_cast<uint16_t>(end - begin);
+      } else if (strict_) {
+        // x < t[k] <=> bin <= k with bin the number of thresholds t <= x.
+        bins[f] = static_cast<uint16_t>(
+            std::upper_bound(begin, end, val, [](InputType v, ThresholdType t) { return v < t; }) - begin);
+      } else {
+        // x <= t[k] <=> bin <= k with bin the number of thresholds t < x.
+        bins[f] = static_cast<uint16_t>(
+            std::lower_bound(begin, end, val, [](ThresholdType t, InputType v) { return t < v; }) - begin);
+      }
+    }
+  }
+
+  const typename PtrOrWeight<ThresholdType>::WeightData& Leaf(size_t tree, const uint16_t* bins) const {
+    const Node* node = nodes_.data() + roots_[tree];
+    while (node->feature != kLeaf) {
+      node += bins[node->feature] <= node->bin ? node->offset : 1;
+    }
+    return leaves_[node->offset];
+  }
+
+ private:
+  static constexpr uint16_t kLeaf = std::numeric_limits<uint16_t>::max();
+
+  struct Node {
+    uint16_t feature;  // kLeaf for a leaf
+    uint16_t bin;
+    int32_t offset;  // offset of the true child, or index in leaves_ for a leaf
+  };
+  static_assert(sizeof(Node) == 8, "unexpected padding in TreeEnsembleCompactNodes::Node");
+
+  struct FeatureRange {
+    size_t feature_id;
+    size_t begin;
+    size_t end;
+  };
+
+  std::vector<Node> nodes_;
+  std::vector<uint32_t> roots_;
+  std::vector<FeatureRange> features_;
+  std::vector<ThresholdType> thresholds_;
+  std::vector<typename PtrOrWeight<ThresholdType>::WeightData> leaves_;
+  bool strict_ = false;
+};
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "tree_ensemble_aggregator.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+namespace onnxruntime {
+namespace ml {
+namespace detail {
+
+inline uint32_t CountTrailingZeros(uint64_t value) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<uint32_t>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+  return static_cast<uint32_t>(__builtin_ctzll(value));
+#else
+  uint32_t index = 0;
+  while ((value & 1) == 0) {
+    value >>= 1;
+    ++index;
+  }
+  return index;
+#endif
+}
+
+/**
+ * Evaluates all trees of an ensemble for one row with the QuickScorer algorithm
+ * (Lucchese et al., "QuickScorer: a Fast Algorithm to Rank Documents with Additive Ensembles of Regression Trees").
+ * The leaves of every tree are numbered from left to right, the true branch being the left one.
+ * Every branch node stores a bitvector with zeros for the leaves of its true subtree. For one row,
+ * the bitvector of a tree is the AND of the bitvectors of all its false nodes and the exit leaf is
+ * the first bit still set. Nodes are grouped by feature and sorted by threshold so that the false
+ * nodes of a feature are a prefix of its list: the evaluation scans contiguous memory and stops at
+ * the first true node instead of following pointers tree by tree.
+ *
+ * Only ensembles of trees with at most 64 leaves, all branch nodes in mode BRANCH_LEQ or BRANCH_LT and
+ * no missing value tracks can be evaluated this way. Init returns false otherwise.
+ */
+template <typename ThresholdType>
+class TreeEnsembleQuickScorer {
+ public:
+  static constexpr size_t kMaxLeaves = 64;
+
+  bool Init(const std::vector<TreeNodeElement<ThresholdType>>& nodes,
+            const std::vector<TreeNodeElement<ThresholdType>*>& roots,
+            int64_t max_feature_id) {
+    if (roots.empty()) {
+      return false;
+    }
+
+    std::vector<std::vector<Node>> nodes_by_feature(onnxruntime::narrow<size_t>(max_feature_id + 1));
+    std::vector<bool> visited(nodes.size(), false);
+    NODE_MODE_ORT mode = NODE_MODE_ORT::LEAF;
+    std::vector<const TreeNodeElement<ThresholdType>*> tree_leaves;
+    tree_leaves.reserve(kMaxLeaves);
+
+    leaf_offsets_.clear();
+    leaf_offsets_.reserve(roots.size());
+    leaves_.clear();
+    for (size_t tree = 0; tree < roots.size(); ++tree) {
+      tree_leaves.clear();
+      if (!AddTree(roots[tree], nodes.data(), static_cast<uint32_t>(tree), mode, visited, tree_leaves,
+                   nodes_by_feature)) {
+        return false;
+      }
+      leaf_offsets_.push_back(static_cast<uint32_t>(leaves_.size()));
+      leaves_.insert(leaves_.end(), tree_leaves.begin(), tree_leaves.end());
+    }
+
+    strict_ = mode == NODE_MODE_ORT::BRANCH_LT;
+    nodes_.clear();
+    features_.clear();
+    for (size_t feature = 0; feature < nodes_by_feature.size(); ++feature) {
+      auto& feature_nodes = nodes_by_feature[feature];
+      if (feature_nodes.empty()) {
+        continue;
+      }
+      std::stable_sort(feature_nodes.begin(), feature_nodes.end(),
+                       [](const Node& a, const Node& b) { return a.threshold < b.threshold; });
+      features_.push_back({feature, nodes_.size(), nodes_.size() + feature_nodes.size()});
+      nodes_.insert(nodes_.end(), feature_nodes.begin(), feature_nodes.end());
+    }
+    return true;
+  }
+
+  // Interface used by TreeEnsembleCommon::ComputeAggByRows: PrepareRow fills ScratchSize() values of ScratchType
+  // for one row, then Leaf returns the weights of the exit leaf of every tree for that row.
+  using ScratchType = uint64_t;
+
+  size_t ScratchSize() const { return leaf_offsets_.size(); }
+
+  // Fills leaf_masks (one per tree) for one row.
+  template <typename InputType>
+  void PrepareRow(const InputType* x_data, uint64_t* leaf_masks) const {
+    std::fill_n(leaf_masks, leaf_offsets_.size(), ~static_cast<uint64_t>(0));
+    for (const auto& feature : features_) {
+      const InputType val = x_data[feature.feature_id];
+      const Node* node = nodes_.data() + feature.begin;
+      const Node* end = nodes_.data() + feature.end;
+      // The comparisons are written as in ProcessTreeNodeLeave so that NaN goes to the false branch of every node.
+      if (strict_) {
+        for (; node != end && !(val < node->threshold); ++node) {
+          leaf_masks[node->tree_id] &= node->mask;
+        }
+      } else {
+        for (; node != end && !(val <= node->threshold); ++node) {
+          leaf_masks[node->tree_id] &= node->mask;
+        }
+      }
+    }
+  }
+
+  const typename PtrOrWeight<ThresholdType>::WeightData& Leaf(size_t tree, const uint64_t* leaf_masks) const {
+    return leaves_[leaf_offsets_[tree] + CountTrailingZeros(leaf_masks[tree])]->truenode_or_weight.weight_data;
+  }
+
+ private:
+  struct Node {
+    ThresholdType threshold;
+    uint32_t tree_id;
+    uint64_t mask;
+  };
+
+  struct FeatureRange {
+    size_t feature_id;
+    size_t begin;
+    size_t end;
+  };
+
+  static bool AddTree(const TreeNodeElement<ThresholdType>* node,
+                      const TreeNodeElement<ThresholdType>* nodes_begin,
+                      uint32_t tree_id,
+                      NODE_MODE_ORT& mode,
+                      std::vector<bool>& visited,
+                      std::vector<const TreeNodeElement<ThresholdType>*>& tree_leaves,
+                      std::vector<std::vector<Node>>& nodes_by_feature) {
+    // Subtrees shared by several nodes (see AddNodes) cannot be numbered left to right.
+    const size_t position = static_cast<size_t>(node - nodes_begin);
+    if (visited[position]) {
+      return false;
+    }
+    visited[position] = true;
+
+    if (!node->is_not_leaf()) {
+      if (tree_leaves.size() == kMaxLeaves) {
+        return false;
+      }
+      tree_leaves.push_back(node);
+      return true;
+    }
+
+    if (node->is_missing_track_true() ||
+        (node->mode() != NODE_MODE_ORT::BRANCH_LEQ && node->mode() != NODE_MODE_ORT::BRANCH_LT) ||
+        (mode != NODE_MODE_ORT::LEAF && node->mode() != mode)) {
+      return false;
+    }
+    mode = node->mode();
+
+    const size_t first_leaf = tree_leaves.size();
+    if (!AddTree(node->truenode_or_weight.ptr, nodes_begin, tree_id, mode, visited, tree_leaves, nodes_by_feature)) {
+      return false;
+    }
+    // The false subtree holds at least one leaf so the true subtree never holds all 64 of them.
+    const size_t n_true_leaves = tree_leaves.size() - first_leaf;
+    const uint64_t true_leaves = ((static_cast<uint64_t>(1) << n_true_leaves) - 1) << first_leaf;
+    nodes_by_feature[onnxruntime::narrow<size_t>(node->feature_id)].push_back(
+        {node->value_or_unique_weight, tree_id, ~true_leaves});
+
+    return AddTree(node + 1, nodes_begin, tree_id, mode, visited, tree_leaves, nodes_by_feature);
+  }
+
+  std::vector<Node> nodes_;
+  std::vector<FeatureRange> features_;
+  std::vector<const TreeNodeElement<ThresholdType>*> leaves_;
+  std::vector<uint32_t> leaf_offsets_;
+  bool strict_ = false;
+};
+
+}  // namespace detail
+}  // namespace ml
+}  // namespace onnxruntime
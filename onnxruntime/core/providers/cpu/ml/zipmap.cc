@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "core/providers/cpu/ml/zipmap.h"
+#include <numeric>
 #include "core/util/math_cpuonly.h"
 /**
 https://github.com/onnx/onnx/blob/main/onnx/defs/traditionalml/defs.cc
@@ -42,6 +43,18 @@ ZipMapOp::ZipMapOp(const OpKernelInfo& info)
   ORT_ENFORCE(classlabels_strings_.empty() ^ classlabels_int64s_.empty(),
               "Must provide classlabels_strings or classlabels_int64s but not both.");
   using_strings_ = !classlabels_strings_.empty();
+
+  const size_t num_labels = using_strings_ ? classlabels_strings_.size() : classlabels_int64s_.size();
+  sorted_label_indices_.resize(num_labels);
+  std::iota(sorted_label_indices_.begin(), sorted_label_indices_.end(), size_t{0});
+  // stable so that the last value wins for duplicated labels, as with operator[]
+  if (using_strings_) {
+    std::stable_sort(sorted_label_indices_.begin(), sorted_label_indices_.end(),
+                     [this](size_t a, size_t b) { return classlabels_strings_[a] < classlabels_strings_[b]; });
+  } else {
+    std::stable_sort(sorted_label_indices_.begin(), sorted_label_indices_.end(),
+                     [this](size_t a, size_t b) { return classlabels_int64s_[a] < classlabels_int64s_[b]; });
+  }
 }
 
 common::Status ZipMapOp::Compute(OpKernelContext* context) const {
@@ -82,8 +95,8 @@ common::Status ZipMapOp::Compute(OpKernelContext* context) const {
     int64_t current_weight_0 = 0;
     for (int64_t n = 0; n < batch_size; n++) {
       std::map<std::string, float> map1;
-      for (int64_t j = 0; j < features_per_batch; j++) {
-        map1[classlabels_strings_[onnxruntime::narrow<size_t>(j)]] = x_data[current_weight_0 + j];
+      for (size_t j : sorted_label_indices_) {
+        map1.insert_or_assign(map1.end(), classlabels_strings_[j], x_data[current_weight_0 + j]);
       }
       current_weight_0 += features_per_batch;
       (*y_data)[onnxruntime::narrow<size_t>(n)] = std::move(map1);
@@ -102,8 +115,8 @@ common::Status ZipMapOp::Compute(OpKernelContext* context) const {
     int64_t current_weight_0 = 0;
     for (int n = 0; n < batch_size; n++) {
       std::map<int64_t, float> map2;
-      for (int j = 0; j < features_per_batch; j++) {
-        map2[classlabels_int64s_[j]] = x_data[current_weight_0 + j];
+      for (size_t j : sorted_label_indices_) {
+        map2.insert_or_assign(map2.end(), classlabels_int64s_[j], x_data[current_weight_0 + j]);
       }
       current_weight_0 += features_per_batch;
       (*y_data)[n] = std::move(map2);
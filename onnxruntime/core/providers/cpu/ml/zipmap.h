@@ -16,6 +16,8 @@ class ZipMapOp final : public OpKernel {
   bool using_strings_;
   std::vector<int64_t> classlabels_int64s_;
   std::vector<std::string> classlabels_strings_;
+  // Positions of the labels sorted by label, so that the maps are filled in key order with an insertion hint.
+  std::vector<size_t> sorted_label_indices_;
 };
 
 }  // namespace ml
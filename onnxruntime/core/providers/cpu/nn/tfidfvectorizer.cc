@@ -8,8 +8,11 @@
 #include "core/framework/tensor.h"
 #include "core/platform/threadpool.h"
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 #include <string_view>
+#include <utility>
 
 namespace onnxruntime {
 
@@ -25,69 +28,92 @@ ONNX_CPU_OPERATOR_KERNEL(
 
 namespace ngram_details {
 
-// NgrampPart implements a Trie like structure
-// for a unigram (1) it would insert into a root map with a valid id.
-// for (1,2,3) node 2 would be a child of 1 but have id == 0
-// because (1,2) does not exists. Node 3 would have a valid id.
-template <class T>
-struct NgramPart;
-
-template <>
-struct NgramPart<int64_t>;
-
-template <>
-struct NgramPart<std::string>;
+inline int64_t PoolItem(int64_t item) { return item; }
+inline std::string_view PoolItem(const std::string& item) { return item; }
 
-using NgramPartInt = NgramPart<int64_t>;
-using NgramPartString = NgramPart<std::string>;
-
-// Avoid recursive class definitions using unique_ptr + forward declaration
-using IntMap = InlinedHashMap<int64_t, std::unique_ptr<NgramPartInt>>;
+// Hash of a trie edge: the node it leaves and the n-gram item it consumes.
+template <class T>
+struct EdgeHash {
+  size_t operator()(const std::pair<uint32_t, T>& edge) const {
+    const uint64_t h = (static_cast<uint64_t>(std::hash<T>{}(edge.second)) + edge.first) * 0x9E3779B97F4A7C15ull;
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
+};
 
 #ifndef DISABLE_ABSEIL
-using StrMap = absl::flat_hash_map<std::reference_wrapper<const std::string>, std::unique_ptr<NgramPartString>,
-                                   std::hash<std::string>, std::equal_to<std::string>>;
+template <class T>
+using EdgeMap = absl::flat_hash_map<std::pair<uint32_t, T>, uint32_t, EdgeHash<T>>;
 #else
-using StrMap = std::unordered_map<std::reference_wrapper<const std::string>, std::unique_ptr<NgramPartString>,
-                                  std::hash<std::string>, std::equal_to<std::string>>;
+template <class T>
+using EdgeMap = std::unordered_map<std::pair<uint32_t, T>, uint32_t, EdgeHash<T>>;
 #endif
 
-template <>
-struct NgramPart<int64_t> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  IntMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
-};
+// NgramTrie holds the n-gram pool. Its nodes are stored in one vector and its edges in
+// one flat hash map keyed by (parent node, item), so moving to the next item of an n-gram
+// is a single probe into contiguous memory instead of a walk through per-node maps.
+// For a unigram (1) the root gets a child with a valid id.
+// For (1,2,3) the node of 2 is a child of 1 but has id == 0
+// because (1,2) does not exist. The node of 3 has a valid id.
+// String items are views of the pool_strings attribute.
+template <class T>
+class NgramTrie {
+ public:
+  static constexpr uint32_t kRoot = 0;
+  static constexpr uint32_t kNoNode = std::numeric_limits<uint32_t>::max();
+
+  NgramTrie() : nodes_(1) {}
+
+  bool empty() const { return edges_.empty(); }
+
+  // Returns next ngram_id
+  template <class ForwardIter>
+  size_t Populate(ForwardIter first, size_t ngrams, size_t ngram_size, size_t ngram_id) {
+    for (; ngrams > 0; --ngrams) {
+      uint32_t node = kRoot;
+      for (size_t n = 0; n < ngram_size; ++n, ++first) {
+        node = AddChild(node, PoolItem(*first));
+      }
+      ORT_ENFORCE(nodes_[node].id == 0, "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
+      nodes_[node].id = ngram_id;
+      ++ngram_id;
+    }
+    return ngram_id;
+  }
 
-template <>
-struct NgramPart<std::string> {
-  size_t id_;  // 0 - means no entry, search for a bigger N
-  StrMap leafs_;
-  explicit NgramPart(size_t id) : id_(id) {}
-};
+  // Returns the child of node reached with item or kNoNode.
+  uint32_t Find(uint32_t node, const T& item) const {
+    if (!nodes_[node].has_children) {
+      return kNoNode;
+    }
+    auto hit = edges_.find(std::make_pair(node, item));
+    return hit == edges_.end() ? kNoNode : hit->second;
+  }
 
-// Returns next ngram_id
-template <class K, class ForwardIter, class Map>
-inline size_t PopulateGrams(ForwardIter first, size_t ngrams, size_t ngram_size, size_t ngram_id,
-                            Map& c) {
-  for (; ngrams > 0; --ngrams) {
-    size_t n = 1;
-    Map* m = &c;
-    while (true) {
-      auto p = m->emplace(*first, std::make_unique<NgramPart<K>>(0));
-      ++first;
-      if (n == ngram_size) {
-        ORT_ENFORCE(p.first->second->id_ == 0, "Duplicate ngram detected, size: ", ngram_size, " id: ", ngram_id);
-        p.first->second->id_ = ngram_id;
-        ++ngram_id;
-        break;
-      }
-      ++n;
-      m = &p.first->second->leafs_;
+  // 0 - means no entry, search for a bigger N
+  size_t Id(uint32_t node) const { return nodes_[node].id; }
+
+ private:
+  uint32_t AddChild(uint32_t node, const T& item) {
+    ORT_ENFORCE(nodes_.size() < kNoNode, "Too many n-gram items in the pool");
+    auto p = edges_.emplace(std::make_pair(node, item), static_cast<uint32_t>(nodes_.size()));
+    if (p.second) {
+      nodes_[node].has_children = true;
+      nodes_.emplace_back();
     }
+    return p.first->second;
   }
-  return ngram_id;
-}
+
+  struct Node {
+    size_t id = 0;
+    bool has_children = false;
+  };
+
+  std::vector<Node> nodes_;
+  EdgeMap<T> edges_;
+};
+
+using IntTrie = NgramTrie<int64_t>;
+using StrTrie = NgramTrie<std::string_view>;
 
 }  // namespace ngram_details
 }  // namespace onnxruntime
@@ -96,10 +122,6 @@ using namespace onnxruntime::ngram_details;
 
 namespace onnxruntime {
 
-inline const void* AdvanceElementPtr(const void* p, size_t elements, size_t element_size) {
-  return reinterpret_cast<const uint8_t*>(p) + elements * element_size;
-}
-
 // The weighting criteria.
 // "TF"(term frequency),
 //    the counts are propagated to output
@@ -134,11 +156,11 @@ struct TfIdfVectorizer::Impl {
   gsl::span<const int64_t> ngram_indexes_;
   gsl::span<const float> weights_;
 
-  // This map contains references to pool_string_ entries
+  // This trie contains references to pool_string_ entries
   // of pool_strings attribute
-  StrMap str_map_;
-  // This map contains pool_int64s entries
-  IntMap int64_map_;
+  StrTrie str_trie_;
+  // This trie contains pool_int64s entries
+  IntTrie int64_trie_;
 
   size_t output_size_ = 0;
 
@@ -153,6 +175,42 @@ struct TfIdfVectorizer::Impl {
     assert(ngram_id < ngram_indexes_.size());
     return SafeInt<size_t>(ngram_indexes_[ngram_id]);
   }
+
+  // Calls fn_weight with the output index of every n-gram of the row found in the pool.
+  // get_item(i) returns the i-th item of the row.
+  template <class T, class GetItem, class FnWeight>
+  void ComputeRow(const NgramTrie<T>& trie, size_t row_size, GetItem get_item, FnWeight fn_weight) const {
+    const auto max_gram_length = onnxruntime::narrow<size_t>(max_gram_length_);
+    const auto max_skip_distance = onnxruntime::narrow<size_t>(max_skip_count_ + 1);  // Convert to distance
+    auto start_ngram_size = onnxruntime::narrow<size_t>(min_gram_length_);
+
+    for (size_t skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
+      for (size_t ngram_start = 0; ngram_start < row_size; ++ngram_start) {
+        // We went far enough so no n-grams of any size can be gathered
+        if (ngram_start + SafeInt<size_t>(skip_distance) * (start_ngram_size - 1) >= row_size) {
+          break;
+        }
+
+        uint32_t node = NgramTrie<T>::kRoot;
+        for (size_t ngram_size = 1, item = ngram_start;
+             ngram_size <= max_gram_length && item < row_size;
+             ++ngram_size, item += skip_distance) {
+          node = trie.Find(node, get_item(item));
+          if (node == NgramTrie<T>::kNoNode) {
+            break;
+          }
+          if (ngram_size >= start_ngram_size && trie.Id(node) != 0) {
+            fn_weight(OutputIdToIncrement(trie.Id(node)));
+          }
+        }
+      }
+      // We count UniGrams only once since they are not affected
+      // by skip distance
+      if (start_ngram_size == 1 && ++start_ngram_size > max_gram_length) {
+        break;
+      }
+    }
+  }
 };
 
 TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), impl_(std::make_unique<Impl>()) {
@@ -241,9 +299,9 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
       // Skip loading into hash_set ngrams that are not in the range of [min_gram_length-max_gram_length]
       if (ngram_size >= min_gram_length && ngram_size <= max_gram_length) {
         if (pool_strings.empty()) {
-          ngram_id = PopulateGrams<int64_t>(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->int64_map_);
+          ngram_id = impl_->int64_trie_.Populate(pool_int64s.begin() + start_idx, ngrams, ngram_size, ngram_id);
         } else {
-          ngram_id = PopulateGrams<std::string>(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id, impl_->str_map_);
+          ngram_id = impl_->str_trie_.Populate(pool_strings.begin() + start_idx, ngrams, ngram_size, ngram_id);
         }
       } else {
         ngram_id += ngrams;
@@ -255,78 +313,6 @@ TfIdfVectorizer::TfIdfVectorizer(const OpKernelInfo& info) : OpKernel(info), imp
 
 TfIdfVectorizer::~TfIdfVectorizer() = default;
 
-void TfIdfVectorizer::ComputeImpl(const void* x_data_raw, size_t elem_size, ptrdiff_t row_num, size_t row_size,
-                                  bool is_input_string, gsl::span<float> output_data,
-                                  std::function<void(size_t, gsl::span<float>&)>& fn_weight) const {
-  const void* const row_begin = AdvanceElementPtr(x_data_raw, row_num * row_size, elem_size);
-  const void* const row_end = AdvanceElementPtr(row_begin, row_size, elem_size);
-
-  const auto& impl = *impl_;
-  const auto max_gram_length = impl.max_gram_length_;
-  const auto max_skip_distance = impl.max_skip_count_ + 1;  // Convert to distance
-  auto start_ngram_size = impl.min_gram_length_;
-  size_t output_idx;
-
-  for (auto skip_distance = 1; skip_distance <= max_skip_distance; ++skip_distance) {
-    auto ngram_start = row_begin;
-    auto const ngram_row_end = row_end;
-
-    while (ngram_start < ngram_row_end) {
-      // We went far enough so no n-grams of any size can be gathered
-      auto at_least_this = AdvanceElementPtr(ngram_start, SafeInt<size_t>(skip_distance) * (start_ngram_size - 1), elem_size);
-      if (at_least_this >= ngram_row_end) {
-        break;
-      }
-
-      auto ngram_item = ngram_start;
-      if (is_input_string) {
-        const std::string* str_item = reinterpret_cast<const std::string*>(ngram_item);
-        const StrMap* str_map = &impl.str_map_;
-        for (auto ngram_size = 1;
-             !str_map->empty() &&
-             ngram_size <= max_gram_length &&
-             str_item < ngram_row_end;
-             ++ngram_size, str_item += skip_distance) {
-          auto hit = str_map->find(*str_item);
-          if (hit == str_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            output_idx = impl.OutputIdToIncrement(hit->second->id_);
-            fn_weight(output_idx, output_data);
-          }
-          str_map = &hit->second->leafs_;
-        }
-      } else {
-        const IntMap* int_map = &impl.int64_map_;
-        for (auto ngram_size = 1;
-             !int_map->empty() &&
-             ngram_size <= max_gram_length &&
-             ngram_item < ngram_row_end;
-             ++ngram_size, ngram_item = AdvanceElementPtr(ngram_item, skip_distance, elem_size)) {
-          int64_t val = (elem_size == 4) ? int64_t{*reinterpret_cast<const int32_t*>(ngram_item)} : *reinterpret_cast<const int64_t*>(ngram_item);
-          auto hit = int_map->find(val);
-          if (hit == int_map->end()) {
-            break;
-          }
-          if (ngram_size >= start_ngram_size && hit->second->id_ != 0) {
-            output_idx = impl.OutputIdToIncrement(hit->second->id_);
-            fn_weight(output_idx, output_data);
-          }
-          int_map = &hit->second->leafs_;
-        }
-      }
-      // Sliding window shift
-      ngram_start = AdvanceElementPtr(ngram_start, 1, elem_size);
-    }
-    // We count UniGrams only once since they are not affected
-    // by skip distance
-    if (start_ngram_size == 1 && ++start_ngram_size > max_gram_length) {
-      break;
-    }
-  }
-}
-
 Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
   auto X = ctx->Input<Tensor>(0);
   auto& input_shape = X->Shape();
@@ -373,8 +359,8 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
   const bool is_input_string = X->IsDataTypeString();
 
   if (total_items == 0 ||
-      (is_input_string && impl_->str_map_.empty()) ||
-      ((X->IsDataType<int32_t>() || X->IsDataType<int64_t>()) && impl_->int64_map_.empty())) {
+      (is_input_string && impl_->str_trie_.empty()) ||
+      ((X->IsDataType<int32_t>() || X->IsDataType<int64_t>()) && impl_->int64_trie_.empty())) {
     // TfidfVectorizer may receive an empty input when it follows a Tokenizer
     // (for example for a string containing only stopwords).
     // TfidfVectorizer returns a zero tensor of shape
@@ -384,29 +370,59 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
     return Status::OK();
   }
 
-  auto x_data_raw = ctx->Input<Tensor>(0)->DataRaw();
-  const auto elem_size = X->DataType()->Size();
-  int32_t num_batches = std::min<int32_t>(concurrency::ThreadPool::DegreeOfParallelism(ctx->GetOperatorThreadPool()) * 2, num_rows);
-
   const auto& w = impl.weights_;
-  std::function<void(size_t, gsl::span<float>&)> fn_weight;
+  const size_t output_size = impl.output_size_;
+  // Every item starts up to max_gram_length probes per skip distance.
+  const TensorOpCost cost{static_cast<double>(C * X->DataType()->Size()),
+                          static_cast<double>(output_size * sizeof(float)),
+                          static_cast<double>(C) * static_cast<double>(impl.max_gram_length_) *
+                              static_cast<double>(impl.max_skip_count_ + 1) * 8.0};
+
+  // Rows are independent: each one is zeroed and filled by the thread that scans it.
+  auto run = [&](const auto& trie, auto get_item, auto fn_weight) {
+    concurrency::ThreadPool::TryParallelFor(
+        ctx->GetOperatorThreadPool(), static_cast<std::ptrdiff_t>(num_rows), cost,
+        [&impl, &trie, get_item, fn_weight, C, output_size, output_data](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (auto row_num = static_cast<size_t>(first); row_num < static_cast<size_t>(last); ++row_num) {
+            float* out = output_data + row_num * output_size;
+            std::fill_n(out, output_size, 0.0f);
+            const size_t row_offset = row_num * C;
+            impl.ComputeRow(
+                trie, C, [&get_item, row_offset](size_t i) { return get_item(row_offset + i); },
+                [out, &fn_weight](size_t i) { fn_weight(out, i); });
+          }
+        });
+  };
+
+  auto run_input = [&](auto fn_weight) {
+    if (is_input_string) {
+      const auto* x_data = X->Data<std::string>();
+      run(impl.str_trie_, [x_data](size_t i) { return std::string_view(x_data[i]); }, fn_weight);
+    } else if (X->IsDataType<int32_t>()) {
+      const auto* x_data = X->Data<int32_t>();
+      run(impl.int64_trie_, [x_data](size_t i) { return int64_t{x_data[i]}; }, fn_weight);
+    } else {
+      const auto* x_data = X->Data<int64_t>();
+      run(impl.int64_trie_, [x_data](size_t i) { return x_data[i]; }, fn_weight);
+    }
+  };
 
   switch (impl.weighting_criteria_) {
     case kTF:
-      fn_weight = [](size_t i, gsl::span<float>& out) { out[i] += 1.0f; };
+      run_input([](float* out, size_t i) { out[i] += 1.0f; });
       break;
     case kIDF:
       if (!w.empty()) {
-        fn_weight = [&w](size_t i, gsl::span<float>& out) { out[i] = w[i]; };
+        run_input([&w](float* out, size_t i) { out[i] = w[i]; });
       } else {
-        fn_weight = [](size_t i, gsl::span<float>& out) { out[i] = 1.0f; };
+        run_input([](float* out, size_t i) { out[i] = 1.0f; });
       }
       break;
     case kTFIDF:
       if (!w.empty()) {
-        fn_weight = [&w](size_t i, gsl::span<float>& out) { out[i] += w[i]; };
+        run_input([&w](float* out, size_t i) { out[i] += w[i]; });
       } else {
-        fn_weight = [](size_t i, gsl::span<float>& out) { out[i] += 1.0f; };
+        run_input([](float* out, size_t i) { out[i] += 1.0f; });
       }
       break;
     case kNone:  // fall-through
@@ -414,18 +430,6 @@ Status TfIdfVectorizer::Compute(OpKernelContext* ctx) const {
       assert(false);
   }
 
-  std::function<void(ptrdiff_t)> fn = [this, C, output_data, x_data_raw, elem_size,
-                                       is_input_string, num_batches, num_rows, &fn_weight](ptrdiff_t batch_num) {
-    // Frequency holder allocate [B..output_size_] and init all to zero.
-    auto work = concurrency::ThreadPool::PartitionWork(batch_num, num_batches, static_cast<size_t>(num_rows));
-    for (auto row_num = work.start; row_num < work.end; ++row_num) {
-      auto out = gsl::span<float>(output_data + row_num * this->impl_->output_size_, this->impl_->output_size_);
-      std::fill(out.begin(), out.end(), 0.0f);
-      ComputeImpl(x_data_raw, elem_size, row_num, C, is_input_string, out, fn_weight);
-    }
-  };
-
-  concurrency::ThreadPool::TrySimpleParallelFor(ctx->GetOperatorThreadPool(), num_batches, std::move(fn));
   return Status::OK();
 }
 
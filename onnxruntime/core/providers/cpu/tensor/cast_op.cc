@@ -1,8 +1,10 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <charconv>
 #include <cstddef>
 #include <cstdio>
+#include <iterator>
 #include <string>
 #include <type_traits>
 
@@ -15,6 +17,7 @@
 #include "core/framework/data_types.h"
 #include "core/framework/element_type_lists.h"
 #include "core/framework/op_kernel.h"
+#include "core/platform/threadpool.h"
 #include "core/providers/cpu/tensor/utils.h"
 #include "core/providers/op_kernel_type_control.h"
 #include "core/util/math_cpuonly.h"
@@ -61,7 +64,6 @@ using IsOrtFloat8Type = boost::mp11::mp_contains<element_type_lists::AllFloat8,
 #endif
 
 // string cast helpers
-// Note: when C++17 is available, use <charconv> functions
 
 // handle floating point output separately
 template <typename SrcType>
@@ -111,7 +113,11 @@ CastToString(const SrcType& input, std::string& output) {
 template <typename SrcType>
 typename std::enable_if<std::is_integral<SrcType>::value, void>::type
 CastToString(const SrcType& input, std::string& output) {
-  output = std::to_string(input);
+  // Format into a stack buffer and assign so that no temporary string is allocated.
+  // Unary plus promotes bool and 8-bit types to int as std::to_string does.
+  char buffer[32];
+  const auto result = std::to_chars(std::begin(buffer), std::end(buffer), +input);
+  output.assign(buffer, result.ptr);
 }
 
 template <typename SrcType>
@@ -196,13 +202,19 @@ struct TensorCaster {
 // tensor X -> string
 template <typename SrcType>
 struct TensorCaster<SrcType, std::string> {
-  void Cast(const OpKernelContext&, const TensorShape& shape, const Tensor& in, Tensor& out) const {
+  void Cast(const OpKernelContext& context, const TensorShape& shape, const Tensor& in, Tensor& out) const {
     const std::ptrdiff_t shape_size = narrow<std::ptrdiff_t>(shape.Size());
     const auto* in_data = in.Data<SrcType>();
     auto* out_data = out.MutableData<std::string>();
-    for (std::ptrdiff_t i = 0; i < shape_size; ++i) {
-      CastToString(in_data[i], out_data[i]);
-    }
+    // Formatting and allocating the strings dominates, so spread it over the thread pool.
+    concurrency::ThreadPool::TryParallelFor(
+        context.GetOperatorThreadPool(), shape_size,
+        TensorOpCost{static_cast<double>(sizeof(SrcType)), static_cast<double>(sizeof(std::string)), 128.0},
+        [in_data, out_data](std::ptrdiff_t first, std::ptrdiff_t last) {
+          for (std::ptrdiff_t i = first; i < last; ++i) {
+            CastToString(in_data[i], out_data[i]);
+          }
+        });
   }
 };
 
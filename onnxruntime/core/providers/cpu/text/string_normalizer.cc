@@ -4,6 +4,7 @@
 #include "string_normalizer.h"
 #include "core/common/common.h"
 #include "core/framework/tensor.h"
+#include "core/platform/threadpool.h"
 // Used below HAS_DEPRECATED_DECLARATIONS
 #include "onnxruntime_config.h"
 
@@ -12,7 +13,10 @@
 #include <locale.h>
 #endif  // _MSC_VER
 
+#include <algorithm>
+#include <cctype>
 #include <codecvt>
+#include <cstring>
 #include <locale>
 #include <functional>
 
@@ -436,6 +440,80 @@ const std::string default_locale("en_US.UTF-8");  // All non-MS and not Apple
 #endif
 
 #endif  // _MSC_VER
+
+// True if all characters are ASCII. Checks 8 bytes at a time.
+inline bool IsAscii(const std::string& str) {
+  const char* p = str.data();
+  size_t n = str.size();
+  uint64_t bits = 0;
+  for (; n >= sizeof(uint64_t); p += sizeof(uint64_t), n -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(uint64_t));
+    bits |= word;
+  }
+  for (; n > 0; ++p, --n) {
+    bits |= static_cast<unsigned char>(*p);
+  }
+  return (bits & 0x8080808080808080ull) == 0;
+}
+
+// Branch free so that the compiler vectorizes it.
+inline void ChangeCaseAscii(StringNormalizer::CaseAction caseaction, const std::string& src, std::string& dest) {
+  assert(caseaction != StringNormalizer::NONE);
+  const char first = caseaction == StringNormalizer::LOWER ? 'A' : 'a';
+  dest.resize(src.size());
+  const char* in = src.data();
+  char* out = dest.data();
+  for (size_t i = 0, lim = src.size(); i < lim; ++i) {
+    const char ch = in[i];
+    const bool is_letter = static_cast<unsigned char>(ch - first) < 26;
+    out[i] = static_cast<char>(ch ^ (static_cast<int>(is_letter) << 5));
+  }
+}
+
+// Writes src with its case changed to dest. ASCII strings are handled in place when
+// ascii_case_change is true, others go through wchar_t. wchar_buffer is reused between calls.
+Status ChangeCase(const Locale& locale, Utf8Converter& converter, bool ascii_case_change,
+                  StringNormalizer::CaseAction caseaction, const std::string& src,
+                  std::wstring& wchar_buffer, std::string& dest) {
+  if (ascii_case_change && IsAscii(src)) {
+    ChangeCaseAscii(caseaction, src, dest);
+    return Status::OK();
+  }
+  size_t wchars = 0;
+  // Checks for invalid UTF-8 characters on Windows
+  ORT_RETURN_IF_ERROR(converter.ComputeRequiredSizeToWideChar(src, wchars));
+  wchar_buffer.resize(wchars);
+  ORT_RETURN_IF_ERROR(converter.ConvertToWideChar(src, wchar_buffer));
+  locale.ChangeCase(caseaction, wchar_buffer);
+  dest.resize(converter.ComputeRequiredSizeToUtf8(wchar_buffer));
+  return converter.ConvertToUtf8(wchar_buffer, dest);
+}
+
+// Strings processed by one task of the thread pool.
+constexpr size_t kStringsPerBatch = 128;
+
+// Calls fn(begin, end) on batches of [0, count) in parallel and returns the first error.
+// fn owns whatever conversion state it needs for its batch.
+template <typename Fn>
+Status ForEachBatch(concurrency::ThreadPool* thread_pool, size_t count, const Fn& fn) {
+  const auto num_batches = static_cast<std::ptrdiff_t>(
+      std::min<size_t>(narrow<size_t>(concurrency::ThreadPool::DegreeOfParallelism(thread_pool)),
+                       (count + kStringsPerBatch - 1) / kStringsPerBatch));
+  if (num_batches <= 1) {
+    return fn(0, count);
+  }
+  InlinedVector<Status> statuses(narrow<size_t>(num_batches));
+  concurrency::ThreadPool::TrySimpleParallelFor(thread_pool, num_batches, [&](std::ptrdiff_t batch) {
+    auto work = concurrency::ThreadPool::PartitionWork(batch, num_batches, static_cast<std::ptrdiff_t>(count));
+    statuses[narrow<size_t>(batch)] = fn(static_cast<size_t>(work.start), static_cast<size_t>(work.end));
+  });
+  for (auto& status : statuses) {
+    ORT_RETURN_IF_ERROR(status);
+  }
+  return Status::OK();
+}
+
 }  // namespace string_normalizer
 
 using namespace string_normalizer;
@@ -461,20 +539,26 @@ StringNormalizer::StringNormalizer(const OpKernelInfo& info) : OpKernel(info) {
 
   locale_name_ = info.GetAttrOrDefault("locale", default_locale);
 
+  // The case of ASCII letters changes within ASCII except in Turkish and Azerbaijani (dotted and dotless i).
+  std::string language = locale_name_.substr(0, 2);
+  std::transform(language.begin(), language.end(), language.begin(),
+                 [](char ch) { return static_cast<char>(std::tolower(static_cast<unsigned char>(ch))); });
+  ascii_case_change_ = language != "tr" && language != "az";
+
   std::vector<std::string> stop_words = info.GetAttrsOrDefault<std::string>("stopwords");
+  stopwords_.reserve(stop_words.size());
   if (is_case_sensitive_) {
-    stopwords_.reserve(stop_words.size());
     for (std::string& s : stop_words) {
       stopwords_.insert(std::move(s));
     }
   } else {
     Locale locale(locale_name_);
     Utf8Converter converter;
-    wstopwords_.reserve(stop_words.size());
-    for (std::string& s : stop_words) {
-      std::wstring wstr = converter.from_bytes(s);
-      locale.ChangeCase(compare_caseaction_, wstr);
-      wstopwords_.insert(std::move(wstr));
+    std::wstring wchar_buffer;
+    for (const std::string& s : stop_words) {
+      std::string word;
+      ORT_THROW_IF_ERROR(ChangeCase(locale, converter, ascii_case_change_, compare_caseaction_, s, wchar_buffer, word));
+      stopwords_.insert(std::move(word));
     }
   }
 }
@@ -507,9 +591,7 @@ Status StringNormalizer::Compute(OpKernelContext* ctx) const {
   }
 
   // Special case, no filtering and no case change
-  if (case_change_action_ == NONE &&
-      ((is_case_sensitive_ && stopwords_.empty()) ||
-       (!is_case_sensitive_ && wstopwords_.empty()))) {
+  if (case_change_action_ == NONE && stopwords_.empty()) {
     output_shape.push_back(C);
     auto output_tensor = ctx->Output(0, output_shape);
     auto const output_data = output_tensor->MutableData<std::string>();
@@ -519,119 +601,77 @@ Status StringNormalizer::Compute(OpKernelContext* ctx) const {
 
   // We need to know the result dimension, and for that we need to filter
   // the words first. If comparison mode is case sensitive, we just go ahead
-  // and compare with the original strings. Otherwise, we need to convert the string
-  // to widechar, lowercase it and then compare. Case-insensitive comparison is complicated
+  // and compare with the original strings. Otherwise, we need to change the case
+  // of the string to compare_caseaction_: ASCII strings directly, other strings
+  // by converting them to widechar. Case-insensitive comparison is complicated
   // for UTF-8 and requires additional dependency.
+  // Strings are processed in batches over the thread pool, every batch owns its converter and buffers.
 
   Locale locale(locale_name_);
-  Utf8Converter converter;
-
-  // Compute the largest widestring buffer needed.
-  size_t max_wide_buffer_len = 0;
-  for (const auto& s : input_span) {
-    size_t wchars = 0;
-    // Checks for invalid UTF-8 characters on Windows
-    ORT_RETURN_IF_ERROR(converter.ComputeRequiredSizeToWideChar(s, wchars));
-    max_wide_buffer_len = std::max(max_wide_buffer_len, wchars);
-  }
+  concurrency::ThreadPool* thread_pool = ctx->GetOperatorThreadPool();
+  const size_t num_strings = input_span.size();
 
-  // Reuse reserved space
-  std::wstring wchar_buffer;
-  wchar_buffer.reserve(max_wide_buffer_len);
-
-  // Output everything and change case as required
-  auto output_no_filtering = [&](const TensorShape& output_shape) {
-    auto output_tensor = ctx->Output(0, output_shape);
-    auto const output_data = output_tensor->MutableData<std::string>();
-    for (size_t i = 0, lim = input_span.size(); i < lim; ++i) {
-      const std::string& s = input_span[i];
-      wchar_buffer.resize(max_wide_buffer_len);
-      ORT_RETURN_IF_ERROR(converter.ConvertToWideChar(s, wchar_buffer));
-      locale.ChangeCase(case_change_action_, wchar_buffer);
-
-      auto& dest = output_data[i];
-      size_t utf8_buffer_len = converter.ComputeRequiredSizeToUtf8(wchar_buffer);
-      dest.resize(utf8_buffer_len);
-      ORT_RETURN_IF_ERROR(converter.ConvertToUtf8(wchar_buffer, dest));
-    }
-    return Status::OK();
-  };
-
-  auto output_filtered = [&](const TensorShape& output_shape, gsl::span<const size_t> filtered_indices) {
-    auto output_tensor = ctx->Output(0, output_shape);
-    auto output_data = output_tensor->MutableData<std::string>();
-    for (size_t i : filtered_indices) {
-      const std::string& s = input_span[i];
-      if (case_change_action_ != NONE) {
-        wchar_buffer.resize(max_wide_buffer_len);
-        ORT_RETURN_IF_ERROR(converter.ConvertToWideChar(s, wchar_buffer));
-        locale.ChangeCase(case_change_action_, wchar_buffer);
-
-        auto& dest = *output_data++;
-        size_t utf8_buffer_len = converter.ComputeRequiredSizeToUtf8(wchar_buffer);
-        dest.resize(utf8_buffer_len);
-        ORT_RETURN_IF_ERROR(converter.ConvertToUtf8(wchar_buffer, dest));
-      } else {
-        *output_data++ = s;
-      }
-    }
-    return Status::OK();
-  };
-
-  Status status;
-
-  if (is_case_sensitive_) {
-    if (stopwords_.empty()) {
-      assert(case_change_action_ != NONE);
-      output_shape.push_back(C);
-      status = output_no_filtering(output_shape);
-    } else {
-      // we need to filter
-      InlinedVector<size_t> filtered_strings_indices;
-      filtered_strings_indices.reserve(input_span.size());
-
-      for (size_t i = 0, lim = input_span.size(); i < lim; ++i) {
-        const std::string& s = input_span[i];
-        if (stopwords_.count(s) == 0) {
-          filtered_strings_indices.push_back(i);
-        }
-      }
-
-      // According to the spec, if all strings are filtered out
-      // the output must have a shape of {1} with a single empty string.
-      const int64_t filtered_count = std::max<int64_t>(1, narrow<int64_t>(filtered_strings_indices.size()));
-      output_shape.push_back(filtered_count);
-      status = output_filtered(output_shape, filtered_strings_indices);
-    }
+  InlinedVector<size_t> filtered_strings_indices;
+  if (stopwords_.empty()) {
+    assert(case_change_action_ != NONE);
+    output_shape.push_back(C);
   } else {
-    if (wstopwords_.empty()) {
-      assert(case_change_action_ != NONE);
-      output_shape.push_back(C);
-      status = output_no_filtering(output_shape);
-    } else {
-      // Case insensitive filtering is performed by converting the input strings
-      // to compare_caseaction_. For that we convert to wchar_t UNICODE.
-      // Otherwise, we need to pull ICU library on all platforms.
-      InlinedVector<size_t> filtered_strings_indices;
-      filtered_strings_indices.reserve(input_span.size());
-      for (size_t i = 0, lim = input_span.size(); i < lim; ++i) {
+    // Not std::vector<bool> so that batches can write it concurrently.
+    std::vector<uint8_t> keep(num_strings, 0);
+    ORT_RETURN_IF_ERROR(ForEachBatch(thread_pool, num_strings, [&](size_t begin, size_t end) {
+      Utf8Converter converter;
+      std::wstring wchar_buffer;
+      std::string word;
+      for (size_t i = begin; i < end; ++i) {
         const std::string& s = input_span[i];
-        wchar_buffer.resize(max_wide_buffer_len);
-        ORT_RETURN_IF_ERROR(converter.ConvertToWideChar(s, wchar_buffer));
-        locale.ChangeCase(compare_caseaction_, wchar_buffer);
-        if (wstopwords_.count(wchar_buffer) == 0) {
-          filtered_strings_indices.push_back(i);
+        if (is_case_sensitive_) {
+          if (!IsAscii(s)) {
+            // Checks for invalid UTF-8 characters on Windows
+            size_t wchars = 0;
+            ORT_RETURN_IF_ERROR(converter.ComputeRequiredSizeToWideChar(s, wchars));
+          }
+          keep[i] = stopwords_.count(s) == 0;
+        } else {
+          ORT_RETURN_IF_ERROR(ChangeCase(locale, converter, ascii_case_change_, compare_caseaction_, s,
+                                         wchar_buffer, word));
+          keep[i] = stopwords_.count(word) == 0;
         }
       }
+      return Status::OK();
+    }));
 
-      // According to the spec, if all strings are filtered out
-      // the output must have a shape of {1} with a single empty string.
-      const int64_t filtered_count = std::max<int64_t>(1, narrow<int64_t>(filtered_strings_indices.size()));
-      output_shape.push_back(filtered_count);
-      status = output_filtered(output_shape, filtered_strings_indices);
+    filtered_strings_indices.reserve(num_strings);
+    for (size_t i = 0; i < num_strings; ++i) {
+      if (keep[i]) {
+        filtered_strings_indices.push_back(i);
+      }
     }
+
+    // According to the spec, if all strings are filtered out
+    // the output must have a shape of {1} with a single empty string.
+    const int64_t filtered_count = std::max<int64_t>(1, narrow<int64_t>(filtered_strings_indices.size()));
+    output_shape.push_back(filtered_count);
   }
 
-  return status;
+  auto output_tensor = ctx->Output(0, output_shape);
+  auto output_data = output_tensor->MutableData<std::string>();
+  const bool filtered = !stopwords_.empty();
+  const size_t output_count = filtered ? filtered_strings_indices.size() : num_strings;
+
+  // Output the remaining strings and change case as required
+  return ForEachBatch(thread_pool, output_count, [&](size_t begin, size_t end) {
+    Utf8Converter converter;
+    std::wstring wchar_buffer;
+    for (size_t i = begin; i < end; ++i) {
+      const std::string& s = input_span[filtered ? filtered_strings_indices[i] : i];
+      if (case_change_action_ != NONE) {
+        ORT_RETURN_IF_ERROR(ChangeCase(locale, converter, ascii_case_change_, case_change_action_, s,
+                                       wchar_buffer, output_data[i]));
+      } else {
+        output_data[i] = s;
+      }
+    }
+    return Status::OK();
+  });
 }
 }  // namespace onnxruntime
@@ -31,9 +31,12 @@ class StringNormalizer : public OpKernel {
   // used for case-insensitive compare
   CaseAction compare_caseaction_{LOWER};
   std::string locale_name_;
-  // Either if these are populated but not both
+  // Whether the case of ASCII strings can be changed without converting them to wchar_t.
+  // False for locales such as Turkish that map ASCII letters to other characters.
+  bool ascii_case_change_{true};
+  // Stop words as UTF-8. If the comparison is not case sensitive,
+  // they are converted to compare_caseaction_.
   InlinedHashSet<std::string> stopwords_;
-  InlinedHashSet<std::wstring> wstopwords_;
 };
 
 }  // namespace onnxruntime
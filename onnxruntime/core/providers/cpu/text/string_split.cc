@@ -6,6 +6,7 @@
 #include <limits>
 #include <string>
 #include "core/common/common.h"
+#include "core/platform/threadpool.h"
 namespace onnxruntime {
 
 ONNX_CPU_OPERATOR_KERNEL(StringSplit, 20,
@@ -64,22 +65,27 @@ StringSplit::StringSplit(const OpKernelInfo& info) : OpKernel(info) {
 Status StringSplit::Compute(OpKernelContext* context) const {
   const Tensor* input = context->Input<Tensor>(0);
   auto input_data = input->template DataAsSpan<std::string>();
+  concurrency::ThreadPool* thread_pool = context->GetOperatorThreadPool();
+  const auto num_strings = static_cast<std::ptrdiff_t>(input_data.size());
 
   // Set up number of tokens output
   auto num_tokens_data = context->Output(1, input->Shape())->template MutableDataAsSpan<int64_t>();
-  auto num_tokens_iter = num_tokens_data.begin();
 
-  InlinedVector<InlinedVector<std::string_view>> input_slices;
-  input_slices.reserve(input_data.size());
-  size_t last_dim = 0;
+  // The substrings are views of the input until they are copied to the output.
+  InlinedVector<InlinedVector<std::string_view>> input_slices(input_data.size());
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, num_strings,
+      TensorOpCost{static_cast<double>(sizeof(std::string)), static_cast<double>(sizeof(int64_t)), 64.0},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (auto i = static_cast<size_t>(first); i < static_cast<size_t>(last); ++i) {
+          ComputeSubstrings(input_data[i], delimiter_, maxsplit_, input_slices[i]);
+          num_tokens_data[i] = static_cast<int64_t>(input_slices[i].size());
+        }
+      });
 
-  for (const auto& s : input_data) {
-    auto& substrs = input_slices.emplace_back();
-    ComputeSubstrings(s, delimiter_, maxsplit_, substrs);
-    auto substr_count = substrs.size();
-    last_dim = std::max(last_dim, substr_count);
-    *num_tokens_iter = static_cast<int64_t>(substr_count);
-    ++num_tokens_iter;
+  size_t last_dim = 0;
+  for (const auto& substrs : input_slices) {
+    last_dim = std::max(last_dim, substrs.size());
   }
 
   // Set up splits output
@@ -87,10 +93,18 @@ Status StringSplit::Compute(OpKernelContext* context) const {
   splits_shape.push_back(last_dim);
 
   auto splits_data = context->Output(0, splits_shape)->template MutableDataAsSpan<std::string>();
-  auto slices_iter = input_slices.begin();
-  for (auto output_splits_iter = splits_data.begin(); output_splits_iter != splits_data.end(); output_splits_iter += last_dim, ++slices_iter) {
-    std::copy(slices_iter->begin(), slices_iter->end(), output_splits_iter);
+  if (last_dim == 0) {
+    return Status::OK();
   }
+  concurrency::ThreadPool::TryParallelFor(
+      thread_pool, num_strings,
+      TensorOpCost{static_cast<double>(sizeof(std::string)), static_cast<double>(last_dim * sizeof(std::string)),
+                   static_cast<double>(last_dim) * 16.0},
+      [&](std::ptrdiff_t first, std::ptrdiff_t last) {
+        for (auto i = static_cast<size_t>(first); i < static_cast<size_t>(last); ++i) {
+          std::copy(input_slices[i].begin(), input_slices[i].end(), splits_data.begin() + i * last_dim);
+        }
+      });
 
   return Status::OK();
 }
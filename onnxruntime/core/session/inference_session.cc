@@ -1006,9 +1006,11 @@ common::Status InferenceSession::LoadOnnxModel(const PathString& model_uri) {
 #endif
     const bool strict_shape_type_inference = session_options_.config_options.GetConfigOrDefault(
                                                  kOrtSessionOptionsConfigStrictShapeTypeInference, "0") == "1";
+    ModelOptions model_opts(true, strict_shape_type_inference);
+    model_opts.load_initializers_in_place = session_options_.config_options.GetConfigOrDefault(
+                                                kOrtSessionOptionsLoadModelInitializersInPlace, "0") == "1";
     return onnxruntime::Model::Load(model_location_, model, HasLocalSchema() ? &custom_schema_registries_ : nullptr,
-                                    *session_logger_,
-                                    ModelOptions(true, strict_shape_type_inference));
+                                    *session_logger_, model_opts);
   };
 
   common::Status st = LoadWithLoader(loader, "model_loading_uri");
@@ -1456,12 +1458,34 @@ static Status LoadOrtModelBytes(const PathString& model_uri,
   return Status::OK();
 }
 
+// Maps the model file privately (copy-on-write) instead of reading it, so its pages are only read from disk when they
+// are used and stay shared with the page cache as long as nothing writes to them.
+static Status MapOrtModelBytes(const PathString& model_uri,
+                               gsl::span<const uint8_t>& bytes,
+                               Env::MappedMemoryPtr& mapping) {
+  size_t num_bytes = 0;
+  ORT_RETURN_IF_ERROR(Env::Default().GetFileLength(model_uri.c_str(), num_bytes));
+  ORT_RETURN_IF(num_bytes == 0, "Load model from ", ToUTF8String(model_uri), " failed. The file is empty.");
+
+  ORT_RETURN_IF_ERROR(Env::Default().MapFileIntoMemory(model_uri.c_str(), 0, num_bytes, mapping));
+
+  bytes = gsl::span<const uint8_t>(reinterpret_cast<const uint8_t*>(mapping.get()), num_bytes);
+
+  return Status::OK();
+}
+
 Status InferenceSession::LoadOrtModel(const PathString& model_uri) {
   return LoadOrtModelWithLoader(
       [&]() {
         model_location_ = model_uri;
-        ORT_RETURN_IF_ERROR(
-            LoadOrtModelBytes(model_location_, ort_format_model_bytes_, ort_format_model_bytes_data_holder_));
+        const bool map_model_file =
+            session_options_.config_options.GetConfigOrDefault(kOrtSessionOptionsConfigMapORTModelFile, "0") == "1";
+        if (map_model_file) {
+          ORT_RETURN_IF_ERROR(MapOrtModelBytes(model_location_, ort_format_model_bytes_, ort_format_model_mapping_));
+        } else {
+          ORT_RETURN_IF_ERROR(
+              LoadOrtModelBytes(model_location_, ort_format_model_bytes_, ort_format_model_bytes_data_holder_));
+        }
         return Status::OK();
       });
 }
@@ -1567,11 +1591,13 @@ Status InferenceSession::LoadOrtModelWithLoader(std::function<Status()> load_ort
   // provided an existing buffer of bytes when creating the InferenceSession, ort_format_model_bytes_data_holder_
   // will be empty.
   // if that is the case we also allow creating initializers that directly use those bytes.
+  // a mapped model file is owned by the session, so its initializers always use the mapped bytes.
   const auto& config_options = session_options_.config_options;
   using_ort_model_bytes_for_initializers_ =
       load_options.can_use_flatbuffer_for_initializers =
-          ort_format_model_bytes_data_holder_.empty() &&
-          config_options.GetConfigOrDefault(kOrtSessionOptionsConfigUseORTModelBytesForInitializers, "0") == "1";
+          ort_format_model_mapping_ != nullptr ||
+          (ort_format_model_bytes_data_holder_.empty() &&
+           config_options.GetConfigOrDefault(kOrtSessionOptionsConfigUseORTModelBytesForInitializers, "0") == "1");
 
   // need to go from unique_ptr to shared_ptr when moving into model_
   std::unique_ptr<Model> tmp_model;
@@ -1752,16 +1778,6 @@ Status ApplyOrtFormatModelRuntimeOptimizations(
 #endif  // !defined(ORT_MINIMAL_BUILD) || defined(ORT_EXTENDED_MINIMAL_BUILD)
 }  // namespace
 
-static void ResolveMemoryPatternFlags(SessionState& session_state) {
-  session_state.ResolveMemoryPatternFlag();
-
-  for (const auto& entry : session_state.GetSubgraphSessionStateMap()) {
-    for (const auto& name_to_subgraph_session_state : entry.second) {
-      ResolveMemoryPatternFlags(*name_to_subgraph_session_state.second);
-    }
-  }
-}
-
 // This function is called when the session is being initialized.
 // For now, this function only checks for invalid combination of DML EP with other EPs.
 // TODO: extend this function to check for other invalid combinations of EPs.
@@ -2225,7 +2241,7 @@ common::Status InferenceSession::Initialize() {
 #endif  // !defined(ORT_MINIMAL_BUILD)
 
     // Resolve memory pattern flags of the main graph and subgraph session states
-    ResolveMemoryPatternFlags(*session_state_);
+    session_state_->ResolveMemoryPatternFlags();
 
     is_inited_ = true;
 
@@ -30,6 +30,7 @@
 #include "core/optimizer/graph_transformer_level.h"
 #include "core/optimizer/graph_transformer_mgr.h"
 #include "core/optimizer/insert_cast_transformer.h"
+#include "core/platform/env.h"
 #include <mutex>
 #ifdef ENABLE_LANGUAGE_INTEROP_OPS
 #include "core/language_interop_ops/language_interop_ops.h"
@@ -659,6 +660,10 @@ class InferenceSession {
   // EP instance.
   ExecutionProviders execution_providers_;
 
+  // The mapping of an ORT format model file loaded with kOrtSessionOptionsConfigMapORTModelFile.
+  // This MUST be prior to model_ and session_state_ as the initializers may refer to the mapped bytes.
+  Env::MappedMemoryPtr ort_format_model_mapping_;
+
   // The model served by this inference session instance.
   // Currently this has to be a shared ptr because the Model::Load method
   // returns a shared_ptr only. Ideally factory functions should always return
@@ -532,6 +532,49 @@ class OrtPybindSingleUseAllocator : public IAllocator {
 
 using OrtPybindSingleUseAllocatorPtr = std::shared_ptr<OrtPybindSingleUseAllocator>;
 
+// Encodes a numpy unicode string of num_chars code points as UTF-8 into dst.
+// Numpy pads all strings of an array to the longest one with null code points, the string ends at the first one.
+// Returns false if a code point cannot be encoded.
+static bool Ucs4ToUtf8(const char* src, size_t num_chars, std::string& dst) {
+  auto code_point = [src](size_t i) {
+    uint32_t c;
+    memcpy(&c, src + i * PyUnicode_4BYTE_KIND, sizeof(uint32_t));
+    return c;
+  };
+  size_t length = 0;
+  while (length < num_chars && code_point(length) != 0) {
+    ++length;
+  }
+
+  dst.clear();
+  dst.reserve(length);
+  for (size_t i = 0; i < length; ++i) {
+    const uint32_t c = code_point(i);
+    if (c < 0x80) {
+      dst.push_back(static_cast<char>(c));
+    } else if (c < 0x800) {
+      dst.push_back(static_cast<char>(0xC0 | (c >> 6)));
+      dst.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c < 0x10000) {
+      if (c >= 0xD800 && c <= 0xDFFF) {
+        // Surrogates are not valid code points.
+        return false;
+      }
+      dst.push_back(static_cast<char>(0xE0 | (c >> 12)));
+      dst.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      dst.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c <= 0x10FFFF) {
+      dst.push_back(static_cast<char>(0xF0 | (c >> 18)));
+      dst.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+      dst.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      dst.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Expects p_tensor properly created
 // Does not manage darray life-cycle
 
@@ -547,15 +590,9 @@ static void CopyDataToTensor(PyArrayObject* darray, int npy_type, Tensor& tensor
     const char* src = reinterpret_cast<const char*>(PyArray_DATA(darray));
     for (int i = 0; i < total_items; i++, src += item_size) {
       // Python unicode strings are assumed to be USC-4. Strings are stored as UTF-8.
-      PyObject* pStr = PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, src, num_chars);
-      UniqueDecRefPtr<PyObject> strGuard(pStr, DecRefFn<PyObject>());
-      const char* str = PyUnicode_AsUTF8(pStr);
-      if (str == NULL) {
+      // They are encoded in place, without creating a Python string per element.
+      if (!Ucs4ToUtf8(src, static_cast<size_t>(num_chars), dst[i])) {
         dst[i].clear();
-      } else {
-        // Size is equal to the longest string size, numpy stores
-        // strings in a single array.
-        dst[i] = str;
       }
     }
   } else if (npy_type == NPY_STRING || npy_type == NPY_VOID) {
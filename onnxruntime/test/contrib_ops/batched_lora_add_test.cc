@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+namespace {
+std::vector<float> ReferenceBatchedLoraAdd(const std::vector<float>& input, const std::vector<float>& base_output,
+                                           const std::vector<float>& lora_a, const std::vector<float>& lora_b,
+                                           const std::vector<int32_t>& adapter_index, const std::vector<float>& scale,
+                                           int64_t sequence_length, int64_t hidden_size, int64_t output_size,
+                                           int64_t rank) {
+  std::vector<float> output = base_output;
+  for (size_t b = 0; b < adapter_index.size(); b++) {
+    const int32_t a = adapter_index[b];
+    if (a < 0) {
+      continue;
+    }
+    for (int64_t s = 0; s < sequence_length; s++) {
+      const float* x = input.data() + (b * sequence_length + s) * hidden_size;
+      std::vector<float> t(rank, 0.0f);
+      for (int64_t r = 0; r < rank; r++) {
+        for (int64_t k = 0; k < hidden_size; k++) {
+          t[r] += x[k] * lora_a[(a * hidden_size + k) * rank + r];
+        }
+      }
+      for (int64_t n = 0; n < output_size; n++) {
+        float delta = 0.0f;
+        for (int64_t r = 0; r < rank; r++) {
+          delta += t[r] * lora_b[(a * rank + r) * output_size + n];
+        }
+        output[(b * sequence_length + s) * output_size + n] += scale.empty() ? delta : scale[a] * delta;
+      }
+    }
+  }
+  return output;
+}
+}  // namespace
+
+TEST(BatchedLoraAddTest, MixedAdapters) {
+  constexpr int64_t batch_size = 3;
+  constexpr int64_t sequence_length = 2;
+  constexpr int64_t hidden_size = 3;
+  constexpr int64_t output_size = 2;
+  constexpr int64_t num_adapters = 2;
+  constexpr int64_t rank = 1;
+
+  std::vector<float> input{1.0f, 2.0f, 3.0f, -1.0f, 0.5f, 2.0f,
+                           0.0f, 1.0f, -2.0f, 4.0f, 1.0f, 0.0f,
+                           2.0f, -3.0f, 1.0f, 0.5f, 0.5f, 0.5f};
+  std::vector<float> base_output{0.1f, 0.2f, 0.3f, 0.4f,
+                                 0.5f, 0.6f, 0.7f, 0.8f,
+                                 0.9f, 1.0f, 1.1f, 1.2f};
+  std::vector<float> lora_a{1.0f, 0.0f, -1.0f,
+                            0.5f, 1.0f, 2.0f};
+  std::vector<float> lora_b{2.0f, -1.0f,
+                            1.0f, 3.0f};
+  std::vector<int32_t> adapter_index{1, -1, 0};
+  std::vector<float> scale{1.0f, 0.5f};
+
+  std::vector<float> expected = ReferenceBatchedLoraAdd(input, base_output, lora_a, lora_b, adapter_index, scale,
+                                                        sequence_length, hidden_size, output_size, rank);
+
+  OpTester test("BatchedLoraAdd", 1, kMSDomain);
+  test.AddInput<float>("input", {batch_size, sequence_length, hidden_size}, input);
+  test.AddInput<float>("base_output", {batch_size, sequence_length, output_size}, base_output);
+  test.AddInput<float>("lora_a", {num_adapters, hidden_size, rank}, lora_a);
+  test.AddInput<float>("lora_b", {num_adapters, rank, output_size}, lora_b);
+  test.AddInput<int32_t>("adapter_index", {batch_size}, adapter_index);
+  test.AddInput<float>("scale", {num_adapters}, scale);
+  test.AddOutput<float>("output", {batch_size, sequence_length, output_size}, expected);
+  test.Run();
+}
+
+TEST(BatchedLoraAddTest, NoScaleTwoDimensionalInput) {
+  constexpr int64_t batch_size = 2;
+  constexpr int64_t hidden_size = 2;
+  constexpr int64_t output_size = 3;
+  constexpr int64_t num_adapters = 1;
+  constexpr int64_t rank = 2;
+
+  std::vector<float> input{1.0f, -2.0f, 3.0f, 0.5f};
+  std::vector<float> base_output{0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+  std::vector<float> lora_a{1.0f, 2.0f, -1.0f, 0.5f};
+  std::vector<float> lora_b{1.0f, 0.0f, -1.0f, 0.5f, 2.0f, 1.0f};
+  std::vector<int32_t> adapter_index{0, 0};
+
+  std::vector<float> expected = ReferenceBatchedLoraAdd(input, base_output, lora_a, lora_b, adapter_index, {},
+                                                        1, hidden_size, output_size, rank);
+
+  OpTester test("BatchedLoraAdd", 1, kMSDomain);
+  test.AddInput<float>("input", {batch_size, hidden_size}, input);
+  test.AddInput<float>("base_output", {batch_size, output_size}, base_output);
+  test.AddInput<float>("lora_a", {num_adapters, hidden_size, rank}, lora_a);
+  test.AddInput<float>("lora_b", {num_adapters, rank, output_size}, lora_b);
+  test.AddInput<int32_t>("adapter_index", {batch_size}, adapter_index);
+  test.AddOutput<float>("output", {batch_size, output_size}, expected);
+  test.Run();
+}
+
+TEST(BatchedLoraAddTest, AdapterIndexOutOfRange) {
+  OpTester test("BatchedLoraAdd", 1, kMSDomain);
+  test.AddInput<float>("input", {1, 2}, {1.0f, 2.0f});
+  test.AddInput<float>("base_output", {1, 2}, {0.0f, 0.0f});
+  test.AddInput<float>("lora_a", {1, 2, 1}, {1.0f, 1.0f});
+  test.AddInput<float>("lora_b", {1, 1, 2}, {1.0f, 1.0f});
+  test.AddInput<int32_t>("adapter_index", {1}, {1});
+  test.AddOutput<float>("output", {1, 2}, {0.0f, 0.0f});
+  test.Run(OpTester::ExpectResult::kExpectFailure, "out of range");
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -5,12 +5,14 @@
 #include <vector>
 #include "gtest/gtest.h"
 #include <gsl/gsl>
+#include "core/framework/allocator.h"
 #include "core/session/onnxruntime_cxx_api.h"
 #include "test/common/cuda_op_test_utils.h"
 #include "test/providers/model_tester.h"
 #include "test/util/include/current_test_name.h"
 #include "test/util/include/scoped_env_vars.h"
 #include "contrib_ops/cpu/transformers/generation_shared.h"
+#include "contrib_ops/cpu/transformers/generation_device_helper.h"
 
 #ifdef USE_CUDA
 #include "core/providers/cuda/cuda_provider_options.h"
@@ -463,5 +465,24 @@ TEST(BeamSearchTest, DummyT5PointerGenerator) {
   tester.RunWithConfig();
 }
 
+TEST(BeamSearchTest, ReorderBeamBlocksInPlace) {
+  // 4 beams with 3 elements per beam. Beam 0 and 2 are kept, beam 1 is replaced by beam 0,
+  // and beam 3 is replaced by beam 1 which requires staging the old content of beam 1.
+  std::vector<float> past{0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 2.f, 2.f, 2.f, 3.f, 3.f, 3.f};
+  std::vector<int32_t> beam_indices{0, 0, 2, 1};
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  contrib::GenerationCpuDeviceHelper::ReorderBeamBlocksInPlace<float>(gsl::make_span(past), 3, beam_indices,
+                                                                      allocator);
+  std::vector<float> expected{0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 2.f, 2.f, 2.f, 1.f, 1.f, 1.f};
+  EXPECT_EQ(past, expected);
+
+  // A full permutation with cycles.
+  std::vector<float> cycle{0.f, 1.f, 2.f, 3.f};
+  std::vector<int32_t> rotate{3, 0, 1, 2};
+  contrib::GenerationCpuDeviceHelper::ReorderBeamBlocksInPlace<float>(gsl::make_span(cycle), 1, rotate, allocator);
+  std::vector<float> expected_cycle{3.f, 0.f, 1.f, 2.f};
+  EXPECT_EQ(cycle, expected_cycle);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
@@ -1,10 +1,14 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <algorithm>
+#include <fstream>
 #include <memory>
+#include <string>
 #include <vector>
 #include "gtest/gtest.h"
 #include <gsl/gsl>
+#include "core/graph/onnx_protobuf.h"
 #include "core/session/onnxruntime_cxx_api.h"
 #include "test/common/cuda_op_test_utils.h"
 
@@ -183,5 +187,91 @@ TEST(GreedySearchTest, GptGreedySearchFp32) {
   }
 }
 
+// Runs testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx on CPU with its EOS token replaced by
+// eos_token_id, and returns the generated sequences.
+static void RunGptGreedySearchFp32WithEos(const std::vector<int32_t>& input_ids, int64_t batch_size,
+                                          int32_t max_length, int64_t eos_token_id,
+                                          std::vector<int32_t>& sequences) {
+  ONNX_NAMESPACE::ModelProto model_proto;
+  {
+    std::ifstream model_file("testdata/transformers/tiny_gpt2_greedysearch_with_init_decoder.onnx",
+                             std::ios::binary);
+    ASSERT_TRUE(model_proto.ParseFromIstream(&model_file));
+  }
+  bool eos_set = false;
+  for (auto& node : *model_proto.mutable_graph()->mutable_node()) {
+    if (node.op_type() != "GreedySearch") {
+      continue;
+    }
+    for (auto& attribute : *node.mutable_attribute()) {
+      if (attribute.name() == "eos_token_id") {
+        attribute.set_i(eos_token_id);
+        eos_set = true;
+      }
+    }
+  }
+  ASSERT_TRUE(eos_set);
+  const std::string model_data = model_proto.SerializeAsString();
+
+  std::vector<int64_t> input_ids_shape{batch_size, static_cast<int64_t>(input_ids.size()) / batch_size};
+  std::vector<int64_t> parameter_shape{1};
+  std::vector<int32_t> max_length_data{max_length};
+  std::vector<int32_t> min_length{1};
+  std::vector<float> repetition_penalty{1.0f};
+
+  Ort::MemoryInfo info("Cpu", OrtDeviceAllocator, 0, OrtMemTypeDefault);
+  std::vector<Ort::Value> ort_inputs;
+  ort_inputs.push_back(Ort::Value::CreateTensor(info, const_cast<int32_t*>(input_ids.data()), input_ids.size(),
+                                                input_ids_shape.data(), input_ids_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(info, max_length_data.data(), max_length_data.size(),
+                                                parameter_shape.data(), parameter_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(info, min_length.data(), min_length.size(),
+                                                parameter_shape.data(), parameter_shape.size()));
+  ort_inputs.push_back(Ort::Value::CreateTensor(info, repetition_penalty.data(), repetition_penalty.size(),
+                                                parameter_shape.data(), parameter_shape.size()));
+  const char* input_names[] = {"input_ids", "max_length", "min_length", "repetition_penalty"};
+  const char* const output_names[] = {"sequences"};
+
+  Ort::SessionOptions session_options;
+  Ort::Session session(*ort_env, model_data.data(), model_data.size(), session_options);
+  auto ort_outputs = session.Run(Ort::RunOptions{}, input_names, ort_inputs.data(), ort_inputs.size(),
+                                 output_names, 1);
+
+  ASSERT_EQ(ort_outputs.size(), 1U);
+  auto result_ts = ort_outputs[0].GetTensorTypeAndShapeInfo();
+  ASSERT_EQ((std::vector<int64_t>{batch_size, max_length}), result_ts.GetShape());
+  const auto* result_vals = ort_outputs[0].GetTensorData<int32_t>();
+  sequences.assign(result_vals, result_vals + result_ts.GetElementCount());
+}
+
+// Rows that reach EOS are evicted from the decoder feeds on CPU. Make the second row finish at its first generated
+// token, and check that the other row still generates the same tokens as when no row finishes early.
+TEST(GreedySearchTest, GptGreedySearchFp32_EvictFinishedRows) {
+  const std::vector<int32_t> input_ids{
+      0, 0, 0, 52, 0, 0, 195, 731};
+  constexpr int64_t batch_size = 2;
+  constexpr int32_t max_length = 10;
+  constexpr int32_t prompt_length = 4;
+  constexpr int64_t pad_token_id = 98;  // the EOS and pad token of the model
+
+  // no row generates the EOS token of the model, so no row is evicted
+  std::vector<int32_t> expected_output;
+  ASSERT_NO_FATAL_FAILURE(RunGptGreedySearchFp32WithEos(input_ids, batch_size, max_length, pad_token_id,
+                                                        expected_output));
+  auto row0 = gsl::make_span(expected_output).subspan(prompt_length, max_length - prompt_length);
+  auto row1 = gsl::make_span(expected_output).subspan(max_length + prompt_length, max_length - prompt_length);
+  ASSERT_EQ(std::find(expected_output.begin(), expected_output.end(), pad_token_id), expected_output.end());
+
+  // use the first token generated for the second row as EOS, which the first row never generates. a generated EOS
+  // is replaced by the pad token, like every token after it.
+  const int32_t eos_token_id = row1[0];
+  ASSERT_EQ(std::find(row0.begin(), row0.end(), eos_token_id), row0.end());
+  std::fill(row1.begin(), row1.end(), static_cast<int32_t>(pad_token_id));
+
+  std::vector<int32_t> output;
+  ASSERT_NO_FATAL_FAILURE(RunGptGreedySearchFp32WithEos(input_ids, batch_size, max_length, eos_token_id, output));
+  EXPECT_EQ(output, expected_output);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
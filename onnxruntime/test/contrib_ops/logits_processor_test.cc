@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <limits>
+#include <vector>
+#include "gtest/gtest.h"
+#include "contrib_ops/cpu/transformers/logits_processor.h"
+
+namespace onnxruntime {
+namespace test {
+
+using contrib::transformers::NextTokenScores;
+using contrib::transformers::NoRepeatNGramLogitsProcessor;
+using contrib::transformers::PresencePenaltyLogitsProcessor;
+using contrib::transformers::RepetitionPenaltyLogitsProcessor;
+using contrib::transformers::Sequences;
+
+namespace {
+constexpr int kBatchBeamSize = 2;
+constexpr int kSequenceLength = 5;
+constexpr int kMaxLength = 8;
+constexpr int kVocabSize = 8;
+
+void InitSequences(Sequences& sequences, std::vector<int32_t>& buffer, const std::vector<int32_t>& tokens) {
+  buffer.assign(2 * kBatchBeamSize * kMaxLength, 0);
+  for (int i = 0; i < kBatchBeamSize; i++) {
+    for (int j = 0; j < kSequenceLength; j++) {
+      buffer[i * kMaxLength + j] = tokens[i * kSequenceLength + j];
+    }
+  }
+  sequences.Init(buffer, kBatchBeamSize, kSequenceLength, kMaxLength);
+}
+}  // namespace
+
+TEST(LogitsProcessorTest, NoRepeatNGram) {
+  Sequences sequences;
+  std::vector<int32_t> buffer;
+  InitSequences(sequences, buffer, {1, 2, 3, 1, 2,
+                                    5, 5, 5, 5, 5});
+
+  std::vector<float> scores(kBatchBeamSize * kVocabSize, 0.0f);
+  gsl::span<float> scores_span(scores);
+  NextTokenScores<float> next_token_scores{scores_span, kBatchBeamSize, kVocabSize};
+
+  NoRepeatNGramLogitsProcessor<float> processor(3);
+  processor.Process(&sequences, next_token_scores);
+
+  // Prefix (1, 2) was followed by 3 in the first beam, and prefix (5, 5) was followed by 5 in the second beam.
+  constexpr float lowest = std::numeric_limits<float>::lowest();
+  std::vector<float> expected{0.f, 0.f, 0.f, lowest, 0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f, 0.f, lowest, 0.f, 0.f};
+  EXPECT_EQ(scores, expected);
+}
+
+TEST(LogitsProcessorTest, RepetitionPenaltyAppliedOncePerToken) {
+  Sequences sequences;
+  std::vector<int32_t> buffer;
+  InitSequences(sequences, buffer, {1, 1, 2, 1, 2,
+                                    0, 3, 4, 5, 6});
+
+  std::vector<float> scores(kBatchBeamSize * kVocabSize, 4.0f);
+  scores[kVocabSize + 3] = -4.0f;
+  gsl::span<float> scores_span(scores);
+  NextTokenScores<float> next_token_scores{scores_span, kBatchBeamSize, kVocabSize};
+
+  RepetitionPenaltyLogitsProcessor<float> processor(2.0f);
+  processor.Process(&sequences, next_token_scores);
+
+  // Token 1 appears three times in the first beam but is only penalized once.
+  std::vector<float> expected{4.f, 2.f, 2.f, 4.f, 4.f, 4.f, 4.f, 4.f,
+                              2.f, 4.f, 4.f, -8.f, 2.f, 2.f, 2.f, 4.f};
+  EXPECT_EQ(scores, expected);
+}
+
+TEST(LogitsProcessorTest, PresencePenaltyUsesWholeMask) {
+  Sequences sequences;
+  std::vector<int32_t> buffer;
+  InitSequences(sequences, buffer, std::vector<int32_t>(kBatchBeamSize * kSequenceLength, 0));
+
+  std::vector<int32_t> presence_mask(kBatchBeamSize * kVocabSize, 0);
+  presence_mask[2] = 1;
+  presence_mask[kVocabSize + 5] = 1;
+
+  std::vector<float> scores(kBatchBeamSize * kVocabSize, 1.0f);
+  gsl::span<float> scores_span(scores);
+  NextTokenScores<float> next_token_scores{scores_span, kBatchBeamSize, kVocabSize};
+
+  PresencePenaltyLogitsProcessor<float> processor(presence_mask, 0.5f, 1);
+  processor.Process(&sequences, next_token_scores);
+
+  for (int i = 0; i < kBatchBeamSize * kVocabSize; i++) {
+    EXPECT_EQ(scores[i], presence_mask[i] ? 0.5f : 1.0f) << "index " << i;
+  }
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "gtest/gtest.h"
+#include "test/providers/provider_test_utils.h"
+
+namespace onnxruntime {
+namespace test {
+
+// B is [depth=4, N=2].
+static const std::vector<float> kWeights = {1.f, 2.f,
+                                            3.f, 4.f,
+                                            5.f, 6.f,
+                                            7.f, 8.f};
+
+TEST(OneHotMatMulContribOpTest, Int64Indices) {
+  OpTester test("OneHotMatMul", 1, kMSDomain);
+  test.AddInput<int64_t>("indices", {2, 3}, {0, 3, 1, 2, 2, 0});
+  test.AddInput<float>("B", {4, 2}, kWeights);
+  test.AddOutput<float>("Y", {2, 3, 2}, {1.f, 2.f, 7.f, 8.f, 3.f, 4.f,
+                                         5.f, 6.f, 5.f, 6.f, 1.f, 2.f});
+  test.Run();
+}
+
+// Negative indices count from the end of the depth, out of range indices select a row of zeros as in OneHot.
+TEST(OneHotMatMulContribOpTest, NegativeAndOutOfRangeInt32Indices) {
+  OpTester test("OneHotMatMul", 1, kMSDomain);
+  test.AddInput<int32_t>("indices", {5}, {-1, -4, -5, 4, 100});
+  test.AddInput<float>("B", {4, 2}, kWeights);
+  test.AddOutput<float>("Y", {5, 2}, {7.f, 8.f, 1.f, 2.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f});
+  test.Run();
+}
+
+TEST(OneHotMatMulContribOpTest, ScalarIndex) {
+  OpTester test("OneHotMatMul", 1, kMSDomain);
+  test.AddInput<int64_t>("indices", {}, {2});
+  test.AddInput<float>("B", {4, 2}, kWeights);
+  test.AddOutput<float>("Y", {2}, {5.f, 6.f});
+  test.Run();
+}
+
+}  // namespace test
+}  // namespace onnxruntime
@@ -6,10 +6,12 @@
 
 #include <algorithm>
 #include <cfloat>
+#include <filesystem>
 #include <functional>
 #include <iterator>
 #include <thread>
 #include <fstream>
+#include <numeric>
 #include <random>
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
@@ -56,6 +58,7 @@
 #include "test/optimizer/dummy_graph_transformer.h"
 #include "test/util/include/default_providers.h"
 #include "test/util/include/inference_session_wrapper.h"
+#include "test/util/include/temp_dir.h"
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -2323,6 +2326,104 @@ TEST(InferenceSessionTests, ModelThatTriggersAllocationPlannerToReuseDoubleTenso
   VerifyOutputs(fetches[2].Get<Tensor>(), expected_dims_res3, expected_values_res3);
 }
 
+// Runs the model at model_path, which computes Y from the float input X, with the session config entry config_key set
+// to config_value.
+static void RunModelWithConfigEntry(const std::basic_string<ORTCHAR_T>& model_path, const char* config_key,
+                                    const char* config_value, const std::vector<int64_t>& dims_x,
+                                    const std::vector<float>& values_x, std::vector<float>& values_y) {
+  SessionOptions so;
+  so.session_logid = "InferenceSessionTests.RunModelWithConfigEntry";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(config_key, config_value));
+
+  InferenceSession session_object{so, GetEnvironment()};
+  ASSERT_STATUS_OK(session_object.Load(model_path));
+  ASSERT_STATUS_OK(session_object.Initialize());
+
+  OrtValue ml_value;
+  CreateMLValue<float>(TestCPUExecutionProvider()->CreatePreferredAllocators()[0], dims_x, values_x, &ml_value);
+  NameMLValMap feeds;
+  feeds.insert(std::make_pair("X", ml_value));
+  std::vector<std::string> output_names{"Y"};
+  std::vector<OrtValue> fetches;
+  RunOptions run_options;
+  ASSERT_STATUS_OK(session_object.Run(run_options, feeds, output_names, &fetches));
+  ASSERT_EQ(1u, fetches.size());
+  const auto values = fetches[0].Get<Tensor>().DataAsSpan<float>();
+  values_y.assign(values.begin(), values.end());
+}
+
+// A session with session.load_model_initializers_in_place creates the initializers whose raw data is left in the
+// model file from the file, over a mapping of it or in their own buffer depending on where protobuf put the data, and
+// must compute the same outputs as a session that parses the whole model.
+TEST(InferenceSessionTests, LoadModelInitializersInPlace) {
+  constexpr int64_t size = 1024;
+  std::vector<float> values_w(size);
+  std::iota(values_w.begin(), values_w.end(), -512.f);
+
+  ONNX_NAMESPACE::ModelProto model_proto;
+  model_proto.set_ir_version(ONNX_NAMESPACE::Version::IR_VERSION);
+  auto* opset = model_proto.add_opset_import();
+  opset->set_domain("");
+  opset->set_version(17);
+  auto* graph = model_proto.mutable_graph();
+  graph->set_name("in_place");
+  auto* initializer = graph->add_initializer();
+  initializer->set_name("W");
+  initializer->set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  initializer->add_dims(size);
+  initializer->set_raw_data(values_w.data(), values_w.size() * sizeof(float));
+  auto* node = graph->add_node();
+  node->set_op_type("Add");
+  node->add_input("X");
+  node->add_input("W");
+  node->add_output("Y");
+  auto set_value_info = [size](ONNX_NAMESPACE::ValueInfoProto& value_info, const char* name) {
+    value_info.set_name(name);
+    auto* tensor_type = value_info.mutable_type()->mutable_tensor_type();
+    tensor_type->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+    tensor_type->mutable_shape()->add_dim()->set_dim_value(size);
+  };
+  set_value_info(*graph->add_input(), "X");
+  set_value_info(*graph->add_output(), "Y");
+
+  const std::string serialized = model_proto.SerializeAsString();
+
+  TemporaryDirectory temp_dir(ORT_TSTR("load_model_initializers_in_place_test"));
+  const std::filesystem::path model_path = std::filesystem::path(temp_dir.Path()) / ORT_TSTR("model.onnx");
+  {
+    std::ofstream model_file(model_path, std::ios::binary);
+    model_file.write(serialized.data(), static_cast<std::streamsize>(serialized.size()));
+    ASSERT_TRUE(model_file.good());
+  }
+
+  std::vector<float> values_x(size);
+  std::iota(values_x.begin(), values_x.end(), 0.5f);
+  std::vector<float> expected_values_y;
+  std::vector<float> values_y;
+  ASSERT_NO_FATAL_FAILURE(RunModelWithConfigEntry(model_path.native(), kOrtSessionOptionsLoadModelInitializersInPlace,
+                                                  "0", {size}, values_x, expected_values_y));
+  ASSERT_NO_FATAL_FAILURE(RunModelWithConfigEntry(model_path.native(), kOrtSessionOptionsLoadModelInitializersInPlace,
+                                                  "1", {size}, values_x, values_y));
+  ASSERT_EQ(expected_values_y.size(), static_cast<size_t>(size));
+  EXPECT_EQ(values_y, expected_values_y);
+}
+
+// Reading the external initializer data ahead in parallel must not change the outputs of the model.
+TEST(InferenceSessionTests, ExternalInitializersParallelLoadMode) {
+  const std::vector<float> values_x{1.f, 2.f};
+  std::vector<float> expected_values_y;
+  std::vector<float> values_y;
+  ASSERT_NO_FATAL_FAILURE(RunModelWithConfigEntry(ORT_TSTR("testdata/model_with_external_initializers.onnx"),
+                                                  kOrtSessionOptionsExternalInitializersLoadMode, "lazy", {1, 2},
+                                                  values_x, expected_values_y));
+  ASSERT_NO_FATAL_FAILURE(RunModelWithConfigEntry(ORT_TSTR("testdata/model_with_external_initializers.onnx"),
+                                                  kOrtSessionOptionsExternalInitializersLoadMode, "parallel", {1, 2},
+                                                  values_x, values_y));
+  // the model pads the end of both dimensions of X with zeros, the pads being the external initializer
+  EXPECT_EQ(expected_values_y, (std::vector<float>{1.f, 2.f, 0.f, 0.f, 0.f, 0.f}));
+  EXPECT_EQ(values_y, expected_values_y);
+}
+
 // The following test is to cover the feature of InferenceSession that allows some session options
 // to flow in from a model file, and use defaults for missing session options/session options not supported for parsing
 // from the model
@@ -6,7 +6,10 @@
 #include <gtest/gtest.h>
 
 #include "asserts.h"
+#include "core/framework/kernel_type_str_resolver.h"
 #include "core/framework/op_kernel.h"
+#include "core/graph/model.h"
+#include "test/test_environment.h"
 
 namespace onnxruntime::test {
 
@@ -101,4 +104,48 @@ TEST(KernelRegistryTests, two_versions4) {
   ASSERT_STATUS_NOT_OK(RegKernels(r, function_table, CreateFakeKernel));
 }
 
+#if !defined(ORT_MINIMAL_BUILD)
+// Nodes with the same op and types share a lookup, nodes with other types don't.
+TEST(KernelRegistryTests, find_kernel_for_nodes) {
+  KernelRegistry r;
+  std::vector<std::unique_ptr<KernelDef>> function_table;
+  function_table.emplace_back(KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<float>()).SetName("Elu").SetDomain("").SinceVersion(6).Provider(kCpuExecutionProvider).Build());
+  function_table.emplace_back(KernelDefBuilder().TypeConstraint("T", DataTypeImpl::GetTensorType<double>()).SetName("Elu").SetDomain("").SinceVersion(6).Provider(kCpuExecutionProvider).Build());
+  ASSERT_STATUS_OK(RegKernels(r, function_table, CreateFakeKernel));
+
+  const auto& logger = DefaultLoggingManager().DefaultLogger();
+  Model model("find_kernel_for_nodes", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              {{kOnnxDomain, 13}}, {}, logger);
+  Graph& graph = model.MainGraph();
+  auto add_elu = [&graph](const std::string& name, ONNX_NAMESPACE::TensorProto_DataType elem_type) -> Node& {
+    ONNX_NAMESPACE::TypeProto tensor_type;
+    tensor_type.mutable_tensor_type()->set_elem_type(elem_type);
+    auto& input = graph.GetOrCreateNodeArg(name + "_in", &tensor_type);
+    auto& output = graph.GetOrCreateNodeArg(name + "_out", &tensor_type);
+    return graph.AddNode(name, "Elu", "", {&input}, {&output});
+  };
+  const Node& float_node_1 = add_elu("float_1", ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  const Node& float_node_2 = add_elu("float_2", ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  const Node& double_node = add_elu("double", ONNX_NAMESPACE::TensorProto_DataType_DOUBLE);
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  OpSchemaKernelTypeStrResolver kernel_type_str_resolver;
+  const KernelCreateInfo* float_info_1 = nullptr;
+  const KernelCreateInfo* float_info_2 = nullptr;
+  const KernelCreateInfo* double_info = nullptr;
+  ASSERT_STATUS_OK(r.TryFindKernel(float_node_1, kCpuExecutionProvider, kernel_type_str_resolver, logger, &float_info_1));
+  ASSERT_STATUS_OK(r.TryFindKernel(float_node_2, kCpuExecutionProvider, kernel_type_str_resolver, logger, &float_info_2));
+  ASSERT_STATUS_OK(r.TryFindKernel(double_node, kCpuExecutionProvider, kernel_type_str_resolver, logger, &double_info));
+  ASSERT_EQ(float_info_1, float_info_2);
+  ASSERT_NE(float_info_1, double_info);
+  EXPECT_EQ(float_info_1->kernel_def->TypeConstraints().at("T")[0], DataTypeImpl::GetTensorType<float>());
+  EXPECT_EQ(double_info->kernel_def->TypeConstraints().at("T")[0], DataTypeImpl::GetTensorType<double>());
+
+  const KernelCreateInfo* other_provider_info = nullptr;
+  ASSERT_STATUS_NOT_OK(r.TryFindKernel(float_node_1, kCudaExecutionProvider, kernel_type_str_resolver, logger,
+                                       &other_provider_info));
+  ASSERT_EQ(other_provider_info, nullptr);
+}
+#endif  // !defined(ORT_MINIMAL_BUILD)
+
 }  // namespace onnxruntime::test
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <filesystem>
+#include <fstream>
+
+#include "core/framework/allocator.h"
+#include "core/framework/prepacked_weights_store.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
+#include "gtest/gtest.h"
+#include "test/framework/test_utils.h"
+#include "test/test_environment.h"
+#include "test/util/include/asserts.h"
+#include "test/util/include/inference_session_wrapper.h"
+#include "test/util/include/temp_dir.h"
+
+namespace onnxruntime {
+namespace test {
+
+// Two buffers of floats plus a null placeholder, as some kernels produce.
+static PrePackedWeights CreatePackedWeights(float first_value) {
+  AllocatorPtr allocator = std::make_shared<CPUAllocator>();
+  PrePackedWeights packed_weights;
+  for (size_t count : {size_t{3}, size_t{17}}) {
+    auto buffer = IAllocator::MakeUniquePtr<void>(allocator, count * sizeof(float), true);
+    float* data = static_cast<float*>(buffer.get());
+    for (size_t i = 0; i < count; ++i) {
+      data[i] = first_value + static_cast<float>(i);
+    }
+    packed_weights.buffers_.push_back(std::move(buffer));
+    packed_weights.buffer_sizes_.push_back(count * sizeof(float));
+  }
+  packed_weights.buffers_.push_back(nullptr);
+  packed_weights.buffer_sizes_.push_back(0);
+  return packed_weights;
+}
+
+TEST(PrepackedWeightsStoreTest, PublishThenMap) {
+  TemporaryDirectory temp_dir(ORT_TSTR("prepacked_weights_store_test"));
+  const std::filesystem::path store_dir = std::filesystem::path(temp_dir.Path()) / "store";
+  PrepackedWeightsStore store(store_dir);
+
+  // the first "process" publishes the entry and gets buffers mapped from it
+  PrePackedWeights first = CreatePackedWeights(1.f);
+  const void* first_packed = first.buffers_[0].get();
+  const HashValue hash = first.GetHash();
+  ASSERT_STATUS_OK(store.MapOrPublish("MatMul+1", first));
+  ASSERT_TRUE(std::filesystem::exists(store_dir / "MatMul+1"));
+  ASSERT_NE(first.buffers_[0].get(), first_packed);
+  ASSERT_EQ(first.buffers_[2].get(), nullptr);
+  ASSERT_EQ(first.GetHash(), hash);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(first.buffers_[0].get()) % 64, 0U);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(first.buffers_[1].get()) % 64, 0U);
+  EXPECT_EQ(static_cast<const float*>(first.buffers_[1].get())[16], 17.f);
+
+  // a later one maps the existing entry
+  PrePackedWeights second = CreatePackedWeights(1.f);
+  ASSERT_STATUS_OK(store.MapOrPublish("MatMul+1", second));
+  ASSERT_EQ(second.GetHash(), hash);
+  ASSERT_EQ(std::distance(std::filesystem::directory_iterator(store_dir), std::filesystem::directory_iterator()), 1);
+
+  // the mapping outlives the PrePackedWeights instance it was created for
+  auto buffer = std::move(first.buffers_[1]);
+  first = PrePackedWeights{};
+  EXPECT_EQ(static_cast<const float*>(buffer.get())[0], 1.f);
+}
+
+TEST(PrepackedWeightsStoreTest, MismatchedEntryIsNotUsed) {
+  TemporaryDirectory temp_dir(ORT_TSTR("prepacked_weights_store_test"));
+  PrepackedWeightsStore store(temp_dir.Path());
+
+  PrePackedWeights published = CreatePackedWeights(1.f);
+  ASSERT_STATUS_OK(store.MapOrPublish("MatMul+2", published));
+
+  // same key and sizes but different content, as with a hash collision or a corrupted file
+  PrePackedWeights other = CreatePackedWeights(5.f);
+  const void* other_packed = other.buffers_[0].get();
+  ASSERT_FALSE(store.MapOrPublish("MatMul+2", other).IsOK());
+  ASSERT_EQ(other.buffers_[0].get(), other_packed);
+
+  // truncated file
+  std::filesystem::resize_file(std::filesystem::path(temp_dir.Path()) / "MatMul+2", 16);
+  PrePackedWeights truncated = CreatePackedWeights(1.f);
+  ASSERT_FALSE(store.MapOrPublish("MatMul+2", truncated).IsOK());
+}
+
+// A session publishes the weights its CPU kernels pre-pack into the store, and a later session maps them.
+TEST(PrepackedWeightsStoreTest, SharedBetweenSessions) {
+  TemporaryDirectory temp_dir(ORT_TSTR("prepacked_weights_store_test"));
+  const std::filesystem::path store_dir = std::filesystem::path(temp_dir.Path()) / "store";
+
+  SessionOptions so;
+  so.session_logid = "PrepackedWeightsStoreTest.SharedBetweenSessions";
+  ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsPrepackedWeightsStoreDirectory,
+                                                    ToUTF8String(store_dir.native()).c_str()));
+
+  // testdata/matmul_1.onnx multiplies X by the constant [[1], [2]], which MatMul pre-packs
+  OrtValue x;
+  CreateMLValue<float>(TestCPUExecutionProvider()->CreatePreferredAllocators()[0], {3, 2},
+                       {1.f, 2.f, 3.f, 4.f, 5.f, 6.f}, &x);
+  NameMLValMap feeds{{"X", x}};
+  const std::vector<std::string> output_names{"Y"};
+  const std::vector<float> expected_y{5.f, 11.f, 17.f};
+
+  std::filesystem::path entry;
+  std::filesystem::file_time_type entry_time;
+  for (int i = 0; i < 2; ++i) {
+    InferenceSessionWrapper session{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session.Load(ORT_TSTR("testdata/matmul_1.onnx")));
+    ASSERT_STATUS_OK(session.Initialize());
+    ASSERT_EQ(session.GetSessionState().GetNumberOfPrepacksCounter(), static_cast<size_t>(1));
+
+    // the first session publishes the only entry, the second one maps it without writing it again
+    std::vector<std::filesystem::path> entries(std::filesystem::directory_iterator(store_dir),
+                                               std::filesystem::directory_iterator{});
+    ASSERT_EQ(entries.size(), static_cast<size_t>(1));
+    if (i == 0) {
+      entry = entries[0];
+      entry_time = std::filesystem::last_write_time(entry);
+    } else {
+      EXPECT_EQ(entries[0], entry);
+      EXPECT_EQ(std::filesystem::last_write_time(entry), entry_time);
+    }
+
+    std::vector<OrtValue> fetches;
+    RunOptions run_options;
+    ASSERT_STATUS_OK(session.Run(run_options, feeds, output_names, &fetches));
+    const auto y = fetches[0].Get<Tensor>().DataAsSpan<float>();
+    EXPECT_EQ(std::vector<float>(y.begin(), y.end()), expected_y);
+  }
+}
+
+}  // namespace test
+}  // namespace onnxruntime
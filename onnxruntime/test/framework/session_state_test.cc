@@ -758,6 +758,7 @@ static void PlaceAllNodesToCPUEP(Graph& graph) {
 struct PrepackingTestParam {
   bool test_subgraph;
   bool test_prepacking;
+  bool test_parallel_kernel_initialization = false;
 };
 
 class SessionStatePrepackingTest : public testing::TestWithParam<PrepackingTestParam> {};
@@ -765,6 +766,10 @@ TEST_P(SessionStatePrepackingTest, PrePackingTest) {
   PrepackingTestParam test_param = GetParam();
 
   OrtThreadPoolParams to;
+  if (test_param.test_parallel_kernel_initialization) {
+    // kernels are only initialized in parallel with more than one thread, whatever the number of cores
+    to.thread_pool_size = 4;
+  }
   auto tp = concurrency::CreateThreadPool(&onnxruntime::Env::Default(), to, concurrency::ThreadPoolType::INTRA_OP);
   ONNX_OPERATOR_SCHEMA(PrePackingTest)
       .SetDoc("Faking Node for PrePacking")
@@ -800,6 +805,8 @@ TEST_P(SessionStatePrepackingTest, PrePackingTest) {
   sess_options.enable_mem_reuse = true;
   sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] =
       test_param.test_prepacking ? "0" : "1";
+  sess_options.config_options.configurations[kOrtSessionOptionsParallelKernelInitialization] =
+      test_param.test_parallel_kernel_initialization ? "1" : "0";
 
   SessionState session_state(model.MainGraph(),
                              execution_providers,
@@ -1103,6 +1110,87 @@ TEST_F(SessionStateTestSharedInitalizersWithPrePacking, test3) {
   ASSERT_EQ(session_state_2.GetUsedSharedPrePackedWeightCounter(), static_cast<size_t>(1));
 }
 
+// Pre-packing enabled + shared initializers + pre-packed weights container + parallel kernel initialization =
+// one kernel writes the pre-packed weight into the container and all the others use the cached one
+TEST_F(SessionStateTestSharedInitalizersWithPrePacking, ParallelKernelInitialization) {
+  SessionOptions sess_options;
+  sess_options.enable_mem_pattern = true;
+  sess_options.execution_mode = ExecutionMode::ORT_SEQUENTIAL;
+  sess_options.use_deterministic_compute = false;
+  sess_options.enable_mem_reuse = true;
+  sess_options.config_options.configurations[kOrtSessionOptionsConfigDisablePrepacking] = "0";
+  sess_options.config_options.configurations[kOrtSessionOptionsParallelKernelInitialization] = "1";
+
+  // kernels are only initialized in parallel with more than one thread, whatever the number of cores
+  OrtThreadPoolParams to;
+  to.thread_pool_size = 4;
+  tp = concurrency::CreateThreadPool(&onnxruntime::Env::Default(), to, concurrency::ThreadPoolType::INTRA_OP);
+
+  OrtMemoryInfo mem_info(CPU, OrtDeviceAllocator);
+  std::vector<float> float_data(1, 1);
+  auto value = std::make_unique<OrtValue>();
+  Tensor::InitOrtValue(DataTypeImpl::GetType<float>(), TensorShape(std::vector<int64_t>{1}),
+                       reinterpret_cast<void*>(float_data.data()), mem_info, *value);
+  ASSERT_STATUS_OK(sess_options.AddInitializer("shared_weight", value.get()));
+
+  PrepackedWeightsContainer prepacked_weights_container;
+
+  Model model("graph_main", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              domain_to_version, std::vector<ONNX_NAMESPACE::FunctionProto>(),
+              DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  TypeProto type;
+  type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+  // a chain of nodes all consuming the same weight
+  constexpr int num_nodes = 16;
+  auto* previous_output = &graph.GetOrCreateNodeArg("input", &type);
+  auto& weight = graph.GetOrCreateNodeArg("shared_weight", &type);
+  for (int i = 0; i < num_nodes; ++i) {
+    auto& output = graph.GetOrCreateNodeArg("output_" + std::to_string(i), &type);
+    graph.AddNode("node_" + std::to_string(i), "PrePackingTest", "node", {previous_output, &weight}, {&output});
+    previous_output = &output;
+  }
+
+  ONNX_NAMESPACE::TensorProto tensor;
+  tensor.add_dims(1);
+  tensor.add_float_data(1.0f);
+  tensor.set_data_type(TensorProto_DataType_FLOAT);
+  tensor.set_name("shared_weight");
+  graph.AddInitializedTensor(tensor);
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  PlaceAllNodesToCPUEP(graph);
+  SessionState session_state(graph,
+                             execution_providers,
+                             tp.get(),
+                             nullptr, /*inter_op_thread_pool*/
+                             dtm,
+                             edlm,
+                             DefaultLoggingManager().DefaultLogger(),
+                             profiler,
+                             sess_options,
+                             &prepacked_weights_container);
+
+  ASSERT_STATUS_OK(session_state.FinalizeSessionState(std::basic_string<PATH_CHAR_TYPE>(),
+                                                      kernel_registry_manager));
+
+  ASSERT_EQ(session_state.GetNumberOfPrepacksCounter(), static_cast<size_t>(num_nodes));
+  ASSERT_EQ(session_state.GetUsedSharedPrePackedWeightCounter(), static_cast<size_t>(num_nodes - 1));
+  ASSERT_EQ(prepacked_weights_container.GetNumberOfElements(), static_cast<size_t>(1));
+  for (const auto& node : graph.Nodes()) {
+    const auto* kernel = reinterpret_cast<const PrePackingTestOpKernel*>(session_state.GetKernel(node.Index()));
+    ASSERT_NE(kernel, nullptr);
+    ASSERT_EQ(kernel->prepack_calls_count, 1);
+    ASSERT_EQ(kernel->store_pre_packed_weight_calls_count, 1);
+  }
+
+  // all the consumers pre-packed the weight so it was released
+  ASSERT_TRUE(session_state.GetConstantInitializedTensors().empty());
+}
+
 // Pre-packing enabled + shared initializers +
 // pre-packed weights container + subgraphs =
 // caching enabled in pre-packed weights used in subgraphs
@@ -1424,7 +1512,9 @@ INSTANTIATE_TEST_SUITE_P(SessionStateTests,
                          testing::Values(PrepackingTestParam{false, false},
                                          PrepackingTestParam{false, true},
                                          PrepackingTestParam{true, false},
-                                         PrepackingTestParam{true, true}));
+                                         PrepackingTestParam{true, true},
+                                         PrepackingTestParam{false, true, true},
+                                         PrepackingTestParam{true, true, true}));
 #endif
 
 }  // namespace test
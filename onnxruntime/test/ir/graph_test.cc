@@ -27,6 +27,9 @@ using namespace ONNX_NAMESPACE;
 namespace onnxruntime {
 namespace test {
 
+// number of times the type and shape inferencing of Counted_Fake ran
+static int counted_fake_inference_count = 0;
+
 static bool RegisterCustomSchemas() {
   OPERATOR_SCHEMA(Variable_DFS)
       .SetDoc("Input variable.")
@@ -104,6 +107,17 @@ static bool RegisterCustomSchemas() {
         fail_shape_inference("try harder");
       });
 
+  OPERATOR_SCHEMA(Counted_Fake)
+      .SetDoc("Counts the calls to its type and shape inferencing.")
+      .Input(0, "input_1", "docstr for input_1.", "tensor(int32)")
+      .Output(0, "output_1", "docstr for output_1.", "tensor(int32)")
+      .Attr("unused", "Attribute that has no effect.", AttributeProto::INT, OPTIONAL_VALUE)
+      .TypeAndShapeInferenceFunction([](InferenceContext& ctx) {
+        ++counted_fake_inference_count;
+        propagateElemTypeFromInputToOutput(ctx, 0, 0);
+        propagateShapeFromInputToOutput(ctx, 0, 0);
+      });
+
   OPERATOR_SCHEMA(Fake_Sub)
       .SinceVersion(1)
       .SetDomain(kMSNchwcDomain)
@@ -1507,6 +1521,53 @@ TEST_F(GraphTest, ShapeInferenceErrorHandling) {
                                       "Node (node_1) Op (ShapeInferenceThrowsOp) [ShapeInferenceError] try harder");
 }
 
+TEST_F(GraphTest, ResolveOnlyInfersChangedNodes) {
+  Model model("graph", false, *logger_);
+  auto& graph = model.MainGraph();
+
+  TypeProto tensor_int32;
+  tensor_int32.mutable_tensor_type()->set_elem_type(TensorProto_DataType_INT32);
+
+  // in -> node_0 -> node_1 -> node_2
+  std::vector<Node*> nodes;
+  NodeArg& graph_input = graph.GetOrCreateNodeArg("in", &tensor_int32);
+  NodeArg* input = &graph_input;
+  for (int i = 0; i < 3; ++i) {
+    NodeArg* output = &graph.GetOrCreateNodeArg("out_" + std::to_string(i), nullptr);
+    nodes.push_back(&graph.AddNode("node_" + std::to_string(i), "Counted_Fake", "", {input}, {output}));
+    input = output;
+  }
+
+  counted_fake_inference_count = 0;
+  ASSERT_STATUS_OK(graph.Resolve());
+  EXPECT_EQ(counted_fake_inference_count, 3);
+
+  // only the new node is inferred
+  NodeArg& new_output = graph.GetOrCreateNodeArg("out_3", nullptr);
+  graph.AddNode("node_3", "Counted_Fake", "", {input}, {&new_output});
+  counted_fake_inference_count = 0;
+  ASSERT_STATUS_OK(graph.Resolve());
+  EXPECT_EQ(counted_fake_inference_count, 1);
+  ASSERT_NE(new_output.Type(), nullptr);
+
+  // a node whose attributes changed is inferred again, but its consumers are not as its output is unchanged
+  nodes[1]->AddAttribute("unused", static_cast<int64_t>(1));
+  counted_fake_inference_count = 0;
+  ASSERT_STATUS_OK(graph.Resolve());
+  EXPECT_EQ(counted_fake_inference_count, 1);
+
+  // a new shape is propagated through all the consumers
+  TensorShapeProto shape;
+  shape.add_dim()->set_dim_value(4);
+  graph_input.SetShape(shape);
+  graph.SetGraphResolveNeeded();
+  counted_fake_inference_count = 0;
+  ASSERT_STATUS_OK(graph.Resolve());
+  EXPECT_EQ(counted_fake_inference_count, 4);
+  ASSERT_NE(new_output.Shape(), nullptr);
+  EXPECT_EQ(new_output.Shape()->dim(0).dim_value(), 4);
+}
+
 TEST_F(GraphTest, AddTensorAttribute) {
   OPERATOR_SCHEMA(__Constant)
       .SetDoc("Constant Op.")
@@ -2,7 +2,12 @@
 // Licensed under the MIT License.
 
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <numeric>
+#include "core/framework/tensorprotoutils.h"
 #include "core/platform/env.h"
 #include "core/graph/graph_viewer.h"
 #include "core/graph/model.h"
@@ -10,6 +15,7 @@
 #include "core/session/onnxruntime_c_api.h"
 #include "test/providers/provider_test_utils.h"  //For ASSERT_STATUS_OK
 #include "test/test_environment.h"
+#include "test/util/include/temp_dir.h"
 #include "gtest/gtest.h"
 #include "onnx/defs/function.h"
 #include "onnx/defs/parser.h"
@@ -189,6 +195,72 @@ TEST_F(ONNXModelsTest, TestModelsWithAnOpContainingAFunctionBody) {
   ASSERT_STATUS_OK(model->MainGraph().Resolve());
 }
 
+// test loading a model with ModelOptions::load_initializers_in_place. the raw data of the large initializer is left
+// in the model file and referenced as external data wherever protobuf put it, and the small one is parsed as usual.
+TEST_F(ONNXModelsTest, LoadInitializersInPlace) {
+  ModelProto model_proto;
+  model_proto.set_ir_version(ONNX_NAMESPACE::Version::IR_VERSION);
+  auto* opset = model_proto.add_opset_import();
+  opset->set_domain("");
+  opset->set_version(17);
+
+  auto* graph = model_proto.mutable_graph();
+  graph->set_name("in_place");
+  std::vector<float> large_values(4096);
+  std::iota(large_values.begin(), large_values.end(), 0.f);
+  const std::vector<float> small_values{1.f, 2.f, 3.f, 4.f};
+  for (const auto* values : {&large_values, &small_values}) {
+    auto* initializer = graph->add_initializer();
+    initializer->set_name(values == &large_values ? "large" : "small");
+    initializer->set_data_type(TensorProto_DataType_FLOAT);
+    initializer->add_dims(static_cast<int64_t>(values->size()));
+    initializer->set_raw_data(values->data(), values->size() * sizeof(float));
+  }
+  auto* node = graph->add_node();
+  node->set_op_type("Concat");
+  node->add_input("large");
+  node->add_input("small");
+  node->add_output("Y");
+  auto* axis = node->add_attribute();
+  axis->set_name("axis");
+  axis->set_type(AttributeProto_AttributeType_INT);
+  axis->set_i(0);
+  auto* output = graph->add_output();
+  output->set_name("Y");
+  output->mutable_type()->mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+  TemporaryDirectory temp_dir(ORT_TSTR("load_initializers_in_place_test"));
+  const std::filesystem::path model_path = std::filesystem::path(temp_dir.Path()) / ORT_TSTR("model.onnx");
+
+  {
+    const std::string serialized = model_proto.SerializeAsString();
+    std::ofstream model_file(model_path, std::ios::binary);
+    model_file.write(serialized.data(), static_cast<std::streamsize>(serialized.size()));
+    ASSERT_TRUE(model_file.good());
+  }
+
+  ModelOptions options;
+  options.load_initializers_in_place = true;
+  std::shared_ptr<Model> model;
+  ASSERT_STATUS_OK(Model::Load(model_path.native(), model, nullptr, *logger_, options));
+
+  const Graph& main_graph = model->MainGraph();
+  const TensorProto* large = nullptr;
+  const TensorProto* small = nullptr;
+  ASSERT_TRUE(main_graph.GetInitializedTensor("large", large));
+  ASSERT_TRUE(main_graph.GetInitializedTensor("small", small));
+  EXPECT_EQ(utils::HasExternalData(*large), endian::native == endian::little);
+  EXPECT_FALSE(utils::HasExternalData(*small));
+
+  std::vector<uint8_t> unpacked;
+  ASSERT_STATUS_OK(utils::UnpackInitializerData(*large, model_path, unpacked));
+  ASSERT_EQ(unpacked.size(), large_values.size() * sizeof(float));
+  EXPECT_EQ(std::memcmp(unpacked.data(), large_values.data(), unpacked.size()), 0);
+  ASSERT_STATUS_OK(utils::UnpackInitializerData(*small, model_path, unpacked));
+  ASSERT_EQ(unpacked.size(), small_values.size() * sizeof(float));
+  EXPECT_EQ(std::memcmp(unpacked.data(), small_values.data(), unpacked.size()), 0);
+}
+
 // The following tests verify ORT can successfully load models which reference functions
 // present in the ModelProto aka model local functions. This feature was added to ONNX standard starting IRv8
 
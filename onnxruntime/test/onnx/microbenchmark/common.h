@@ -10,6 +10,18 @@
 
 #include "core/common/common.h"
 
+// Skips the benchmark with the error message of a failed OrtApi call and returns from the benchmark function.
+// The calling function must have benchmark::State& state and const OrtApi* g_ort in scope.
+#define ORT_BENCHMARK_SKIP_ON_ERROR(expr)                       \
+  do {                                                          \
+    OrtStatus* onnx_status = (expr);                            \
+    if (onnx_status != NULL) {                                  \
+      state.SkipWithError(g_ort->GetErrorMessage(onnx_status)); \
+      g_ort->ReleaseStatus(onnx_status);                        \
+      return;                                                   \
+    }                                                           \
+  } while (0);
+
 // aligned memory allocate and free functions
 inline void* aligned_alloc(size_t size, size_t align) {
   void* ptr;
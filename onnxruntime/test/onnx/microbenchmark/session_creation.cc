@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/graph/onnx_protobuf.h>
+#include <core/session/onnxruntime_c_api.h>
+
+#include <memory>
+#include <string>
+
+#include "common.h"
+
+extern OrtEnv* env;
+extern const OrtApi* g_ort;
+
+namespace {
+
+constexpr int64_t kWidth = 64;
+
+ONNX_NAMESPACE::NodeProto* AddNode(ONNX_NAMESPACE::GraphProto& graph, const std::string& op_type,
+                                   const std::string& input, const std::string& output) {
+  auto* node = graph.add_node();
+  node->set_op_type(op_type);
+  node->add_input(input);
+  node->add_output(output);
+  return node;
+}
+
+// Serializes a model with a chain of num_blocks blocks of Identity -> Dropout -> Cast -> Add -> Relu.
+// The Identity, Dropout and Cast nodes are removed by the rule-based transformers, which modify the graph
+// all over, so creating a session is dominated by the graph transformations and the Graph::Resolve calls between.
+std::string MakeModel(int64_t num_blocks) {
+  ONNX_NAMESPACE::ModelProto model;
+  model.set_ir_version(ONNX_NAMESPACE::IR_VERSION);
+  auto* opset = model.add_opset_import();
+  opset->set_domain("");
+  opset->set_version(17);
+
+  auto* graph = model.mutable_graph();
+  graph->set_name("chain");
+  auto* input = graph->add_input();
+  input->set_name("X");
+  auto* input_type = input->mutable_type()->mutable_tensor_type();
+  input_type->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  input_type->mutable_shape()->add_dim()->set_dim_param("N");
+  input_type->mutable_shape()->add_dim()->set_dim_value(kWidth);
+
+  std::string value = "X";
+  for (int64_t i = 0; i < num_blocks; ++i) {
+    const std::string block = std::to_string(i);
+    AddNode(*graph, "Identity", value, "identity_" + block);
+    AddNode(*graph, "Dropout", "identity_" + block, "dropout_" + block);
+    auto* cast = AddNode(*graph, "Cast", "dropout_" + block, "cast_" + block);
+    auto* to = cast->add_attribute();
+    to->set_name("to");
+    to->set_type(ONNX_NAMESPACE::AttributeProto_AttributeType_INT);
+    to->set_i(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+
+    auto* bias = graph->add_initializer();
+    bias->set_name("bias_" + block);
+    bias->set_data_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+    bias->add_dims(kWidth);
+    for (int64_t j = 0; j < kWidth; ++j) {
+      bias->add_float_data(static_cast<float>(j));
+    }
+    AddNode(*graph, "Add", "cast_" + block, "add_" + block)->add_input("bias_" + block);
+
+    value = "relu_" + block;
+    AddNode(*graph, "Relu", "add_" + block, value);
+  }
+
+  auto* output = graph->add_output();
+  output->set_name(value);
+  output->mutable_type()->mutable_tensor_type()->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_FLOAT);
+  return model.SerializeAsString();
+}
+
+}  // namespace
+
+// Arguments: the number of blocks in the model (see MakeModel) and the graph optimization level.
+static void BM_CreateSessionLargeGraph(benchmark::State& state) {
+  const std::string model = MakeModel(state.range(0));
+
+  OrtSessionOptions* session_options;
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->CreateSessionOptions(&session_options));
+  // releases the options when a check below skips the benchmark too
+  std::unique_ptr<OrtSessionOptions, decltype(g_ort->ReleaseSessionOptions)> session_options_holder(
+      session_options, g_ort->ReleaseSessionOptions);
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->SetSessionGraphOptimizationLevel(
+      session_options, static_cast<GraphOptimizationLevel>(state.range(1))));
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->SetIntraOpNumThreads(session_options, 1));
+
+  for (auto _ : state) {
+    OrtSession* session;
+    ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->CreateSessionFromArray(env, model.data(), model.size(), session_options,
+                                                              &session));
+    state.PauseTiming();
+    g_ort->ReleaseSession(session);
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK(BM_CreateSessionLargeGraph)
+    ->ArgsProduct({{1000, 10000}, {ORT_ENABLE_BASIC, ORT_ENABLE_ALL}})
+    ->Unit(benchmark::TimeUnit::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <benchmark/benchmark.h>
+#include <core/graph/onnx_protobuf.h>
+#include <core/session/onnxruntime_c_api.h>
+
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+extern OrtEnv* env;
+extern const OrtApi* g_ort;
+
+namespace {
+
+enum TextOp {
+  kStringNormalizer = 0,
+  kStringSplit = 1,
+  kRegexFullMatch = 2,
+};
+
+void AddOutput(ONNX_NAMESPACE::GraphProto& graph, const std::string& name, int32_t elem_type) {
+  auto* output = graph.add_output();
+  output->set_name(name);
+  output->mutable_type()->mutable_tensor_type()->set_elem_type(elem_type);
+}
+
+// Serializes a model running one text operator on a 1-D string input named X.
+std::string MakeModel(TextOp op, std::vector<std::string>& output_names) {
+  ONNX_NAMESPACE::ModelProto model;
+  model.set_ir_version(ONNX_NAMESPACE::IR_VERSION);
+  auto* opset = model.add_opset_import();
+  opset->set_domain("");
+  opset->set_version(20);
+
+  auto* graph = model.mutable_graph();
+  graph->set_name("text");
+  auto* input = graph->add_input();
+  input->set_name("X");
+  auto* input_type = input->mutable_type()->mutable_tensor_type();
+  input_type->set_elem_type(ONNX_NAMESPACE::TensorProto_DataType_STRING);
+  input_type->mutable_shape()->add_dim()->set_dim_param("N");
+
+  auto* node = graph->add_node();
+  node->add_input("X");
+  node->add_output("Y");
+  auto add_attribute = [node](const std::string& name, ONNX_NAMESPACE::AttributeProto_AttributeType type) {
+    auto* attribute = node->add_attribute();
+    attribute->set_name(name);
+    attribute->set_type(type);
+    return attribute;
+  };
+
+  output_names = {"Y"};
+  switch (op) {
+    case kStringNormalizer: {
+      node->set_op_type("StringNormalizer");
+      add_attribute("case_change_action", ONNX_NAMESPACE::AttributeProto_AttributeType_STRING)->set_s("LOWER");
+      add_attribute("is_case_sensitive", ONNX_NAMESPACE::AttributeProto_AttributeType_INT)->set_i(0);
+      auto* stopwords = add_attribute("stopwords", ONNX_NAMESPACE::AttributeProto_AttributeType_STRINGS);
+      for (const char* word : {"the", "a", "of", "and", "to", "in"}) {
+        stopwords->add_strings(word);
+      }
+      AddOutput(*graph, "Y", ONNX_NAMESPACE::TensorProto_DataType_STRING);
+      break;
+    }
+    case kStringSplit:
+      node->set_op_type("StringSplit");
+      node->add_output("Z");
+      output_names.push_back("Z");
+      AddOutput(*graph, "Y", ONNX_NAMESPACE::TensorProto_DataType_STRING);
+      AddOutput(*graph, "Z", ONNX_NAMESPACE::TensorProto_DataType_INT64);
+      break;
+    case kRegexFullMatch:
+      node->set_op_type("RegexFullMatch");
+      add_attribute("pattern", ONNX_NAMESPACE::AttributeProto_AttributeType_STRING)->set_s("[A-Za-z]+ [a-z]+.*");
+      AddOutput(*graph, "Y", ONNX_NAMESPACE::TensorProto_DataType_BOOL);
+      break;
+  }
+  return model.SerializeAsString();
+}
+
+// Sentences of a few words for StringSplit, single words otherwise.
+// One word in non_ascii_percent is not ASCII.
+std::vector<std::string> MakeInput(TextOp op, size_t count, int64_t non_ascii_percent) {
+  static const char* const ascii_words[] = {"The", "quick", "brown", "fox", "jumps", "over", "the", "lazy", "dog",
+                                            "and", "a", "Cat", "of", "to", "in", "Monday"};
+  static const char* const non_ascii_words[] = {"École", "Понедельник", "grüßen", "Besançon"};
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<size_t> ascii(0, std::size(ascii_words) - 1);
+  std::uniform_int_distribution<size_t> non_ascii(0, std::size(non_ascii_words) - 1);
+  std::uniform_int_distribution<int64_t> percent(0, 99);
+  auto word = [&]() -> std::string {
+    return percent(gen) < non_ascii_percent ? non_ascii_words[non_ascii(gen)] : ascii_words[ascii(gen)];
+  };
+
+  std::vector<std::string> input(count);
+  for (auto& s : input) {
+    s = word();
+    if (op != kStringNormalizer) {
+      for (int i = 0; i < 7; ++i) {
+        s += ' ';
+        s += word();
+      }
+    }
+  }
+  return input;
+}
+
+}  // namespace
+
+// Arguments: the operator (see TextOp), the number of strings, the number of intra-op threads
+// and the percentage of non ASCII words.
+static void BM_TextOp(benchmark::State& state) {
+  const auto op = static_cast<TextOp>(state.range(0));
+  const auto count = static_cast<size_t>(state.range(1));
+  const auto num_threads = static_cast<int>(state.range(2));
+  const int64_t non_ascii_percent = state.range(3);
+
+  std::vector<std::string> output_names;
+  const std::string model = MakeModel(op, output_names);
+
+  OrtSessionOptions* session_options;
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->CreateSessionOptions(&session_options));
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->SetIntraOpNumThreads(session_options, num_threads));
+  OrtSession* session;
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->CreateSessionFromArray(env, model.data(), model.size(), session_options,
+                                                            &session));
+
+  OrtAllocator* allocator;
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->GetAllocatorWithDefaultOptions(&allocator));
+  const std::vector<std::string> input = MakeInput(op, count, non_ascii_percent);
+  std::vector<const char*> input_data;
+  for (const auto& s : input) {
+    input_data.push_back(s.c_str());
+  }
+  const int64_t shape[] = {static_cast<int64_t>(count)};
+  OrtValue* input_value = nullptr;
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->CreateTensorAsOrtValue(allocator, shape, 1,
+                                                            ONNX_TENSOR_ELEMENT_DATA_TYPE_STRING, &input_value));
+  ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->FillStringTensor(input_value, input_data.data(), input_data.size()));
+
+  const char* input_names[] = {"X"};
+  std::vector<const char*> output_name_ptrs;
+  for (const auto& name : output_names) {
+    output_name_ptrs.push_back(name.c_str());
+  }
+  std::vector<OrtValue*> outputs(output_names.size(), nullptr);
+
+  for (auto _ : state) {
+    ORT_BENCHMARK_SKIP_ON_ERROR(g_ort->Run(session, nullptr, input_names, &input_value, 1, output_name_ptrs.data(),
+                                           output_name_ptrs.size(), outputs.data()));
+    state.PauseTiming();
+    for (auto*& output : outputs) {
+      g_ort->ReleaseValue(output);
+      output = nullptr;
+    }
+    state.ResumeTiming();
+  }
+
+  g_ort->ReleaseValue(input_value);
+  g_ort->ReleaseSession(session);
+  g_ort->ReleaseSessionOptions(session_options);
+}
+
+BENCHMARK(BM_TextOp)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->ArgsProduct({{kStringNormalizer, kStringSplit, kRegexFullMatch}, {100, 10000}, {1, 4}, {0, 10}});
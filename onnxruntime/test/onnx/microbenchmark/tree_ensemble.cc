@@ -0,0 +1,153 @@
+#include "common.h"
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+#include "core/framework/allocator.h"
+#include "core/framework/tensor.h"
+#include "core/providers/cpu/ml/tree_ensemble_common.h"
+
+using namespace onnxruntime;
+using namespace onnxruntime::ml::detail;
+
+namespace {
+
+constexpr int64_t kNumFeatures = 32;
+constexpr int64_t kNumClasses = 3;
+
+// Exposes the evaluation of TreeEnsembleCommon without an OpKernelContext.
+class BenchmarkTreeEnsemble : public TreeEnsembleCommon<float, float, float> {
+ public:
+  void DisableQuickScorer() { quick_scorer_.reset(); }
+
+  void Compute(const Tensor* X, Tensor* Y) const {
+    ComputeAgg(nullptr, X, Y, nullptr,
+               TreeAggregatorSum<float, float, float>(onnxruntime::narrow<size_t>(n_trees_), n_targets_or_classes_,
+                                                      post_transform_, base_values_));
+  }
+
+  // Same as TreeEnsembleCommonClassifier::compute with int64 class labels and weights of both signs.
+  void ComputeClassifier(const Tensor* X, Tensor* Y, Tensor* label, const std::vector<int64_t>& class_labels) const {
+    ComputeAgg(nullptr, X, Y, label,
+               TreeAggregatorClassifier<float, float, float>(onnxruntime::narrow<size_t>(n_trees_),
+                                                             n_targets_or_classes_, post_transform_, base_values_,
+                                                             class_labels, false, false));
+  }
+};
+
+// Builds a forest of complete trees of the given depth with random features and thresholds,
+// the shape of a gradient boosting ranker with one target, or of a gradient boosting classifier
+// with one tree per class and round when n_classes > 1.
+TreeEnsembleAttributesV3<float> MakeForest(int64_t n_trees, int64_t depth, int64_t n_classes = 1) {
+  std::mt19937 gen(17);
+  std::uniform_real_distribution<float> values(-1.0f, 1.0f);
+  std::uniform_int_distribution<int64_t> features(0, kNumFeatures - 1);
+
+  TreeEnsembleAttributesV3<float> attributes;
+  attributes.aggregate_function = "SUM";
+  attributes.post_transform = n_classes > 1 ? "SOFTMAX" : "NONE";
+  attributes.n_targets_or_classes = n_classes;
+
+  const int64_t n_internal = (int64_t(1) << depth) - 1;
+  const int64_t n_nodes = 2 * n_internal + 1;
+  for (int64_t tree = 0; tree < n_trees; ++tree) {
+    for (int64_t node = 0; node < n_nodes; ++node) {
+      const bool is_leaf = node >= n_internal;
+      attributes.nodes_treeids.push_back(tree);
+      attributes.nodes_nodeids.push_back(node);
+      attributes.nodes_featureids.push_back(is_leaf ? 0 : features(gen));
+      attributes.nodes_values.push_back(is_leaf ? 0.0f : values(gen));
+      attributes.nodes_modes.push_back(is_leaf ? NODE_MODE_ONNX::LEAF : NODE_MODE_ONNX::BRANCH_LEQ);
+      attributes.nodes_truenodeids.push_back(is_leaf ? 0 : 2 * node + 1);
+      attributes.nodes_falsenodeids.push_back(is_leaf ? 0 : 2 * node + 2);
+      if (is_leaf) {
+        attributes.target_class_treeids.push_back(tree);
+        attributes.target_class_nodeids.push_back(node);
+        attributes.target_class_ids.push_back(tree % n_classes);
+        attributes.target_class_weights.push_back(values(gen));
+      }
+    }
+  }
+  return attributes;
+}
+
+}  // namespace
+
+// Arguments: number of trees, tree depth, number of rows, and the evaluation: 0 for the pointer-based traversal,
+// 1 for QuickScorer, 2 for TreeEnsembleCompactNodes.
+static void BM_TreeEnsembleRegressor(benchmark::State& state) {
+  const int64_t n_trees = state.range(0);
+  const int64_t depth = state.range(1);
+  const int64_t n_rows = state.range(2);
+  const int64_t evaluation = state.range(3);
+
+  BenchmarkTreeEnsemble ensemble;
+  ORT_THROW_IF_ERROR(ensemble.Init(80, 128, 50, MakeForest(n_trees, depth)));
+  if (evaluation == 0) {
+    ensemble.DisableQuickScorer();
+  } else if (evaluation == 2 && !ensemble.CompactNodes()) {
+    state.SkipWithError("The forest cannot be stored in the compact format.");
+    return;
+  }
+
+  auto allocator = std::make_shared<CPUAllocator>();
+  Tensor X(DataTypeImpl::GetType<float>(), TensorShape({n_rows, kNumFeatures}), allocator);
+  Tensor Y(DataTypeImpl::GetType<float>(), TensorShape({n_rows, 1}), allocator);
+  float* data = GenerateArrayWithRandomValue<float>(static_cast<size_t>(n_rows * kNumFeatures), -1, 1);
+  std::copy(data, data + n_rows * kNumFeatures, X.MutableData<float>());
+  aligned_free(data);
+
+  for (auto _ : state) {
+    ensemble.Compute(&X, &Y);
+  }
+}
+
+BENCHMARK(BM_TreeEnsembleRegressor)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->ArgsProduct({{100, 2000}, {4, 6, 10}, {1000}, {0, 1, 2}});
+
+// Pointer-based traversal across tree depth and batch size, the rows of a batch are walked down
+// every tree together (see TreeEnsembleCommon::ProcessTreeNodeLeaves).
+BENCHMARK(BM_TreeEnsembleRegressor)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->ArgsProduct({{100}, {6, 8, 10, 12}, {1, 8, 64, 1000, 10000}, {0}});
+
+// Same arguments as BM_TreeEnsembleRegressor, the number of trees counts the trees of all classes.
+static void BM_TreeEnsembleClassifier(benchmark::State& state) {
+  const int64_t n_trees = state.range(0);
+  const int64_t depth = state.range(1);
+  const int64_t n_rows = state.range(2);
+  const int64_t evaluation = state.range(3);
+
+  BenchmarkTreeEnsemble ensemble;
+  ORT_THROW_IF_ERROR(ensemble.Init(80, 128, 50, MakeForest(n_trees, depth, kNumClasses)));
+  if (evaluation == 0) {
+    ensemble.DisableQuickScorer();
+  } else if (evaluation == 2 && !ensemble.CompactNodes()) {
+    state.SkipWithError("The forest cannot be stored in the compact format.");
+    return;
+  }
+
+  std::vector<int64_t> class_labels(kNumClasses);
+  std::iota(class_labels.begin(), class_labels.end(), 0);
+  auto allocator = std::make_shared<CPUAllocator>();
+  Tensor X(DataTypeImpl::GetType<float>(), TensorShape({n_rows, kNumFeatures}), allocator);
+  Tensor Y(DataTypeImpl::GetType<float>(), TensorShape({n_rows, kNumClasses}), allocator);
+  Tensor label(DataTypeImpl::GetType<int64_t>(), TensorShape({n_rows}), allocator);
+  float* data = GenerateArrayWithRandomValue<float>(static_cast<size_t>(n_rows * kNumFeatures), -1, 1);
+  std::copy(data, data + n_rows * kNumFeatures, X.MutableData<float>());
+  aligned_free(data);
+
+  for (auto _ : state) {
+    ensemble.ComputeClassifier(&X, &Y, &label, class_labels);
+  }
+}
+
+BENCHMARK(BM_TreeEnsembleClassifier)
+    ->UseRealTime()
+    ->Unit(benchmark::TimeUnit::kMicrosecond)
+    ->ArgsProduct({{300, 3000}, {4, 6, 10}, {1000}, {0, 1, 2}});
@@ -62,6 +62,7 @@
 #include "core/optimizer/matmul_transpose_fusion.h"
 #include "core/optimizer/noop_elimination.h"
 #include "core/optimizer/not_where_fusion.h"
+#include "core/optimizer/onehot_matmul_fusion.h"
 #include "core/optimizer/pad_fusion.h"
 #include "core/optimizer/pre_shape_node_elimination.h"
 #include "core/optimizer/propagate_cast_ops.h"
@@ -71,12 +72,15 @@
 #include "core/optimizer/reshape_fusion.h"
 #include "core/optimizer/rule_based_graph_transformer.h"
 #include "core/optimizer/slice_elimination.h"
+#include "core/optimizer/symbolic_shape_folding.h"
 #include "core/optimizer/unsqueeze_elimination.h"
+#include "core/optimizer/zipmap_columnar_output.h"
 #include "core/optimizer/utils.h"
 #include "core/platform/env.h"
 #include "core/session/inference_session.h"
 #include "core/session/onnxruntime_session_options_config_keys.h"
 #include "core/util/math.h"
+#include "core/util/thread_utils.h"
 #include "test/capturing_sink.h"
 #include "test/common/tensor_op_test_utils.h"
 #include "test/compare_ortvalue.h"
@@ -1050,6 +1054,137 @@ TEST_F(GraphTransformationTests, ConstantFoldingStringInitializer) {
   ASSERT_EQ(op_to_count.size(), 0U) << "Identity node should have been removed";
 }
 
+// Folds the constant nodes of graph with a ConstantFolding that computes batches of independent nodes on
+// thread_pool, or one node at a time when it is null, and returns the data of the initializers of the folded graph.
+static void FoldConstantsAndGetInitializers(Graph& graph, concurrency::ThreadPool* thread_pool,
+                                            const logging::Logger& logger,
+                                            std::map<std::string, std::vector<uint8_t>>& initializers) {
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  const ConfigOptions empty_config_options;
+  std::unique_ptr<CPUExecutionProvider> e = std::make_unique<CPUExecutionProvider>(CPUExecutionProviderInfo());
+  ASSERT_STATUS_OK(graph_transformation_mgr.Register(
+      std::make_unique<ConstantFolding>(*e.get(), false /*skip_dequantize_linear*/, empty_config_options,
+                                        InlinedHashSet<std::string_view>{}, InlinedHashSet<std::string>{},
+                                        thread_pool),
+      TransformerLevel::Level1));
+  ASSERT_STATUS_OK(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level1, logger));
+
+  for (const auto& [name, tensor] : graph.GetAllInitializedTensors()) {
+    std::vector<uint8_t> data;
+    ASSERT_STATUS_OK(utils::UnpackInitializerData(*tensor, graph.ModelPath(), data));
+    initializers.emplace(name, std::move(data));
+  }
+}
+
+// The Shape nodes of shape-add.onnx, and the nodes they feed, are folded on the thread pool with the same result
+// as when constant folding is serial.
+TEST_F(GraphTransformationTests, ConstantFoldingWithThreadPool) {
+  constexpr const ORTCHAR_T* model_uri = MODEL_FOLDER "shape-add.onnx";
+  OrtThreadPoolParams tpo;
+  tpo.thread_pool_size = 4;
+  auto thread_pool = concurrency::CreateThreadPool(&Env::Default(), tpo, concurrency::ThreadPoolType::INTRA_OP);
+
+  std::map<std::string, std::vector<uint8_t>> initializers[2];
+  for (int parallel = 0; parallel < 2; ++parallel) {
+    std::shared_ptr<Model> model;
+    ASSERT_STATUS_OK(Model::Load(model_uri, model, nullptr, *logger_));
+    Graph& graph = model->MainGraph();
+    ASSERT_EQ(CountOpsInGraph(graph)["Shape"], 4);
+
+    ASSERT_NO_FATAL_FAILURE(FoldConstantsAndGetInitializers(graph, parallel ? thread_pool.get() : nullptr, *logger_,
+                                                            initializers[parallel]));
+    ASSERT_EQ(CountOpsInGraph(graph).size(), 0U);
+  }
+  EXPECT_EQ(initializers[0], initializers[1]);
+}
+
+// Independent Add nodes on initializers are computed together on the thread pool, then the Mul node that consumes
+// two of them in a second batch. The initializers are the same as when the nodes are folded one at a time.
+TEST_F(GraphTransformationTests, ConstantFoldingBatchWithThreadPool) {
+  constexpr int kNumAddNodes = 8;
+  auto build_test_case = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({16}, -1.f, 1.f);
+    std::vector<NodeArg*> add_outs;
+    for (int i = 0; i < kNumAddNodes; ++i) {
+      auto* add_out = builder.MakeIntermediate();
+      builder.AddNode("Add", {builder.MakeInitializer<float>({16}, -1.f, 1.f),
+                              builder.MakeInitializer<float>({16}, -1.f, 1.f)},
+                      {add_out});
+      add_outs.push_back(add_out);
+    }
+    auto* mul_out = builder.MakeIntermediate();
+    builder.AddNode("Mul", {add_outs[0], add_outs[1]}, {mul_out});
+    add_outs[0] = mul_out;
+    for (NodeArg* add_out : add_outs) {
+      builder.AddNode("Sub", {input_arg, add_out}, {builder.MakeOutput()});
+    }
+  };
+
+  OrtThreadPoolParams tpo;
+  tpo.thread_pool_size = 4;
+  auto thread_pool = concurrency::CreateThreadPool(&Env::Default(), tpo, concurrency::ThreadPoolType::INTRA_OP);
+
+  std::map<std::string, std::vector<uint8_t>> initializers[2];
+  for (int parallel = 0; parallel < 2; ++parallel) {
+    Model model("ConstantFolding", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+                {{kOnnxDomain, 13}}, {}, *logger_);
+    Graph& graph = model.MainGraph();
+    ModelTestBuilder builder(graph);
+    build_test_case(builder);
+    builder.SetGraphOutputs();
+    ASSERT_STATUS_OK(graph.Resolve());
+
+    ASSERT_NO_FATAL_FAILURE(FoldConstantsAndGetInitializers(graph, parallel ? thread_pool.get() : nullptr, *logger_,
+                                                            initializers[parallel]));
+    auto op_to_count = CountOpsInGraph(graph);
+    EXPECT_EQ(op_to_count["Add"], 0);
+    EXPECT_EQ(op_to_count["Mul"], 0);
+    EXPECT_EQ(op_to_count["Sub"], kNumAddNodes);
+  }
+  EXPECT_EQ(initializers[0], initializers[1]);
+}
+
+// A ConstantOfShape node that expands 16 bytes into 4MB is not folded when either limit is set. The small Add is.
+TEST_F(GraphTransformationTests, ConstantFoldingOutputLimits) {
+  auto build_test_case = [](ModelTestBuilder& builder) {
+    auto* shape = builder.MakeInitializer<int64_t>({2}, {1024, 1024});
+    auto* expanded = builder.MakeIntermediate();
+    auto* input = builder.MakeInput<float>({1024, 1024}, -1.f, 1.f);
+    auto* add_out = builder.MakeIntermediate();
+    builder.AddNode("ConstantOfShape", {shape}, {expanded});
+    builder.AddNode("Add", {input, expanded}, {add_out});
+
+    auto* a = builder.MakeInitializer<float>({4}, {1.f, 2.f, 3.f, 4.f});
+    auto* b = builder.MakeInitializer<float>({4}, {4.f, 3.f, 2.f, 1.f});
+    auto* sum = builder.MakeIntermediate();
+    auto* output = builder.MakeOutput();
+    builder.AddNode("Add", {a, b}, {sum});
+    builder.AddNode("Mul", {add_out, sum}, {output});
+  };
+
+  auto pre_graph_checker = [](Graph& graph) {
+    TEST_RETURN_IF_NOT(CountOpsInGraph(graph)["ConstantOfShape"] == 1);
+    TEST_RETURN_IF_NOT(CountOpsInGraph(graph)["Add"] == 2);
+    return Status::OK();
+  };
+  auto post_graph_checker = [](Graph& graph) {
+    TEST_RETURN_IF_NOT(CountOpsInGraph(graph)["ConstantOfShape"] == 1);
+    TEST_RETURN_IF_NOT(CountOpsInGraph(graph)["Add"] == 1);
+    return Status::OK();
+  };
+
+  std::unique_ptr<CPUExecutionProvider> e = std::make_unique<CPUExecutionProvider>(CPUExecutionProviderInfo());
+  for (const auto& [key, value] : {std::pair{kOrtSessionOptionsConstantFoldingMaxOutputBytes, "1048576"},
+                                   std::pair{kOrtSessionOptionsConstantFoldingMaxExpansionRatio, "100"}}) {
+    ConfigOptions config_options;
+    ASSERT_STATUS_OK(config_options.AddConfigEntry(key, value));
+    ASSERT_STATUS_OK(TestGraphTransformer(
+        build_test_case, 13, *logger_,
+        std::make_unique<ConstantFolding>(*e.get(), false /*skip_dequantize_linear*/, config_options),
+        TransformerLevel::Level1, 1, pre_graph_checker, post_graph_checker));
+  }
+}
+
 TEST_F(GraphTransformationTests, ConstantFoldingIfConstantInlining) {
   // This test covers the following necessary cases:
   // The input refers to the explicit or implicit inputs of If node.
@@ -5015,6 +5150,50 @@ TEST_F(GraphTransformationTests, GeluApproximation_SessionOptionConfig) {
   VerifyGeluApproximation(false, session_options);
 }
 
+#if !defined(DISABLE_ML_OPS)
+TEST_F(GraphTransformationTests, ZipMapColumnarOutput) {
+  Model model("ZipMapColumnarOutput", false, ModelMetaData(), PathString(), IOnnxRuntimeOpSchemaRegistryList(),
+              {{kOnnxDomain, 13}, {kMLDomain, 1}}, {}, *logger_);
+  auto& graph = model.MainGraph();
+
+  TypeProto tensor_type;
+  tensor_type.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  tensor_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(2);
+  tensor_type.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(3);
+  TypeProto map_type;
+  auto* map = map_type.mutable_sequence_type()->mutable_elem_type()->mutable_map_type();
+  map->set_key_type(TensorProto_DataType_INT64);
+  map->mutable_value_type()->mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+
+  auto& input = graph.GetOrCreateNodeArg("X", &tensor_type);
+  auto& probabilities = graph.GetOrCreateNodeArg("probabilities", &tensor_type);
+  auto& zipmap_output = graph.GetOrCreateNodeArg("output_probability", &map_type);
+  graph.AddNode("softmax", "Softmax", "", {&input}, {&probabilities});
+  auto& zipmap = graph.AddNode("zipmap", "ZipMap", "", {&probabilities}, {&zipmap_output}, nullptr, kMLDomain);
+  zipmap.AddAttribute("classlabels_int64s", std::vector<int64_t>{10, 20, 30});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  onnxruntime::GraphTransformerManager graph_transformation_mgr{5};
+  ASSERT_STATUS_OK(graph_transformation_mgr.Register(std::make_unique<ZipMapColumnarOutput>(),
+                                                     TransformerLevel::Level1));
+  ASSERT_STATUS_OK(graph_transformation_mgr.ApplyTransformers(graph, TransformerLevel::Level1, *logger_));
+
+  std::map<std::string, int> op_to_count = CountOpsInGraph(graph);
+  EXPECT_EQ(op_to_count["ai.onnx.ml.ZipMap"], 0);
+  EXPECT_EQ(op_to_count["Softmax"], 1);
+
+  const auto& outputs = graph.GetOutputs();
+  ASSERT_EQ(outputs.size(), 2u);
+  EXPECT_EQ(outputs[0]->Name(), "probabilities");
+  EXPECT_EQ(outputs[1]->Name(), "output_probability_labels");
+
+  const TensorProto* labels = nullptr;
+  ASSERT_TRUE(graph.GetInitializedTensor("output_probability_labels", labels));
+  EXPECT_EQ(labels->data_type(), TensorProto_DataType_INT64);
+  EXPECT_THAT(labels->int64_data(), ::testing::ElementsAre(10, 20, 30));
+}
+#endif  // !defined(DISABLE_ML_OPS)
+
 // Test DoubleQDQPairsRemover to remove unnecessary DQ->Q nodes in the middle
 TEST_F(GraphTransformationTests, DoublQDQRemover_RemoveDupQDQ_Float16) {
   auto RunTest = [this](const ORTCHAR_T* model_uri) {
@@ -6029,6 +6208,238 @@ TEST_F(GraphTransformationTests, ReshapeFusionOpsetTest) {
 }
 #endif
 
+// Shape -> Gather -> Unsqueeze -> Concat -> Reshape, with symbolic batch and sequence dimensions and a computed
+// head size, becomes a Reshape with a constant shape.
+TEST_F(GraphTransformationTests, SymbolicShapeFolding) {
+  auto build_test_case = [&](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeSymbolicInput<float>({"batch", "seq", 768});
+    auto* num_heads = builder.MakeInitializer<int64_t>({1}, {12});
+    auto* axes = builder.MakeInitializer<int64_t>({1}, {0});
+    auto* add_out = builder.MakeIntermediate();
+    auto* shape_out = builder.MakeIntermediate();
+    auto* concat_out = builder.MakeIntermediate();
+    auto* div_out = builder.MakeIntermediate();
+    auto* out = builder.MakeOutput();
+
+    builder.AddNode("Add", {input_arg, input_arg}, {add_out});
+    builder.AddNode("Shape", {input_arg}, {shape_out});
+    std::vector<NodeArg*> unsqueeze_outs;
+    for (int64_t axis : {0, 1, 2}) {
+      auto* gather_out = builder.MakeIntermediate();
+      auto* unsqueeze_out = builder.MakeIntermediate();
+      builder.AddNode("Gather", {shape_out, builder.MakeScalarInitializer<int64_t>(axis)}, {gather_out});
+      builder.AddNode("Unsqueeze", {gather_out, axes}, {unsqueeze_out});
+      unsqueeze_outs.push_back(unsqueeze_out);
+    }
+    builder.AddNode("Div", {unsqueeze_outs[2], num_heads}, {div_out});
+    builder.AddNode("Concat", {unsqueeze_outs[0], unsqueeze_outs[1], num_heads, div_out}, {concat_out})
+        .AddAttribute("axis", static_cast<int64_t>(0));
+    builder.AddNode("Reshape", {add_out, concat_out}, {out});
+  };
+
+  auto pre_graph_checker = [&](Graph& graph) {
+    TEST_RETURN_IF_NOT(CountOpsInGraph(graph)["Shape"] == 1);
+    TEST_RETURN_IF_NOT(CountOpsInGraph(graph)["Concat"] == 1);
+    return Status::OK();
+  };
+
+  auto post_graph_checker = [&](Graph& graph) {
+    auto op_to_count = CountOpsInGraph(graph);
+    TEST_RETURN_IF_NOT(op_to_count["Add"] == 1);
+    TEST_RETURN_IF_NOT(op_to_count["Shape"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Gather"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Unsqueeze"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Div"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Concat"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Reshape"] == 1);
+
+    for (const Node& node : graph.Nodes()) {
+      if (node.OpType() == "Reshape") {
+        InlinedVector<int64_t> shape;
+        TEST_RETURN_IF_NOT(optimizer_utils::AppendTensorFromInitializer(graph, *node.InputDefs()[1], shape));
+        TEST_RETURN_IF_NOT((shape == InlinedVector<int64_t>{0, 0, 12, 64}));
+      }
+    }
+    return Status::OK();
+  };
+
+  std::unique_ptr<GraphTransformer> transformer = std::make_unique<SymbolicShapeFolding>();
+  ASSERT_STATUS_OK(TestGraphTransformer(build_test_case, 13, *logger_, std::move(transformer), TransformerLevel::Level1,
+                                        1, pre_graph_checker, post_graph_checker));
+}
+
+// A computed dimension that isn't known becomes -1, and the folded model computes the same output.
+TEST_F(GraphTransformationTests, SymbolicShapeFoldingInferredDim) {
+  auto build_test_case = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeInput<float>({2, 4, 6}, -1.f, 1.f);
+    ONNX_NAMESPACE::TensorShapeProto symbolic_shape;
+    symbolic_shape.add_dim()->set_dim_param("batch");
+    symbolic_shape.add_dim()->set_dim_param("seq");
+    symbolic_shape.add_dim()->set_dim_value(6);
+    input_arg->SetShape(symbolic_shape);
+
+    auto* hidden_size = builder.MakeInitializer<int64_t>({1}, {6});
+    auto* axes = builder.MakeInitializer<int64_t>({1}, {0});
+    auto* shape_out = builder.MakeIntermediate();
+    auto* mul_out = builder.MakeIntermediate();
+    auto* concat_out = builder.MakeIntermediate();
+    auto* out = builder.MakeOutput();
+
+    builder.AddNode("Shape", {input_arg}, {shape_out});
+    std::vector<NodeArg*> unsqueeze_outs;
+    for (int64_t axis : {0, 1}) {
+      auto* gather_out = builder.MakeIntermediate();
+      auto* unsqueeze_out = builder.MakeIntermediate();
+      builder.AddNode("Gather", {shape_out, builder.MakeScalarInitializer<int64_t>(axis)}, {gather_out});
+      builder.AddNode("Unsqueeze", {gather_out, axes}, {unsqueeze_out});
+      unsqueeze_outs.push_back(unsqueeze_out);
+    }
+    builder.AddNode("Mul", {unsqueeze_outs[1], hidden_size}, {mul_out});
+    builder.AddNode("Concat", {unsqueeze_outs[0], mul_out}, {concat_out})
+        .AddAttribute("axis", static_cast<int64_t>(0));
+    builder.AddNode("Reshape", {input_arg, concat_out}, {out});
+  };
+
+  auto check_graph = [](InferenceSessionWrapper& session) {
+    const Graph& graph = session.GetGraph();
+    auto op_to_count = CountOpsInGraph(graph);
+    EXPECT_EQ(op_to_count["Shape"], 0);
+    EXPECT_EQ(op_to_count["Mul"], 0);
+    EXPECT_EQ(op_to_count["Concat"], 0);
+    for (const Node& node : graph.Nodes()) {
+      if (node.OpType() == "Reshape") {
+        InlinedVector<int64_t> shape;
+        ASSERT_TRUE(optimizer_utils::AppendTensorFromInitializer(graph, *node.InputDefs()[1], shape));
+        EXPECT_EQ(shape, (InlinedVector<int64_t>{0, -1}));
+      }
+    }
+  };
+
+  TransformerTester(build_test_case, check_graph, TransformerLevel::Default, TransformerLevel::Level1, 13, 0.0, 0.0,
+                    std::make_unique<SymbolicShapeFolding>());
+}
+
+// The dimensions are tracked through Slice and Squeeze of the shape.
+TEST_F(GraphTransformationTests, SymbolicShapeFoldingSliceAndSqueeze) {
+  auto build_test_case = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeSymbolicInput<float>({"batch", "seq", 4, 16});
+    auto* zero = builder.MakeInitializer<int64_t>({1}, {0});
+    auto* two = builder.MakeInitializer<int64_t>({1}, {2});
+    auto* three = builder.MakeInitializer<int64_t>({1}, {3});
+    auto* four = builder.MakeInitializer<int64_t>({1}, {4});
+    auto* num_heads = builder.MakeScalarInitializer<int64_t>(4);
+    auto* shape_out = builder.MakeIntermediate();
+    auto* slice_out = builder.MakeIntermediate();
+    auto* head_size_out = builder.MakeIntermediate();
+    auto* squeeze_out = builder.MakeIntermediate();
+    auto* mul_out = builder.MakeIntermediate();
+    auto* unsqueeze_out = builder.MakeIntermediate();
+    auto* concat_out = builder.MakeIntermediate();
+    auto* out = builder.MakeOutput();
+
+    builder.AddNode("Shape", {input_arg}, {shape_out});
+    builder.AddNode("Slice", {shape_out, zero, two}, {slice_out});
+    builder.AddNode("Slice", {shape_out, three, four}, {head_size_out});
+    builder.AddNode("Squeeze", {head_size_out, zero}, {squeeze_out});
+    builder.AddNode("Mul", {squeeze_out, num_heads}, {mul_out});
+    builder.AddNode("Unsqueeze", {mul_out, zero}, {unsqueeze_out});
+    builder.AddNode("Concat", {slice_out, unsqueeze_out}, {concat_out}).AddAttribute("axis", static_cast<int64_t>(0));
+    builder.AddNode("Reshape", {input_arg, concat_out}, {out});
+  };
+
+  auto pre_graph_checker = [](Graph& graph) {
+    TEST_RETURN_IF_NOT(CountOpsInGraph(graph)["Slice"] == 2);
+    TEST_RETURN_IF_NOT(CountOpsInGraph(graph)["Squeeze"] == 1);
+    return Status::OK();
+  };
+
+  auto post_graph_checker = [](Graph& graph) {
+    auto op_to_count = CountOpsInGraph(graph);
+    TEST_RETURN_IF_NOT(op_to_count["Shape"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Slice"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Squeeze"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Mul"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Concat"] == 0);
+    TEST_RETURN_IF_NOT(op_to_count["Reshape"] == 1);
+
+    for (const Node& node : graph.Nodes()) {
+      if (node.OpType() == "Reshape") {
+        InlinedVector<int64_t> shape;
+        TEST_RETURN_IF_NOT(optimizer_utils::AppendTensorFromInitializer(graph, *node.InputDefs()[1], shape));
+        TEST_RETURN_IF_NOT((shape == InlinedVector<int64_t>{0, 0, 64}));
+      }
+    }
+    return Status::OK();
+  };
+
+  std::unique_ptr<GraphTransformer> transformer = std::make_unique<SymbolicShapeFolding>();
+  ASSERT_STATUS_OK(TestGraphTransformer(build_test_case, 13, *logger_, std::move(transformer), TransformerLevel::Level1,
+                                        1, pre_graph_checker, post_graph_checker));
+}
+
+// Reshape infers at most one dimension, so a shape with two dimensions that aren't known is left as is, as is a
+// shape sliced with bounds that aren't constant.
+TEST_F(GraphTransformationTests, SymbolicShapeFoldingNotFolded) {
+  auto build_two_unknown_dims = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeSymbolicInput<float>({"batch", "seq", 768});
+    auto* hidden_size = builder.MakeInitializer<int64_t>({1}, {768});
+    auto* axes = builder.MakeInitializer<int64_t>({1}, {0});
+    auto* shape_out = builder.MakeIntermediate();
+    auto* concat_out = builder.MakeIntermediate();
+    auto* out = builder.MakeOutput();
+
+    builder.AddNode("Shape", {input_arg}, {shape_out});
+    std::vector<NodeArg*> unsqueeze_outs;
+    for (int64_t axis : {1, 0}) {
+      auto* gather_out = builder.MakeIntermediate();
+      auto* unsqueeze_out = builder.MakeIntermediate();
+      builder.AddNode("Gather", {shape_out, builder.MakeScalarInitializer<int64_t>(axis)}, {gather_out});
+      builder.AddNode("Unsqueeze", {gather_out, axes}, {unsqueeze_out});
+      unsqueeze_outs.push_back(unsqueeze_out);
+    }
+    builder.AddNode("Concat", {unsqueeze_outs[0], unsqueeze_outs[1], hidden_size}, {concat_out})
+        .AddAttribute("axis", static_cast<int64_t>(0));
+    builder.AddNode("Reshape", {input_arg, concat_out}, {out});
+  };
+
+  auto build_non_constant_slice = [](ModelTestBuilder& builder) {
+    auto* input_arg = builder.MakeSymbolicInput<float>({"batch", "seq", 768});
+    auto* starts_arg = builder.MakeInput<int64_t>({1}, {0});
+    auto* ends = builder.MakeInitializer<int64_t>({1}, {2});
+    auto* hidden_size = builder.MakeInitializer<int64_t>({1}, {768});
+    auto* shape_out = builder.MakeIntermediate();
+    auto* slice_out = builder.MakeIntermediate();
+    auto* concat_out = builder.MakeIntermediate();
+    auto* out = builder.MakeOutput();
+
+    builder.AddNode("Shape", {input_arg}, {shape_out});
+    builder.AddNode("Slice", {shape_out, starts_arg, ends}, {slice_out});
+    builder.AddNode("Concat", {slice_out, hidden_size}, {concat_out}).AddAttribute("axis", static_cast<int64_t>(0));
+    builder.AddNode("Reshape", {input_arg, concat_out}, {out});
+  };
+
+  auto graph_checker = [](Graph& graph) {
+    auto op_to_count = CountOpsInGraph(graph);
+    TEST_RETURN_IF_NOT(op_to_count["Shape"] == 1);
+    TEST_RETURN_IF_NOT(op_to_count["Concat"] == 1);
+    TEST_RETURN_IF_NOT(op_to_count["Reshape"] == 1);
+
+    for (const Node& node : graph.Nodes()) {
+      if (node.OpType() == "Reshape") {
+        TEST_RETURN_IF_NOT(!graph_utils::IsConstantInitializer(graph, node.InputDefs()[1]->Name()));
+      }
+    }
+    return Status::OK();
+  };
+
+  for (const auto& build_test_case : {std::function<void(ModelTestBuilder&)>(build_two_unknown_dims),
+                                      std::function<void(ModelTestBuilder&)>(build_non_constant_slice)}) {
+    std::unique_ptr<GraphTransformer> transformer = std::make_unique<SymbolicShapeFolding>();
+    ASSERT_STATUS_OK(TestGraphTransformer(build_test_case, 13, *logger_, std::move(transformer),
+                                          TransformerLevel::Level1, 1, graph_checker, graph_checker));
+  }
+}
+
 TEST_F(GraphTransformationTests, DynamicQuantizeMatMulTest) {
   constexpr const ORTCHAR_T* model_uri = MODEL_FOLDER "fusion/dynamic_quantize_matmul.onnx";
   std::shared_ptr<Model> p_model;
@@ -8036,6 +8447,41 @@ TEST_F(GraphTransformationTests, GatherToSliceFusion) {
 
 #if !defined(DISABLE_CONTRIB_OPS)
 
+TEST_F(GraphTransformationTests, OneHotMatMulFusion) {
+  auto build_test_case = [](float on_value) {
+    return [on_value](ModelTestBuilder& builder) {
+      // Indices out of [-depth, depth) select no row.
+      auto* indices_arg = builder.MakeInput<int64_t>({3, 5}, -6, 6);
+      auto* depth_arg = builder.MakeScalarInitializer<int64_t>(4);
+      auto* values_arg = builder.Make1DInitializer<float>({0.f, on_value});
+      auto* weights_arg = builder.MakeInitializer<float>({4, 8}, -1.f, 1.f);
+      auto* onehot_out = builder.MakeIntermediate();
+      auto* output_arg = builder.MakeOutput();
+      builder.AddNode("OneHot", {indices_arg, depth_arg, values_arg}, {onehot_out});
+      builder.AddNode("MatMul", {onehot_out, weights_arg}, {output_arg});
+    };
+  };
+
+  auto check_fused = [](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["OneHot"], 0);
+    EXPECT_EQ(op_to_count["MatMul"], 0);
+    EXPECT_EQ(op_to_count["com.microsoft.OneHotMatMul"], 1);
+  };
+  TransformerTester(build_test_case(1.f), check_fused, TransformerLevel::Level1, TransformerLevel::Level2, 13,
+                    0.0, 0.0, std::make_unique<OneHotMatMulFusion>());
+
+  // Only one-hot encodings with the values [0, 1] select a row of the weights.
+  auto check_not_fused = [](InferenceSessionWrapper& session) {
+    auto op_to_count = CountOpsInGraph(session.GetGraph());
+    EXPECT_EQ(op_to_count["OneHot"], 1);
+    EXPECT_EQ(op_to_count["MatMul"], 1);
+    EXPECT_EQ(op_to_count["com.microsoft.OneHotMatMul"], 0);
+  };
+  TransformerTester(build_test_case(2.f), check_not_fused, TransformerLevel::Level1, TransformerLevel::Level2, 13,
+                    0.0, 0.0, std::make_unique<OneHotMatMulFusion>());
+}
+
 TEST_F(GraphTransformationTests, MatMulNBitsBiasFusion) {
   struct TestOptions {
     bool bias_is_first_add_input{false};
@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 // #include "core/framework/customregistry.h"
@@ -8,8 +10,12 @@
 #include "core/providers/cpu/controlflow/if.h"
 #include "test/providers/provider_test_utils.h"
 #include "core/session/inference_session.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 
+#include "test/framework/test_utils.h"
+#include "test/util/include/asserts.h"
 #include "test/util/include/default_providers.h"
+#include "test/util/include/test_environment.h"
 
 using namespace ONNX_NAMESPACE;
 
@@ -336,6 +342,102 @@ TEST(If, SymbolicShapeInMainGraph_NoShapeInSubgraph_False) {
   RunTest(false, options, false);
 }
 
+// The branches are initialized by the first Run taking them, unless they are pre-warmed.
+TEST(If, LazyBranchInitialization) {
+  for (const char* prewarm : {"", "if:then_branch", "if"}) {
+    for (bool condition_value : {true, false}) {
+      IfOpTester test{RunOptions{}};
+      test.AddShapeToTensorData(false);
+      test.AddInput<float>("split_input", {2}, {1.f, 10.f});
+      test.AddInput<bool>("if_cond", {1}, {condition_value});
+      test.AddInput<float>("if_graph_input_0", {1}, {1.f});
+      test.AddOutput<float>("if_out_0", {1}, {condition_value ? 2.f : 11.f});
+
+      SessionOptions session_options;
+      ASSERT_STATUS_OK(session_options.config_options.AddConfigEntry(kOrtSessionOptionsLazySubgraphInitialization,
+                                                                     "1"));
+      ASSERT_STATUS_OK(session_options.config_options.AddConfigEntry(
+          kOrtSessionOptionsLazySubgraphInitializationPrewarm, prewarm));
+      test.Run(session_options, OpTester::ExpectResult::kExpectSuccess, "", {kTensorrtExecutionProvider});
+    }
+  }
+}
+
+// Concurrent Runs taking a branch that isn't initialized yet initialize it once, and both use it.
+TEST(If, LazyBranchInitializationConcurrentRuns) {
+  Model model("If", false, DefaultLoggingManager().DefaultLogger());
+  auto& graph = model.MainGraph();
+
+  TypeProto bool_tensor;
+  bool_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_BOOL);
+  bool_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+  TypeProto float_tensor;
+  float_tensor.mutable_tensor_type()->set_elem_type(TensorProto_DataType_FLOAT);
+  float_tensor.mutable_tensor_type()->mutable_shape()->add_dim()->set_dim_value(1);
+
+  // the branches read split_out_0 or split_out_1, and if_input_0, from the outer scope
+  auto& if_cond = graph.GetOrCreateNodeArg("if_cond", &bool_tensor);
+  auto& split_out_0 = graph.GetOrCreateNodeArg("split_out_0", &float_tensor);
+  auto& split_out_1 = graph.GetOrCreateNodeArg("split_out_1", &float_tensor);
+  auto& if_input_0 = graph.GetOrCreateNodeArg("if_input_0", &float_tensor);
+  auto& if_out_0 = graph.GetOrCreateNodeArg("if_out_0", &float_tensor);
+
+  auto& if_node = graph.AddNode("if", "If", "If node", {&if_cond}, {&if_out_0});
+  if_node.AddAttribute("then_branch", CreateSubgraph(true, RunOptions{}));
+  if_node.AddAttribute("else_branch", CreateSubgraph(false, RunOptions{}));
+
+  graph.SetInputs({&if_cond, &split_out_0, &split_out_1, &if_input_0});
+  graph.SetOutputs({&if_out_0});
+  ASSERT_STATUS_OK(graph.Resolve());
+
+  std::string model_data;
+  model.ToProto().SerializeToString(&model_data);
+
+  auto allocator = TestCPUExecutionProvider()->CreatePreferredAllocators()[0];
+  NameMLValMap feeds;
+  OrtValue ml_value;
+  CreateMLValue<bool>(allocator, {1}, {true}, &ml_value);
+  feeds.insert(std::make_pair("if_cond", ml_value));
+  CreateMLValue<float>(allocator, {1}, {1.f}, &ml_value);
+  feeds.insert(std::make_pair("split_out_0", ml_value));
+  CreateMLValue<float>(allocator, {1}, {10.f}, &ml_value);
+  feeds.insert(std::make_pair("split_out_1", ml_value));
+  CreateMLValue<float>(allocator, {1}, {1.f}, &ml_value);
+  feeds.insert(std::make_pair("if_input_0", ml_value));
+  const std::vector<std::string> output_names{"if_out_0"};
+
+  // a new session for each iteration, so the then branch is initialized by the concurrent Runs every time
+  for (int iteration = 0; iteration < 10; ++iteration) {
+    SessionOptions so;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsLazySubgraphInitialization, "1"));
+    InferenceSession session{so, GetEnvironment()};
+    ASSERT_STATUS_OK(session.Load(model_data.data(), static_cast<int>(model_data.size())));
+    ASSERT_STATUS_OK(session.Initialize());
+
+    constexpr size_t kNumThreads = 2;
+    std::vector<Status> statuses(kNumThreads);
+    std::vector<std::vector<OrtValue>> fetches(kNumThreads);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back([&, i]() {
+        onnxruntime::RunOptions run_options;
+        statuses[i] = session.Run(run_options, feeds, output_names, &fetches[i]);
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (size_t i = 0; i < kNumThreads; ++i) {
+      ASSERT_STATUS_OK(statuses[i]);
+      ASSERT_EQ(fetches[i].size(), 1u);
+      const auto& output = fetches[i][0].Get<Tensor>();
+      ASSERT_EQ(output.Shape(), TensorShape({1}));
+      EXPECT_EQ(output.Data<float>()[0], 2.f);
+    }
+  }
+}
+
 TEST(If, Opset11ThenAndElseBranchesProduceDifferentOutputShapes) {
   RunOptions options{};
   options.include_dim_values_in_main_graph = true;
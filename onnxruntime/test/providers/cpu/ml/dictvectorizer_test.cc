@@ -42,5 +42,40 @@ TEST(MLOpTest, DictVectorizerInt64Input) {
   test.Run();
 }
 
+TEST(MLOpTest, DictVectorizerDuplicatedVocabulary) {
+  OpTester test("DictVectorizer", 1, onnxruntime::kMLDomain);
+
+  test.AddAttribute("int64_vocabulary", std::vector<int64_t>{7, 3, 7, 100, 3, 7});
+
+  std::map<int64_t, float> map;
+  map[3] = 0.5f;
+  map[7] = 2.f;
+  map[8] = 4.f;
+
+  test.AddInput<int64_t, float>("X", map);
+
+  std::vector<int64_t> dims{1, 6};
+  test.AddOutput<float>("Y", dims, {2.f, 0.5f, 2.f, 0.f, 0.5f, 2.f});
+  test.Run();
+}
+
+TEST(MLOpTest, DictVectorizerMoreKeysThanVocabulary) {
+  OpTester test("DictVectorizer", 1, onnxruntime::kMLDomain);
+
+  test.AddAttribute("string_vocabulary", std::vector<std::string>{"b", "z", "b"});
+
+  std::map<std::string, double> map;
+  map["a"] = 1.;
+  map["b"] = 2.;
+  map["c"] = 3.;
+  map["d"] = 4.;
+
+  test.AddInput<std::string, double>("X", map);
+
+  std::vector<int64_t> dims{1, 3};
+  test.AddOutput<double>("Y", dims, {2., 0., 2.});
+  test.Run();
+}
+
 }  // namespace test
 }  // namespace onnxruntime
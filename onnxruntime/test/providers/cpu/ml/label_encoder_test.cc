@@ -1,6 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <limits>
+
 #include "gtest/gtest.h"
 #include "test/providers/provider_test_utils.h"
 
@@ -190,6 +192,61 @@ TEST(LabelEncoder, Int64ToInt64Opset2) {
   test.Run();
 }
 
+// Keys spanning a small range are looked up in a dense array, check its bounds.
+TEST(LabelEncoder, Int64ToInt64DenseKeysOpset2) {
+  std::vector<std::int64_t> keys;
+  std::vector<std::int64_t> values;
+  for (std::int64_t key = -100; key < 100; key += 2) {
+    keys.push_back(key);
+    values.push_back(key * 10);
+  }
+
+  std::vector<std::int64_t> input;
+  std::vector<std::int64_t> output;
+  for (std::int64_t x = -103; x < 103; ++x) {
+    input.push_back(x);
+    output.push_back(x >= -100 && x < 100 && x % 2 == 0 ? x * 10 : -1);
+  }
+  input.push_back(std::numeric_limits<std::int64_t>::min());
+  output.push_back(-1);
+  input.push_back(std::numeric_limits<std::int64_t>::max());
+  output.push_back(-1);
+
+  OpTester test("LabelEncoder", 2, onnxruntime::kMLDomain);
+
+  test.AddAttribute("keys_int64s", keys);
+  test.AddAttribute("values_int64s", values);
+  test.AddAttribute("default_int64", (std::int64_t)-1);
+
+  test.AddInput<std::int64_t>("X", {static_cast<std::int64_t>(input.size())}, input);
+  test.AddOutput<std::int64_t>("Y", {static_cast<std::int64_t>(output.size())}, output);
+
+  test.Run();
+}
+
+TEST(LabelEncoder, Int64ToStringSparseKeysOpset2) {
+  std::vector<std::int64_t> dims{6};
+
+  std::vector<std::int64_t> input{std::numeric_limits<std::int64_t>::min(), 0, std::numeric_limits<std::int64_t>::max(),
+                                  1, -1, 1000000};
+  std::vector<std::string> output{"min", "zero", "max", "?", "?", "?"};
+
+  OpTester test("LabelEncoder", 2, onnxruntime::kMLDomain);
+
+  const std::vector<std::int64_t> keys{std::numeric_limits<std::int64_t>::min(), 0,
+                                       std::numeric_limits<std::int64_t>::max()};
+  const std::vector<std::string> values{"min", "zero", "max"};
+
+  test.AddAttribute("keys_int64s", keys);
+  test.AddAttribute("values_strings", values);
+  test.AddAttribute("default_string", "?");
+
+  test.AddInput<std::int64_t>("X", dims, input);
+  test.AddOutput<std::string>("Y", dims, output);
+
+  test.Run();
+}
+
 TEST(LabelEncoder, StringToStringOpset2) {
   std::vector<std::int64_t> dims{1, 5};
 
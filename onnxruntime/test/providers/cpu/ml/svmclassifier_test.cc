@@ -137,6 +137,91 @@ TEST(MLOpTest, SVMClassifierSVCProbabilities) {
   test.Run();
 }
 
+// The expected values of the two following tests come from the implementation that scored each one-vs-one classifier
+// with a scalar loop accumulating in double, before the kernels and the scores were computed with GEMMs.
+TEST(MLOpTest, SVMClassifierRBFMulticlass) {
+  OpTester test("SVMClassifier", 1, onnxruntime::kMLDomain);
+
+  // 3 classes with 2, 3 and 2 support vectors of 3 features
+  std::vector<float> coefficients = {0.8f, 0.6f, -0.5f, -0.7f, -0.4f, -0.9f, -0.3f,
+                                     1.0f, 0.2f, 0.6f, 0.5f, 0.7f, -0.6f, -1.1f};
+  std::vector<float> support_vectors = {0.f, 0.f, 1.f, 0.5f, -0.5f, 1.5f,
+                                        2.f, 1.f, 0.f, 2.5f, 1.5f, -0.5f, 1.5f, 2.f, 0.5f,
+                                        -1.f, 2.f, -1.f, -1.5f, 1.f, -2.f};
+  std::vector<int64_t> vectors_per_class = {2, 3, 2};
+  std::vector<float> rho = {0.1f, -0.2f, 0.05f};
+  std::vector<float> kernel_params = {0.25f, 0.f, 3.f};  // gamma, coef0, degree
+  std::vector<int64_t> classes = {0, 1, 2};
+
+  std::vector<float> X = {0.2f, -0.1f, 1.1f, 2.2f, 1.2f, -0.1f, -1.2f, 1.6f, -1.4f,
+                          1.f, 1.f, 0.5f, 0.f, 1.5f, -0.5f, 3.f, -1.f, 2.f};
+  std::vector<int64_t> predictions = {0, 1, 2, 1, 2, 0};
+  std::vector<float> scores = {
+      1.17675579f, 0.886659861f, 0.290156573f,
+      -1.10986269f, -0.073749423f, 1.53152215f,
+      0.116104767f, -1.17644465f, -1.31336975f,
+      -0.144313961f, 0.29305321f, 1.0632534f,
+      -0.0397955999f, -0.559975624f, -0.106454119f,
+      0.166851833f, -0.0992717743f, 0.157660693f};
+
+  test.AddAttribute("kernel_type", std::string("RBF"));
+  test.AddAttribute("coefficients", coefficients);
+  test.AddAttribute("support_vectors", support_vectors);
+  test.AddAttribute("vectors_per_class", vectors_per_class);
+  test.AddAttribute("rho", rho);
+  test.AddAttribute("kernel_params", kernel_params);
+  test.AddAttribute("classlabels_ints", classes);
+
+  test.AddInput<float>("X", {6, 3}, X);
+  test.AddOutput<int64_t>("Y", {6}, predictions);
+  test.AddOutput<float>("Z", {6, 3}, scores);
+  test.SetOutputAbsErr("Z", 0.00001f);
+
+  test.Run();
+}
+
+TEST(MLOpTest, SVMClassifierPolyMulticlassProbabilities) {
+  OpTester test("SVMClassifier", 1, onnxruntime::kMLDomain);
+
+  // 4 classes with 1, 2, 2 and 1 support vectors of 2 features
+  std::vector<float> coefficients = {0.9f, -0.4f, -0.6f, -0.3f, -0.5f, -0.7f,
+                                     0.5f, 0.8f, 0.6f, -0.8f, -0.4f, -0.6f,
+                                     0.6f, 0.3f, 0.4f, 0.7f, 0.5f, -1.f};
+  std::vector<float> support_vectors = {-2.f, -2.f, 1.f, -1.5f, 2.f, -1.f, -1.f, 2.f, -1.5f, 1.f, 2.f, 2.f};
+  std::vector<int64_t> vectors_per_class = {1, 2, 2, 1};
+  std::vector<float> rho = {0.2f, -0.1f, 0.3f, 0.05f, -0.15f, 0.1f};
+  std::vector<float> kernel_params = {0.2f, 0.5f, 2.f};  // gamma, coef0, degree
+  std::vector<float> proba = {-1.5f, -2.f, -1.2f, -1.8f, -2.5f, -1.1f};
+  std::vector<float> probb = {0.1f, -0.05f, 0.2f, 0.f, 0.15f, -0.1f};
+  std::vector<int64_t> classes = {0, 1, 2, 3};
+
+  std::vector<float> X = {-1.8f, -2.1f, 1.5f, -1.2f, -1.2f, 1.4f, 2.1f, 1.9f, 0.f, 0.f};
+  std::vector<int64_t> predictions = {0, 1, 2, 3, 0};
+  std::vector<float> probabilities = {
+      0.880642235f, 0.0108529581f, 0.0221364424f, 0.086368233f,
+      0.0908969343f, 0.746552169f, 0.0474290363f, 0.115121759f,
+      0.0821450129f, 0.0403828211f, 0.767214179f, 0.110258043f,
+      0.0570711456f, 0.0108271865f, 0.0186959021f, 0.913405776f,
+      0.250347525f, 0.223532185f, 0.275746673f, 0.250373483f};
+
+  test.AddAttribute("kernel_type", std::string("POLY"));
+  test.AddAttribute("coefficients", coefficients);
+  test.AddAttribute("support_vectors", support_vectors);
+  test.AddAttribute("vectors_per_class", vectors_per_class);
+  test.AddAttribute("rho", rho);
+  test.AddAttribute("kernel_params", kernel_params);
+  test.AddAttribute("classlabels_ints", classes);
+  test.AddAttribute("prob_a", proba);
+  test.AddAttribute("prob_b", probb);
+
+  test.AddInput<float>("X", {5, 2}, X);
+  test.AddOutput<int64_t>("Y", {5}, predictions);
+  test.AddOutput<float>("Z", {5, 4}, probabilities);
+  test.SetOutputAbsErr("Z", 0.00001f);
+
+  test.Run();
+}
+
 TEST(MLOpTest, SVMClassifierSVC) {
   OpTester test("SVMClassifier", 1, onnxruntime::kMLDomain);
 
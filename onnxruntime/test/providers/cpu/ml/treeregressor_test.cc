@@ -1,8 +1,12 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <limits>
+
 #include "gtest/gtest.h"
+#include "core/session/onnxruntime_session_options_config_keys.h"
 #include "test/providers/provider_test_utils.h"
+#include "test/util/include/asserts.h"
 
 namespace onnxruntime {
 namespace test {
@@ -30,9 +34,20 @@ void _multiply_update_array_string(std::vector<std::string>& data, int n) {
   }
 }
 
+// Runs the test with kOrtSessionOptionsTreeEnsembleCompactNodes enabled if compact_nodes is true.
+static void RunTreeTest(OpTester& test, bool compact_nodes) {
+  if (compact_nodes) {
+    SessionOptions so;
+    ASSERT_STATUS_OK(so.config_options.AddConfigEntry(kOrtSessionOptionsTreeEnsembleCompactNodes, "1"));
+    test.Run(so);
+  } else {
+    test.Run();
+  }
+}
+
 template <typename T>
 void GenTreeAndRunTest(int opsetml, const std::vector<T>& X, const std::vector<float>& base_values, const std::vector<float>& results, const std::string& aggFunction,
-                       bool one_obs = false, int64_t n_obs = 8, int n_trees = 1) {
+                       bool one_obs = false, int64_t n_obs = 8, int n_trees = 1, bool compact_nodes = false) {
   OpTester test("TreeEnsembleRegressor", opsetml, onnxruntime::kMLDomain);
 
   // tree
@@ -121,8 +136,80 @@ void GenTreeAndRunTest(int opsetml, const std::vector<T>& X, const std::vector<f
     test.AddOutput<float>("Y", {n_obs, 2}, yn);
   }
 
+  RunTreeTest(test, compact_nodes);
+}
+
+// A complete tree of depth 7 has too many leaves for QuickScorer, the rows are evaluated by
+// the interleaved traversal of TreeEnsembleCommon::ProcessTreeNodeLeaves.
+static void RunDeepTreeRegressor(const std::string& mode, int64_t n_rows) {
+  OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+
+  constexpr int64_t n_features = 3;
+  constexpr int64_t n_internal = (int64_t(1) << 7) - 1;
+  constexpr int64_t n_nodes = 2 * n_internal + 1;
+  auto feature = [&](int64_t node) { return node % n_features; };
+  auto threshold = [](int64_t node) { return static_cast<float>((node * 37) % 17) / 8.0f - 1.0f; };
+
+  std::vector<int64_t> nodes_treeids, nodes_nodeids, nodes_featureids, nodes_truenodeids, nodes_falsenodeids;
+  std::vector<std::string> nodes_modes;
+  std::vector<float> nodes_values;
+  std::vector<int64_t> target_treeids, target_nodeids, target_ids;
+  std::vector<float> target_weights;
+  for (int64_t node = 0; node < n_nodes; ++node) {
+    const bool is_leaf = node >= n_internal;
+    nodes_treeids.push_back(0);
+    nodes_nodeids.push_back(node);
+    nodes_featureids.push_back(is_leaf ? 0 : feature(node));
+    nodes_values.push_back(is_leaf ? 0.0f : threshold(node));
+    nodes_modes.push_back(is_leaf ? "LEAF" : mode);
+    nodes_truenodeids.push_back(is_leaf ? 0 : 2 * node + 1);
+    nodes_falsenodeids.push_back(is_leaf ? 0 : 2 * node + 2);
+    if (is_leaf) {
+      target_treeids.push_back(0);
+      target_nodeids.push_back(node);
+      target_ids.push_back(0);
+      target_weights.push_back(static_cast<float>(node - n_internal));
+    }
+  }
+
+  test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+  test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+  test.AddAttribute("nodes_treeids", nodes_treeids);
+  test.AddAttribute("nodes_nodeids", nodes_nodeids);
+  test.AddAttribute("nodes_featureids", nodes_featureids);
+  test.AddAttribute("nodes_values", nodes_values);
+  test.AddAttribute("nodes_modes", nodes_modes);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_ids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", static_cast<int64_t>(1));
+
+  std::vector<float> X(static_cast<size_t>(n_rows * n_features));
+  for (size_t i = 0; i < X.size(); ++i) {
+    X[i] = i % 29 == 5 ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>((i * 7) % 23) / 11.0f - 1.0f;
+  }
+  std::vector<float> Y;
+  for (int64_t row = 0; row < n_rows; ++row) {
+    int64_t node = 0;
+    while (node < n_internal) {
+      const float x = X[static_cast<size_t>(row * n_features + feature(node))];
+      const bool goes_true = mode == "BRANCH_LEQ" ? x <= threshold(node) : x > threshold(node);
+      node = goes_true ? 2 * node + 1 : 2 * node + 2;
+    }
+    Y.push_back(static_cast<float>(node - n_internal));
+  }
+
+  test.AddInput<float>("X", {n_rows, n_features}, X);
+  test.AddOutput<float>("Y", {n_rows, 1}, Y);
   test.Run();
-}  // namespace test
+}
+
+TEST(MLOpTest, TreeRegressorDeepTreeManyRows) {
+  RunDeepTreeRegressor("BRANCH_LEQ", 3);
+  RunDeepTreeRegressor("BRANCH_LEQ", 203);
+  RunDeepTreeRegressor("BRANCH_GT", 203);
+}
 
 template <typename T, typename TH>
 void GenTreeAndRunTest_as_tensor(int opsetml, const std::vector<T>& X, const std::vector<TH>& base_values, const std::vector<float>& results, const std::string& aggFunction,
@@ -251,6 +338,18 @@ TEST(MLOpTest, TreeRegressorMultiTargetBatchTreeA2) {
   GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", true, 8, 1);  // section A2
 }
 
+TEST(MLOpTest, TreeRegressorMultiTargetCompactNodes) {
+  // The compact format must give the same results as the default one for every batch size and number of trees.
+  std::vector<float> X = {1.f, 0.0f, 0.4f, 3.0f, 44.0f, -3.f, 12.0f, 12.9f, -312.f, 23.0f, 11.3f, -222.f, 23.0f, 11.3f, -222.f, 23.0f, 3311.3f, -222.f, 23.0f, 11.3f, -222.f, 43.0f, 413.3f, -114.f};
+  std::vector<double> X_double(X.begin(), X.end());
+  std::vector<float> results = {1.33333333f, 29.f, 3.f, 14.f, 2.f, 23.f, 2.f, 23.f, 2.f, 23.f, 2.66666667f, 17.f, 2.f, 23.f, 3.f, 14.f};
+  std::vector<float> base_values{0.f, 0.f};
+  GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", true, 8, 1, true);
+  GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", false, 8, 1, true);
+  GenTreeAndRunTest(3, X, base_values, results, "AVERAGE", false, 40, 30, true);
+  GenTreeAndRunTest(3, X_double, base_values, results, "AVERAGE", false, 8, 1, true);
+}
+
 TEST(MLOpTest, TreeRegressorMultiTargetBatchTreeA2_as_tensor) {
   // TreeEnsemble implements different paths depending on n_trees or N.
   // This test and the next ones go through all sections for multi-targets.
@@ -844,5 +943,52 @@ TEST(MLOpTest, TreeRegressorTrueNodeBeforeNode) {
   test.Run();
 }
 
+static void RunTreeRegressorBranchLtMissingValues(bool compact_nodes) {
+  OpTester test("TreeEnsembleRegressor", 3, onnxruntime::kMLDomain);
+
+  // Two trees using BRANCH_LT, NaN values always follow the false branch.
+  std::vector<int64_t> nodes_treeids = {0, 0, 0, 0, 0, 1, 1, 1};
+  std::vector<int64_t> nodes_nodeids = {0, 1, 2, 3, 4, 0, 1, 2};
+  std::vector<int64_t> nodes_featureids = {0, 0, 1, 0, 0, 1, 0, 0};
+  std::vector<std::string> nodes_modes = {"BRANCH_LT", "LEAF", "BRANCH_LT", "LEAF", "LEAF",
+                                          "BRANCH_LT", "LEAF", "LEAF"};
+  std::vector<float> nodes_values = {1.0f, 0.0f, 2.0f, 0.0f, 0.0f, 0.5f, 0.0f, 0.0f};
+  std::vector<int64_t> nodes_truenodeids = {1, 0, 3, 0, 0, 1, 0, 0};
+  std::vector<int64_t> nodes_falsenodeids = {2, 0, 4, 0, 0, 2, 0, 0};
+
+  std::vector<int64_t> target_treeids = {0, 0, 0, 1, 1};
+  std::vector<int64_t> target_nodeids = {1, 3, 4, 1, 2};
+  std::vector<int64_t> target_ids = {0, 0, 0, 0, 0};
+  std::vector<float> target_weights = {1.0f, 2.0f, 3.0f, 10.0f, 20.0f};
+
+  test.AddAttribute("nodes_truenodeids", nodes_truenodeids);
+  test.AddAttribute("nodes_falsenodeids", nodes_falsenodeids);
+  test.AddAttribute("nodes_treeids", nodes_treeids);
+  test.AddAttribute("nodes_nodeids", nodes_nodeids);
+  test.AddAttribute("nodes_featureids", nodes_featureids);
+  test.AddAttribute("nodes_values", nodes_values);
+  test.AddAttribute("nodes_modes", nodes_modes);
+  test.AddAttribute("target_treeids", target_treeids);
+  test.AddAttribute("target_nodeids", target_nodeids);
+  test.AddAttribute("target_ids", target_ids);
+  test.AddAttribute("target_weights", target_weights);
+  test.AddAttribute("n_targets", static_cast<int64_t>(1));
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<float> X = {0.0f, 0.0f, 1.0f, 1.0f, 5.0f, 3.0f, nan, nan, 1.0f, 0.5f};
+  std::vector<float> Y = {11.0f, 22.0f, 23.0f, 23.0f, 22.0f};
+  test.AddInput<float>("X", {5, 2}, X);
+  test.AddOutput<float>("Y", {5, 1}, Y);
+  RunTreeTest(test, compact_nodes);
+}
+
+TEST(MLOpTest, TreeRegressorBranchLtMissingValues) {
+  RunTreeRegressorBranchLtMissingValues(false);
+}
+
+TEST(MLOpTest, TreeRegressorBranchLtMissingValuesCompactNodes) {
+  RunTreeRegressorBranchLtMissingValues(true);
+}
+
 }  // namespace test
 }  // namespace onnxruntime
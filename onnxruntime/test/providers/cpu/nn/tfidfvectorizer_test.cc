@@ -210,6 +210,38 @@ TEST(TfIdfVectorizerTest, Int32_TF_BatchOnlyBigrams_Skip0) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }
 
+// Enough rows to be split between threads.
+TEST(TfIdfVectorizerTest, Int64_TF_ManyRows_UniAndBigrams_Skip1) {
+  OpTester test("TfIdfVectorizer", opset_ver);
+  // s=1, Min=1, Max=2, weights empty, int64
+  InitTestAttr(test, "TF", 1, 2, 1,
+               {0, 4},
+               {0, 1, 2, 3, 4, 5, 6},  // 7 output indexes
+               {},
+               {2, 3, 5, 4,         // 1-grams
+                5, 6, 7, 8, 6, 7},  // bi-grams
+               {});
+
+  constexpr int64_t num_rows = 64;
+  std::vector<int64_t> input;
+  std::vector<float> output;
+  for (int64_t row = 0; row < num_rows; ++row) {
+    if (row % 2 == 0) {
+      // Adjacent bi-grams only.
+      input.insert(input.end(), {5, 6, 7, 8, 2, 3});
+      output.insert(output.end(), {1, 1, 1, 0, 1, 1, 1});
+    } else {
+      // Bi-grams found with one skip only.
+      input.insert(input.end(), {5, 0, 6, 1, 7, 2});
+      output.insert(output.end(), {1, 0, 1, 0, 1, 0, 1});
+    }
+  }
+  test.AddInput<int64_t>("T", {num_rows, 6}, input);
+  test.AddOutput<float>("Y", {num_rows, 7}, output);
+
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 TEST(TfIdfVectorizerTest, String_TF_OnlyBigrams_Skip0) {
   OpTester test("TfIdfVectorizer", opset_ver);
   // s=0, Min=Max=2, weights empty, string
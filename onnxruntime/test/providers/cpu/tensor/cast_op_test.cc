@@ -205,6 +205,21 @@ TEST(CastOpTest, ToString) {
   const std::vector<std::string> int_string_data = {"0", "1", "2", "3", "4", "5", "6", "7"};
   const std::vector<int16_t> int_16_input = {0, 1, 2, 3, 4, 5, 6, 7};
   TestCastOp(gsl::make_span(int_16_input), gsl::make_span(int_string_data), shape);
+
+  const std::vector<int64_t> int_64_input = {0, -1, 10, -100, 1000000007, -1000000007,
+                                             std::numeric_limits<int64_t>::min(),
+                                             std::numeric_limits<int64_t>::max()};
+  const std::vector<std::string> int_64_string_output = {"0", "-1", "10", "-100", "1000000007", "-1000000007",
+                                                         "-9223372036854775808", "9223372036854775807"};
+  TestCastOp(gsl::make_span(int_64_input), gsl::make_span(int_64_string_output), shape);
+
+  const std::vector<int8_t> int_8_input = {0, 1, -1, 65, 97, -128, 127, 48};
+  const std::vector<std::string> int_8_string_output = {"0", "1", "-1", "65", "97", "-128", "127", "48"};
+  TestCastOp(gsl::make_span(int_8_input), gsl::make_span(int_8_string_output), shape);
+
+  const bool bool_input[] = {true, false, true, true, false, false, true, false};
+  const std::vector<std::string> bool_string_output = {"1", "0", "1", "1", "0", "0", "1", "0"};
+  TestCastOp(gsl::make_span(bool_input), gsl::make_span(bool_string_output), shape);
 }
 
 #if !defined(DISABLE_FLOAT8_TYPES)
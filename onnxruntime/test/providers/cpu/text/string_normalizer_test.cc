@@ -194,6 +194,23 @@ TEST(ContribOpTest, StringNormalizerInsensitiveFilterOutUpperWithLocale) {
   test.Run(OpTester::ExpectResult::kExpectSuccess);
 }
 
+TEST(ContribOpTest, StringNormalizerInsensitiveFilterOutLowerManyStrings) {
+  // - case-INSENSITIVE approach en_US locale
+  // - enough strings to be processed in several batches
+  // - ASCII and non ASCII strings and stop words
+  OpTester test("StringNormalizer", opset_ver, domain);
+  InitTestAttr(test, "LOWER", false, {"MonDay", "école"}, test_locale);
+  std::vector<std::string> input;
+  std::vector<std::string> output;
+  for (int i = 0; i < 250; ++i) {
+    input.insert(input.end(), {"MONDAY", "Tuesday", "École", "Понедельник"});
+    output.insert(output.end(), {"tuesday", "понедельник"});
+  }
+  test.AddInput<std::string>("T", {static_cast<int64_t>(input.size())}, input);
+  test.AddOutput<std::string>("Y", {static_cast<int64_t>(output.size())}, output);
+  test.Run(OpTester::ExpectResult::kExpectSuccess);
+}
+
 TEST(ContribOpTest, StringNormalizerSensitiveFilterOutUpperEmptyCase) {
   // Empty output case
   // - casesensitive approach